@@ -0,0 +1,85 @@
+/*
+  Broadphase, every box against every box. aabb_intersection_test a pair
+  at a time, against aabb_soa_test_aabb_soa. Both are checked to find
+  the same pairs as a plain scalar overlap test first.
+*/
+
+
+#include "bench.hpp"
+#include <math/math.hpp>
+#include <vector>
+
+
+namespace {
+
+
+bool
+overlap_reference(const math::aabb &a, const math::aabb &b)
+{
+  return math::vec3_get_x(a.min) < math::vec3_get_x(b.max) && math::vec3_get_x(b.min) < math::vec3_get_x(a.max) &&
+         math::vec3_get_y(a.min) < math::vec3_get_y(b.max) && math::vec3_get_y(b.min) < math::vec3_get_y(a.max) &&
+         math::vec3_get_z(a.min) < math::vec3_get_z(b.max) && math::vec3_get_z(b.min) < math::vec3_get_z(a.max);
+}
+
+
+} // ns
+
+
+int
+main()
+{
+  const size_t count = 2048;
+  const size_t words = (count + 31) / 32;
+  uint32_t seed = 1;
+
+  // Whole numbers, so the pair and SoA tests can't round differently at a touching face.
+  std::vector<math::aabb> boxes(count);
+
+  for(math::aabb &box : boxes)
+  {
+    const math::vec3 min = math::vec3_init((float)(int)bench::random_float(seed, -40.f, 40.f), (float)(int)bench::random_float(seed, -40.f, 40.f), (float)(int)bench::random_float(seed, -40.f, 40.f));
+    const math::vec3 size = math::vec3_init((float)(int)bench::random_float(seed, 1.f, 6.f), (float)(int)bench::random_float(seed, 1.f, 6.f), (float)(int)bench::random_float(seed, 1.f, 6.f));
+
+    box = math::aabb_init(min, math::vec3_add(min, size));
+  }
+
+  const math::aabb_soa soa = math::aabb_soa_init(boxes.data(), count);
+  std::vector<uint32_t> masks(count * words);
+
+  const size_t soa_pairs = math::aabb_soa_test_aabb_soa(soa, soa, masks.data());
+
+  size_t reference_pairs = 0;
+  size_t mismatch = 0;
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    for(size_t j = 0; j < count; ++j)
+    {
+      const bool expected = overlap_reference(boxes[i], boxes[j]);
+      const bool pair     = math::aabb_intersection_test(boxes[i], boxes[j]);
+      const bool in_soa   = (masks[i * words + j / 32] >> (j % 32)) & 1u;
+
+      reference_pairs += expected ? 1 : 0;
+      mismatch += (pair != expected || in_soa != expected) ? 1 : 0;
+    }
+  }
+
+  bench::check(mismatch == 0, "pair and soa tests find the same overlaps as the reference");
+  bench::check(soa_pairs == reference_pairs, "soa pair count matches the reference");
+
+  const double pair_ms = bench::time_ms([&]{
+    size_t pairs = 0;
+    for(size_t i = 0; i < count; ++i) { for(size_t j = 0; j < count; ++j) { pairs += math::aabb_intersection_test(boxes[i], boxes[j]) ? 1 : 0; } }
+    bench::keep((float)pairs);
+  }, 3);
+
+  const double soa_ms = bench::time_ms([&]{
+    bench::keep((float)math::aabb_soa_test_aabb_soa(soa, soa, masks.data()));
+  }, 3);
+
+  printf("aabb broadphase, %zu boxes, %zu overlapping pairs\n", count, reference_pairs);
+  printf("  a pair at a time  %8.3f ms\n", pair_ms);
+  printf("  aabb_soa          %8.3f ms  (%.2fx)\n", soa_ms, pair_ms / soa_ms);
+
+  return bench::failure_count() ? 1 : 0;
+}
@@ -0,0 +1,83 @@
+#ifndef BENCH_INCLUDED_5C3F0E2A_8D41_4B7E_9A16_2F7D3C8B1E54
+#define BENCH_INCLUDED_5C3F0E2A_8D41_4B7E_9A16_2F7D3C8B1E54
+
+
+/*
+  Bench
+  --
+  Shared bits for the benchmarks in this folder. Each bench checks its
+  results before timing anything and returns non zero if they are wrong,
+  so `rake bench` also fails on a broken ISA level.
+*/
+
+
+#include <chrono>
+#include <stdio.h>
+#include <stdint.h>
+
+
+namespace bench {
+
+
+// Best of a few runs in ms, so one run the OS got in the way of doesn't count.
+template<typename Fn>
+inline double
+time_ms(const Fn &fn, const int runs = 5)
+{
+  double best = 0.0;
+
+  for(int i = 0; i < runs; ++i)
+  {
+    const auto start = std::chrono::high_resolution_clock::now();
+    fn();
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    best = (i == 0 || ms < best) ? ms : best;
+  }
+
+  return best;
+}
+
+
+// Stops the compiler dropping work whose result is never read.
+inline void
+keep(const float value)
+{
+  static volatile float sink = 0.f;
+  sink = sink + value;
+}
+
+
+inline int&
+failure_count()
+{
+  static int count = 0;
+  return count;
+}
+
+
+inline void
+check(const bool ok, const char *what)
+{
+  if(!ok)
+  {
+    printf("FAILED: %s\n", what);
+    ++failure_count();
+  }
+}
+
+
+// Small and repeatable, so every run and every level sees the same data.
+inline float
+random_float(uint32_t &state, const float min, const float max)
+{
+  state = state * 1664525u + 1013904223u;
+  return min + (max - min) * (float)(state >> 8) / (float)(1u << 24);
+}
+
+
+} // ns
+
+
+#endif // inc guard
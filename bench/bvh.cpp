@@ -0,0 +1,87 @@
+/*
+  bvh_test_ray against ray_test_triangles' linear scan of the same
+  triangle soup. The BVH is checked to find the same closest hits first.
+*/
+
+
+#include "bench.hpp"
+#include <math/math.hpp>
+#include <vector>
+
+
+int
+main()
+{
+  const size_t tri_count = 200000;
+  const size_t ray_count = 20000;
+  const size_t linear_ray_count = 100;
+  uint32_t seed = 1;
+
+  // Small triangles spread through a box, about what a scene's worth of meshes looks like.
+  std::vector<float> tris(tri_count * 9);
+
+  for(size_t i = 0; i < tri_count; ++i)
+  {
+    const float center[3] = {bench::random_float(seed, -100.f, 100.f), bench::random_float(seed, -100.f, 100.f), bench::random_float(seed, -100.f, 100.f)};
+
+    for(uint32_t k = 0; k < 9; ++k)
+    {
+      tris[i * 9 + k] = center[k % 3] + bench::random_float(seed, -1.f, 1.f);
+    }
+  }
+
+  std::vector<math::ray> rays(ray_count);
+
+  for(math::ray &ray : rays)
+  {
+    const math::vec3 start = math::vec3_init(bench::random_float(seed, -120.f, 120.f), bench::random_float(seed, -120.f, 120.f), bench::random_float(seed, -120.f, 120.f));
+    const math::vec3 end   = math::vec3_init(bench::random_float(seed, -10.f, 10.f), bench::random_float(seed, -10.f, 10.f), bench::random_float(seed, -10.f, 10.f));
+
+    ray = math::ray_init(start, end);
+  }
+
+  math::bvh mesh_bvh;
+  const double build_ms = bench::time_ms([&]{ mesh_bvh = math::bvh_init(tris.data(), tri_count); }, 1);
+
+  // Closest hits must match the linear scan, occlusion must match too.
+  size_t hit_count = 0;
+  size_t mismatch  = 0;
+
+  for(size_t i = 0; i < linear_ray_count; ++i)
+  {
+    math::ray_hit linear_hit{}, bvh_hit{};
+
+    const bool linear = math::ray_test_triangles(rays[i], tris.data(), tri_count, math::ray_query::closest_hit, math::ray_cull::none, &linear_hit);
+    const bool tree   = math::bvh_test_ray(mesh_bvh, rays[i], math::ray_query::closest_hit, math::ray_cull::none, &bvh_hit);
+    const bool any    = math::bvh_test_ray(mesh_bvh, rays[i], math::ray_query::any_hit, math::ray_cull::none);
+
+    hit_count += linear ? 1 : 0;
+    mismatch  += (linear != tree || linear != any || (linear && (linear_hit.triangle != bvh_hit.triangle || linear_hit.distance != bvh_hit.distance))) ? 1 : 0;
+  }
+
+  bench::check(hit_count > 0, "some rays hit, so the hit check means something");
+  bench::check(mismatch == 0, "bvh finds the same closest hits as the linear scan");
+
+  const double bvh_ms = bench::time_ms([&]{
+    size_t hits = 0;
+    math::ray_hit hit;
+    for(const math::ray &ray : rays) { hits += math::bvh_test_ray(mesh_bvh, ray, &hit) ? 1 : 0; }
+    bench::keep((float)hits);
+  }, 3);
+
+  const double linear_ms = bench::time_ms([&]{
+    size_t hits = 0;
+    math::ray_hit hit;
+    for(size_t i = 0; i < linear_ray_count; ++i) { hits += math::ray_test_triangles(rays[i], tris.data(), tri_count, math::ray_query::closest_hit, math::ray_cull::back_faces, &hit) ? 1 : 0; }
+    bench::keep((float)hits);
+  }, 1);
+
+  const double bvh_us    = bvh_ms * 1e3 / ray_count;
+  const double linear_us = linear_ms * 1e3 / linear_ray_count;
+
+  printf("bvh, %zu triangles, %zu nodes, built in %.1f ms\n", tri_count, mesh_bvh.nodes.size(), build_ms);
+  printf("  linear   %10.2f us a ray\n", linear_us);
+  printf("  bvh      %10.2f us a ray  (%.0fx)\n", bvh_us, linear_us / bvh_us);
+
+  return bench::failure_count() ? 1 : 0;
+}
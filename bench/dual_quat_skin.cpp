@@ -0,0 +1,130 @@
+/*
+  dual_quat_skin against moving each vertex on its own with
+  dual_quat_transform_point, on a palette of random rigid joints.
+*/
+
+
+#include "bench.hpp"
+#include <math/math.hpp>
+#include <vector>
+
+
+namespace {
+
+
+// The blend dual_quat_skin does, one vertex at a time.
+math::dual_quat
+blend_vertex(const math::dual_quat palette[], const uint16_t joints[4], const float weights[4])
+{
+  const math::dual_quat &first = palette[joints[0]];
+
+  math::quat real = math::quat_scale(first.real, weights[0]);
+  math::quat dual = math::quat_scale(first.dual, weights[0]);
+
+  for(uint32_t j = 1; j < 4; ++j)
+  {
+    const math::dual_quat &joint = palette[joints[j]];
+    const float weight = math::quat_dot(first.real, joint.real) < 0.f ? -weights[j] : weights[j];
+
+    real = math::detail::quat_blend(real, 1.f, joint.real, weight);
+    dual = math::detail::quat_blend(dual, 1.f, joint.dual, weight);
+  }
+
+  return math::dual_quat_normalize(math::dual_quat{real, dual});
+}
+
+
+void
+skin_per_vertex(const math::dual_quat palette[], const float in_positions[], const float in_normals[], const uint16_t joints[], const float weights[], float out_positions[], float out_normals[], const size_t vertex_count)
+{
+  for(size_t i = 0; i < vertex_count; ++i)
+  {
+    const math::dual_quat blend = blend_vertex(palette, &joints[i * 4], &weights[i * 4]);
+
+    math::vec3_to_array(math::dual_quat_transform_point(blend, math::vec3_init_with_array(&in_positions[i * 3])), &out_positions[i * 3]);
+    math::vec3_to_array(math::dual_quat_transform_direction(blend, math::vec3_init_with_array(&in_normals[i * 3])), &out_normals[i * 3]);
+  }
+}
+
+
+} // ns
+
+
+int
+main()
+{
+  const size_t joint_count  = 64;
+  const size_t vertex_count = 100003; // Not a multiple of four, so the tail is checked.
+  uint32_t seed = 1;
+
+  std::vector<math::dual_quat> palette(joint_count);
+
+  for(math::dual_quat &joint : palette)
+  {
+    const math::vec3 axis = math::vec3_normalize(math::vec3_init(bench::random_float(seed, -1.f, 1.f), bench::random_float(seed, -1.f, 1.f), 1.f));
+    const math::quat rotation = math::quat_init_with_axis_angle(axis, bench::random_float(seed, -3.f, 3.f));
+
+    joint = math::dual_quat_init(rotation, math::vec3_init(bench::random_float(seed, -5.f, 5.f), bench::random_float(seed, -5.f, 5.f), bench::random_float(seed, -5.f, 5.f)));
+  }
+
+  std::vector<float> positions(vertex_count * 3), normals(vertex_count * 3), weights(vertex_count * 4);
+  std::vector<uint16_t> joints(vertex_count * 4);
+
+  for(size_t i = 0; i < vertex_count; ++i)
+  {
+    const math::vec3 normal = math::vec3_normalize(math::vec3_init(bench::random_float(seed, -1.f, 1.f), bench::random_float(seed, -1.f, 1.f), 0.5f));
+
+    math::vec3_to_array(math::vec3_init(bench::random_float(seed, -2.f, 2.f), bench::random_float(seed, -2.f, 2.f), bench::random_float(seed, -2.f, 2.f)), &positions[i * 3]);
+    math::vec3_to_array(normal, &normals[i * 3]);
+
+    float total = 0.f;
+
+    for(uint32_t j = 0; j < 4; ++j)
+    {
+      joints[i * 4 + j]  = (uint16_t)(bench::random_float(seed, 0.f, (float)joint_count - 0.01f));
+      weights[i * 4 + j] = bench::random_float(seed, 0.f, 1.f);
+      total += weights[i * 4 + j];
+    }
+
+    for(uint32_t j = 0; j < 4; ++j)
+    {
+      weights[i * 4 + j] /= total;
+    }
+  }
+
+  std::vector<float> out_positions(vertex_count * 3), out_normals(vertex_count * 3);
+  std::vector<float> ref_positions(vertex_count * 3), ref_normals(vertex_count * 3);
+
+  math::dual_quat_skin(palette.data(), positions.data(), normals.data(), joints.data(), weights.data(), out_positions.data(), out_normals.data(), vertex_count);
+  skin_per_vertex(palette.data(), positions.data(), normals.data(), joints.data(), weights.data(), ref_positions.data(), ref_normals.data(), vertex_count);
+
+  float worst = 0.f;
+
+  for(size_t i = 0; i < vertex_count * 3; ++i)
+  {
+    const float position_error = math::abs(out_positions[i] - ref_positions[i]);
+    const float normal_error   = math::abs(out_normals[i] - ref_normals[i]);
+
+    worst = position_error > worst ? position_error : worst;
+    worst = normal_error > worst ? normal_error : worst;
+  }
+
+  bench::check(worst < 1e-4f, "dual_quat_skin matches moving each vertex on its own");
+
+  const double skin_ms = bench::time_ms([&]{
+    math::dual_quat_skin(palette.data(), positions.data(), normals.data(), joints.data(), weights.data(), out_positions.data(), out_normals.data(), vertex_count);
+    bench::keep(out_positions[vertex_count / 2]);
+  });
+
+  const double vertex_ms = bench::time_ms([&]{
+    skin_per_vertex(palette.data(), positions.data(), normals.data(), joints.data(), weights.data(), ref_positions.data(), ref_normals.data(), vertex_count);
+    bench::keep(ref_positions[vertex_count / 2]);
+  });
+
+  printf("dual quat skin, %zu vertices, %zu joints\n", vertex_count, joint_count);
+  printf("  per vertex      %8.3f ms  %6.2f ns a vertex\n", vertex_ms, vertex_ms * 1e6 / vertex_count);
+  printf("  dual_quat_skin  %8.3f ms  %6.2f ns a vertex  (%.2fx)\n", skin_ms, skin_ms * 1e6 / vertex_count, vertex_ms / skin_ms);
+  printf("  worst difference %g\n", worst);
+
+  return bench::failure_count() ? 1 : 0;
+}
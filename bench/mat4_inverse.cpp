@@ -0,0 +1,228 @@
+/*
+  mat4_get_inverse and mat4_get_inverse_affine against the scalar
+  cofactor inverse they replaced, on rotation, axis scale and
+  translation matrices the affine path is meant for.
+*/
+
+
+#include "bench.hpp"
+#include <math/math.hpp>
+#include <vector>
+#include <assert.h>
+
+
+namespace {
+
+
+/*
+  mat4_get_inverse as it was before the SSE block inverse, only timed.
+  It returns the transpose and expands the determinant with the wrong
+  cofactors, so its results aren't checked.
+*/
+math::mat4
+baseline_get_inverse(const math::mat4 &to_inverse)
+{
+  const math::detail::internal_mat4 *to_i = reinterpret_cast<const math::detail::internal_mat4*>(&to_inverse);
+
+  float inverse[16]
+  {
+    to_i->data[5]  * to_i->data[10] * to_i->data[15] -
+    to_i->data[5]  * to_i->data[11] * to_i->data[14] -
+    to_i->data[9]  * to_i->data[6]  * to_i->data[15] +
+    to_i->data[9]  * to_i->data[7]  * to_i->data[14] +
+    to_i->data[13] * to_i->data[6]  * to_i->data[11] -
+    to_i->data[13] * to_i->data[7]  * to_i->data[10],
+
+    -to_i->data[4]  * to_i->data[10] * to_i->data[15] +
+    to_i->data[4]  * to_i->data[11] * to_i->data[14] +
+    to_i->data[8]  * to_i->data[6]  * to_i->data[15] -
+    to_i->data[8]  * to_i->data[7]  * to_i->data[14] -
+    to_i->data[12] * to_i->data[6]  * to_i->data[11] +
+    to_i->data[12] * to_i->data[7]  * to_i->data[10],
+
+    to_i->data[4]  * to_i->data[9] * to_i->data[15] -
+    to_i->data[4]  * to_i->data[11] * to_i->data[13] -
+    to_i->data[8]  * to_i->data[5] * to_i->data[15] +
+    to_i->data[8]  * to_i->data[7] * to_i->data[13] +
+    to_i->data[12] * to_i->data[5] * to_i->data[11] -
+    to_i->data[12] * to_i->data[7] * to_i->data[9],
+
+    -to_i->data[4]  * to_i->data[9] * to_i->data[14] +
+    to_i->data[4]  * to_i->data[10] * to_i->data[13] +
+    to_i->data[8]  * to_i->data[5] * to_i->data[14] -
+    to_i->data[8]  * to_i->data[6] * to_i->data[13] -
+    to_i->data[12] * to_i->data[5] * to_i->data[10] +
+    to_i->data[12] * to_i->data[6] * to_i->data[9],
+
+    -to_i->data[1]  * to_i->data[10] * to_i->data[15] +
+    to_i->data[1]  * to_i->data[11] * to_i->data[14] +
+    to_i->data[9]  * to_i->data[2] * to_i->data[15] -
+    to_i->data[9]  * to_i->data[3] * to_i->data[14] -
+    to_i->data[13] * to_i->data[2] * to_i->data[11] +
+    to_i->data[13] * to_i->data[3] * to_i->data[10],
+
+    to_i->data[0]  * to_i->data[10] * to_i->data[15] -
+    to_i->data[0]  * to_i->data[11] * to_i->data[14] -
+    to_i->data[8]  * to_i->data[2] * to_i->data[15] +
+    to_i->data[8]  * to_i->data[3] * to_i->data[14] +
+    to_i->data[12] * to_i->data[2] * to_i->data[11] -
+    to_i->data[12] * to_i->data[3] * to_i->data[10],
+
+    -to_i->data[0]  * to_i->data[9] * to_i->data[15] +
+    to_i->data[0]  * to_i->data[11] * to_i->data[13] +
+    to_i->data[8]  * to_i->data[1] * to_i->data[15] -
+    to_i->data[8]  * to_i->data[3] * to_i->data[13] -
+    to_i->data[12] * to_i->data[1] * to_i->data[11] +
+    to_i->data[12] * to_i->data[3] * to_i->data[9],
+
+    to_i->data[0]  * to_i->data[9] * to_i->data[14] -
+    to_i->data[0]  * to_i->data[10] * to_i->data[13] -
+    to_i->data[8]  * to_i->data[1] * to_i->data[14] +
+    to_i->data[8]  * to_i->data[2] * to_i->data[13] +
+    to_i->data[12] * to_i->data[1] * to_i->data[10] -
+    to_i->data[12] * to_i->data[2] * to_i->data[9],
+
+    to_i->data[1]  * to_i->data[6] * to_i->data[15] -
+    to_i->data[1]  * to_i->data[7] * to_i->data[14] -
+    to_i->data[5]  * to_i->data[2] * to_i->data[15] +
+    to_i->data[5]  * to_i->data[3] * to_i->data[14] +
+    to_i->data[13] * to_i->data[2] * to_i->data[7] -
+    to_i->data[13] * to_i->data[3] * to_i->data[6],
+
+    -to_i->data[0]  * to_i->data[6] * to_i->data[15] +
+    to_i->data[0]  * to_i->data[7] * to_i->data[14] +
+    to_i->data[4]  * to_i->data[2] * to_i->data[15] -
+    to_i->data[4]  * to_i->data[3] * to_i->data[14] -
+    to_i->data[12] * to_i->data[2] * to_i->data[7] +
+    to_i->data[12] * to_i->data[3] * to_i->data[6],
+
+    to_i->data[0]  * to_i->data[5] * to_i->data[15] -
+    to_i->data[0]  * to_i->data[7] * to_i->data[13] -
+    to_i->data[4]  * to_i->data[1] * to_i->data[15] +
+    to_i->data[4]  * to_i->data[3] * to_i->data[13] +
+    to_i->data[12] * to_i->data[1] * to_i->data[7] -
+    to_i->data[12] * to_i->data[3] * to_i->data[5],
+
+    -to_i->data[0]  * to_i->data[5] * to_i->data[14] +
+     to_i->data[0]  * to_i->data[6] * to_i->data[13] +
+     to_i->data[4]  * to_i->data[1] * to_i->data[14] -
+     to_i->data[4]  * to_i->data[2] * to_i->data[13] -
+     to_i->data[12] * to_i->data[1] * to_i->data[6] +
+     to_i->data[12] * to_i->data[2] * to_i->data[5],
+
+    -to_i->data[1] * to_i->data[6] * to_i->data[11] +
+    to_i->data[1] * to_i->data[7] * to_i->data[10] +
+    to_i->data[5] * to_i->data[2] * to_i->data[11] -
+    to_i->data[5] * to_i->data[3] * to_i->data[10] -
+    to_i->data[9] * to_i->data[2] * to_i->data[7] +
+    to_i->data[9] * to_i->data[3] * to_i->data[6],
+
+    to_i->data[0] * to_i->data[6] * to_i->data[11] -
+    to_i->data[0] * to_i->data[7] * to_i->data[10] -
+    to_i->data[4] * to_i->data[2] * to_i->data[11] +
+    to_i->data[4] * to_i->data[3] * to_i->data[10] +
+    to_i->data[8] * to_i->data[2] * to_i->data[7] -
+    to_i->data[8] * to_i->data[3] * to_i->data[6],
+
+    -to_i->data[0] * to_i->data[5] * to_i->data[11] +
+     to_i->data[0] * to_i->data[7] * to_i->data[9] +
+     to_i->data[4] * to_i->data[1] * to_i->data[11] -
+     to_i->data[4] * to_i->data[3] * to_i->data[9] -
+     to_i->data[8] * to_i->data[1] * to_i->data[7] +
+     to_i->data[8] * to_i->data[3] * to_i->data[5],
+
+    to_i->data[0] * to_i->data[5] * to_i->data[10] -
+    to_i->data[0] * to_i->data[6] * to_i->data[9] -
+    to_i->data[4] * to_i->data[1] * to_i->data[10] +
+    to_i->data[4] * to_i->data[2] * to_i->data[9] +
+    to_i->data[8] * to_i->data[1] * to_i->data[6] -
+    to_i->data[8] * to_i->data[2] * to_i->data[5],
+  };
+
+  const float determinant = to_i->data[0] * inverse[0] + to_i->data[1] * inverse[4] + to_i->data[2] * inverse[8] + to_i->data[3] * inverse[12];
+
+  assert(determinant != 0);
+
+  const float one_over_det = 1.f / determinant;
+
+  for (auto &i : inverse)
+  {
+    i = i * one_over_det;
+  }
+
+  return math::mat4_init_with_array(inverse);
+}
+
+
+} // ns
+
+
+int
+main()
+{
+  const size_t count = 1 << 16;
+  uint32_t seed = 1;
+
+  std::vector<math::mat4> mats(count);
+
+  for(math::mat4 &mat : mats)
+  {
+    const math::vec3 axis = math::vec3_normalize(math::vec3_init(bench::random_float(seed, -1.f, 1.f), bench::random_float(seed, -1.f, 1.f), 1.f));
+    const math::mat4 rotate = math::mat4_rotate_around_axis(axis, bench::random_float(seed, -3.f, 3.f));
+    const math::mat4 scale = math::mat4_scale(bench::random_float(seed, 0.5f, 2.f), bench::random_float(seed, 0.5f, 2.f), bench::random_float(seed, 0.5f, 2.f));
+    const math::mat4 move = math::mat4_translate(bench::random_float(seed, -10.f, 10.f), bench::random_float(seed, -10.f, 10.f), bench::random_float(seed, -10.f, 10.f));
+
+    mat = math::mat4_multiply(scale, rotate, move);
+  }
+
+  // Both inverses should agree, and undo the matrix.
+  float worst_diff = 0.f;
+  float worst_id   = 0.f;
+
+  for(const math::mat4 &mat : mats)
+  {
+    const math::mat4 affine     = math::mat4_get_inverse_affine(mat);
+    const math::mat4 general    = math::mat4_get_inverse(mat);
+    const math::mat4 affine_id  = math::mat4_multiply(mat, affine);
+    const math::mat4 general_id = math::mat4_multiply(mat, general);
+
+    for(uint32_t i = 0; i < 16; ++i)
+    {
+      const float diff        = math::abs(math::mat4_get(affine, i) - math::mat4_get(general, i));
+      const float affine_off  = math::abs(math::mat4_get(affine_id, i) - ((i % 5) == 0 ? 1.f : 0.f));
+      const float general_off = math::abs(math::mat4_get(general_id, i) - ((i % 5) == 0 ? 1.f : 0.f));
+
+      worst_diff = diff > worst_diff ? diff : worst_diff;
+      worst_id   = affine_off > worst_id ? affine_off : worst_id;
+      worst_id   = general_off > worst_id ? general_off : worst_id;
+    }
+  }
+
+  bench::check(worst_diff < 1e-4f, "affine and general inverse agree");
+  bench::check(worst_id < 1e-4f, "matrix times either inverse is identity");
+
+  std::vector<math::mat4> out(count);
+
+  const double baseline_ms = bench::time_ms([&]{
+    for(size_t i = 0; i < count; ++i) { out[i] = baseline_get_inverse(mats[i]); }
+    bench::keep(math::mat4_get(out[count / 2], 12));
+  });
+
+  const double affine_ms = bench::time_ms([&]{
+    for(size_t i = 0; i < count; ++i) { out[i] = math::mat4_get_inverse_affine(mats[i]); }
+    bench::keep(math::mat4_get(out[count / 2], 12));
+  });
+
+  const double general_ms = bench::time_ms([&]{
+    for(size_t i = 0; i < count; ++i) { out[i] = math::mat4_get_inverse(mats[i]); }
+    bench::keep(math::mat4_get(out[count / 2], 12));
+  });
+
+  printf("mat4 inverse, %zu matrices\n", count);
+  printf("  baseline %8.3f ms  %6.2f ns each\n", baseline_ms, baseline_ms * 1e6 / count);
+  printf("  general  %8.3f ms  %6.2f ns each  (%.2fx)\n", general_ms, general_ms * 1e6 / count, baseline_ms / general_ms);
+  printf("  affine   %8.3f ms  %6.2f ns each  (%.2fx)\n", affine_ms, affine_ms * 1e6 / count, baseline_ms / affine_ms);
+  printf("  worst difference %g, worst off identity %g\n", worst_diff, worst_id);
+
+  return bench::failure_count() ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+/*
+  quat_slerp_fast and quat_slerp_array against quat_slerp, for speed,
+  and against a slerp worked out in double, for accuracy. The check is
+  the bound quat.hpp gives for quat_slerp_fast.
+*/
+
+
+#include "bench.hpp"
+#include <math/math.hpp>
+#include <math.h>
+#include <vector>
+
+
+namespace {
+
+
+// Slerp in double, the shortest path, as exact as this gets.
+void
+exact_slerp(const math::quat start, const math::quat end, const float dt, double out[4])
+{
+  double a[4], b[4];
+  double cos_angle = 0.0;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    a[i] = math::quat_get(start, i);
+    b[i] = math::quat_get(end, i);
+    cos_angle += a[i] * b[i];
+  }
+
+  const double end_sign = cos_angle < 0.0 ? -1.0 : 1.0;
+  const double angle    = acos(fmin(cos_angle * end_sign, 1.0));
+
+  const double start_weight = angle < 1e-9 ? 1.0 - dt : sin((1.0 - dt) * angle) / sin(angle);
+  const double end_weight   = angle < 1e-9 ? dt : sin(dt * angle) / sin(angle);
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    out[i] = a[i] * start_weight + b[i] * end_weight * end_sign;
+  }
+}
+
+
+float
+component_error(const math::quat result, const double exact[4])
+{
+  float worst = 0.f;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    const float error = (float)fabs(math::quat_get(result, i) - exact[i]);
+    worst = error > worst ? error : worst;
+  }
+
+  return worst;
+}
+
+
+math::quat
+random_quat(uint32_t &seed)
+{
+  const math::vec3 axis = math::vec3_normalize(math::vec3_init(bench::random_float(seed, -1.f, 1.f), bench::random_float(seed, -1.f, 1.f), bench::random_float(seed, -1.f, 1.f)));
+  return math::quat_init_with_axis_angle(axis, bench::random_float(seed, -math::tau(), math::tau()));
+}
+
+
+} // ns
+
+
+int
+main()
+{
+  // Must match the bound on quat_slerp_fast in quat.hpp.
+  const float fast_bound = 4e-5f;
+
+  const size_t count = 1 << 16;
+  uint32_t seed = 1;
+
+  std::vector<math::quat> start(count), end(count), out(count);
+  std::vector<float> dt(count);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    start[i] = random_quat(seed);
+    end[i]   = random_quat(seed);
+    dt[i]    = bench::random_float(seed, 0.f, 1.f);
+  }
+
+  float slerp_error = 0.f;
+  float fast_error  = 0.f;
+  float array_error = 0.f;
+
+  math::quat_slerp_array(start.data(), end.data(), dt.data(), out.data(), count);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    double exact[4];
+    exact_slerp(start[i], end[i], dt[i], exact);
+
+    const float slerp = component_error(math::quat_slerp(start[i], end[i], dt[i]), exact);
+    const float fast  = component_error(math::quat_slerp_fast(start[i], end[i], dt[i]), exact);
+    const float array = component_error(out[i], exact);
+
+    slerp_error = slerp > slerp_error ? slerp : slerp_error;
+    fast_error  = fast > fast_error ? fast : fast_error;
+    array_error = array > array_error ? array : array_error;
+  }
+
+  bench::check(fast_error < fast_bound, "quat_slerp_fast within its bound of an exact slerp");
+  bench::check(array_error < fast_bound, "quat_slerp_array within its bound of an exact slerp");
+
+  const double slerp_ms = bench::time_ms([&]{
+    for(size_t i = 0; i < count; ++i) { out[i] = math::quat_slerp(start[i], end[i], dt[i]); }
+    bench::keep(math::quat_get_w(out[count / 2]));
+  });
+
+  const double fast_ms = bench::time_ms([&]{
+    for(size_t i = 0; i < count; ++i) { out[i] = math::quat_slerp_fast(start[i], end[i], dt[i]); }
+    bench::keep(math::quat_get_w(out[count / 2]));
+  });
+
+  const double array_ms = bench::time_ms([&]{
+    math::quat_slerp_array(start.data(), end.data(), dt.data(), out.data(), count);
+    bench::keep(math::quat_get_w(out[count / 2]));
+  });
+
+  printf("quat slerp, %zu pairs, worst component error against a double slerp\n", count);
+  printf("  quat_slerp        %8.3f ms  %6.2f ns each              error %.2e\n", slerp_ms, slerp_ms * 1e6 / count, slerp_error);
+  printf("  quat_slerp_fast   %8.3f ms  %6.2f ns each  (%.2fx)  error %.2e\n", fast_ms, fast_ms * 1e6 / count, slerp_ms / fast_ms, fast_error);
+  printf("  quat_slerp_array  %8.3f ms  %6.2f ns each  (%.2fx)  error %.2e\n", array_ms, array_ms * 1e6 / count, slerp_ms / array_ms, array_error);
+
+  return bench::failure_count() ? 1 : 0;
+}
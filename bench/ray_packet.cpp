@@ -0,0 +1,161 @@
+/*
+  ray_packet4 and ray_packet8 against testing the same coherent rays one
+  at a time, for triangles and for boxes. The packets are checked to hit
+  what the single rays hit first.
+*/
+
+
+#include "bench.hpp"
+#include <math/math.hpp>
+#include <vector>
+
+
+int
+main()
+{
+  // Rays through the edges and corners of one triangle, where u, v or u + v sit on 0 or 1.
+  {
+    const float tri[9] = {0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f};
+    const float through[8][2] = {{0.f, 0.5f}, {0.5f, 0.f}, {0.5f, 0.5f}, {0.25f, 0.25f}, {0.f, 0.f}, {1.f, 0.f}, {0.f, 1.f}, {0.75f, 0.75f}};
+
+    math::ray rays[8];
+    uint32_t single_mask = 0;
+
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+      rays[i] = math::ray_init(math::vec3_init(through[i][0], through[i][1], -1.f), math::vec3_init(through[i][0], through[i][1], 1.f));
+      single_mask |= (math::ray_test_triangles(rays[i], tri, 1, math::ray_query::closest_hit, math::ray_cull::none) ? 1u : 0u) << i;
+    }
+
+    math::ray_hit hits[8];
+
+    bench::check(math::ray_packet8_test_triangles(math::ray_packet8_init(rays, 8), tri, 1, math::ray_query::closest_hit, math::ray_cull::none, hits) == single_mask, "packet8 agrees with single rays on triangle edges");
+    bench::check(math::ray_packet4_test_triangles(math::ray_packet4_init(rays, 4), tri, 1, math::ray_query::closest_hit, math::ray_cull::none, hits) == (single_mask & 0xF), "packet4 agrees with single rays on triangle edges");
+    bench::check(math::ray_packet4_test_triangles(math::ray_packet4_init(rays + 4, 4), tri, 1, math::ray_query::closest_hit, math::ray_cull::none, hits) == (single_mask >> 4), "packet4 agrees with single rays on triangle corners");
+  }
+
+  const size_t tri_count = 2000;
+  const size_t box_count = 2000;
+  const size_t ray_count = 4000; // A multiple of eight.
+  uint32_t seed = 1;
+
+  std::vector<float> tris(tri_count * 9);
+
+  for(size_t i = 0; i < tri_count; ++i)
+  {
+    const float center[3] = {bench::random_float(seed, -10.f, 10.f), bench::random_float(seed, -10.f, 10.f), bench::random_float(seed, -10.f, 10.f)};
+
+    for(uint32_t k = 0; k < 9; ++k)
+    {
+      tris[i * 9 + k] = center[k % 3] + bench::random_float(seed, -1.f, 1.f);
+    }
+  }
+
+  std::vector<math::aabb> boxes(box_count);
+
+  for(math::aabb &box : boxes)
+  {
+    const math::vec3 center = math::vec3_init(bench::random_float(seed, -10.f, 10.f), bench::random_float(seed, -10.f, 10.f), bench::random_float(seed, -10.f, 10.f));
+    const math::vec3 extent = math::vec3_init(0.5f, 0.5f, 0.5f);
+
+    box = math::aabb_init(math::vec3_subtract(center, extent), math::vec3_add(center, extent));
+  }
+
+  // Primary rays through a small window, neighbours go close to the same way.
+  std::vector<math::ray> rays(ray_count);
+
+  for(math::ray &ray : rays)
+  {
+    const math::vec3 start = math::vec3_init(bench::random_float(seed, -1.f, 1.f), bench::random_float(seed, -1.f, 1.f), -20.f);
+    const math::vec3 end   = math::vec3_init(bench::random_float(seed, -10.f, 10.f), bench::random_float(seed, -10.f, 10.f), 20.f);
+
+    ray = math::ray_init(start, end);
+  }
+
+  // Packets hit the same triangles and boxes as the single rays.
+  size_t triangle_mismatch = 0;
+  size_t box_mismatch = 0;
+
+  for(size_t i = 0; i < 256; i += 8)
+  {
+    const math::ray_packet8 packet8 = math::ray_packet8_init(&rays[i]);
+    const math::ray_packet4 packet4 = math::ray_packet4_init(&rays[i]);
+
+    math::ray_hit hits8[8], hits4[4];
+    const uint32_t mask8 = math::ray_packet8_test_triangles(packet8, tris.data(), tri_count, math::ray_query::closest_hit, math::ray_cull::none, hits8);
+    const uint32_t mask4 = math::ray_packet4_test_triangles(packet4, tris.data(), tri_count, math::ray_query::closest_hit, math::ray_cull::none, hits4);
+
+    for(uint32_t lane = 0; lane < 8; ++lane)
+    {
+      math::ray_hit hit{};
+      const bool single = math::ray_test_triangles(rays[i + lane], tris.data(), tri_count, math::ray_query::closest_hit, math::ray_cull::none, &hit);
+      const bool in8 = (mask8 >> lane) & 1u;
+
+      triangle_mismatch += (single != in8 || (single && hits8[lane].triangle != hit.triangle)) ? 1 : 0;
+
+      if(lane < 4)
+      {
+        const bool in4 = (mask4 >> lane) & 1u;
+        triangle_mismatch += (single != in4 || (single && hits4[lane].triangle != hit.triangle)) ? 1 : 0;
+      }
+    }
+
+    for(size_t b = 0; b < box_count; ++b)
+    {
+      const uint32_t box_mask = math::ray_packet8_test_aabb(packet8, boxes[b]);
+
+      for(uint32_t lane = 0; lane < 8; ++lane)
+      {
+        const bool single = math::ray_prepared_test_aabb(math::ray_prepared_init(rays[i + lane]), boxes[b]);
+        box_mismatch += single != (((box_mask >> lane) & 1u) != 0) ? 1 : 0;
+      }
+    }
+  }
+
+  bench::check(triangle_mismatch == 0, "packets hit the same closest triangles as single rays");
+  bench::check(box_mismatch == 0, "packets hit the same boxes as prepared single rays");
+
+  const double single_ms = bench::time_ms([&]{
+    size_t hits = 0;
+    math::ray_hit hit;
+    for(const math::ray &ray : rays) { hits += math::ray_test_triangles(ray, tris.data(), tri_count, math::ray_query::closest_hit, math::ray_cull::none, &hit) ? 1 : 0; }
+    bench::keep((float)hits);
+  }, 3);
+
+  const double packet4_ms = bench::time_ms([&]{
+    uint32_t hits = 0;
+    math::ray_hit hit[4];
+    for(size_t i = 0; i < ray_count; i += 4) { hits ^= math::ray_packet4_test_triangles(math::ray_packet4_init(&rays[i]), tris.data(), tri_count, math::ray_query::closest_hit, math::ray_cull::none, hit); }
+    bench::keep((float)hits);
+  }, 3);
+
+  const double packet8_ms = bench::time_ms([&]{
+    uint32_t hits = 0;
+    math::ray_hit hit[8];
+    for(size_t i = 0; i < ray_count; i += 8) { hits ^= math::ray_packet8_test_triangles(math::ray_packet8_init(&rays[i]), tris.data(), tri_count, math::ray_query::closest_hit, math::ray_cull::none, hit); }
+    bench::keep((float)hits);
+  }, 3);
+
+  std::vector<uint32_t> box_masks(box_count);
+
+  const double box_single_ms = bench::time_ms([&]{
+    size_t hits = 0;
+    for(const math::ray &ray : rays) { hits += math::ray_prepared_test_aabbs(math::ray_prepared_init(ray), boxes.data(), box_count, nullptr); }
+    bench::keep((float)hits);
+  }, 3);
+
+  const double box_packet8_ms = bench::time_ms([&]{
+    uint32_t hits = 0;
+    for(size_t i = 0; i < ray_count; i += 8) { hits ^= math::ray_packet8_test_aabbs(math::ray_packet8_init(&rays[i]), boxes.data(), box_count, box_masks.data()); }
+    bench::keep((float)hits);
+  }, 3);
+
+  printf("ray packets, %zu rays against %zu triangles and %zu boxes\n", ray_count, tri_count, box_count);
+  printf("  triangles, single    %8.3f ms\n", single_ms);
+  printf("  triangles, packet4   %8.3f ms  (%.2fx)\n", packet4_ms, single_ms / packet4_ms);
+  printf("  triangles, packet8   %8.3f ms  (%.2fx)\n", packet8_ms, single_ms / packet8_ms);
+  printf("  boxes, prepared      %8.3f ms\n", box_single_ms);
+  printf("  boxes, packet8       %8.3f ms  (%.2fx)\n", box_packet8_ms, box_single_ms / box_packet8_ms);
+
+  return bench::failure_count() ? 1 : 0;
+}
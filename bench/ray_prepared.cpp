@@ -0,0 +1,88 @@
+/*
+  ray_prepared_test_aabbs against ray_test_aabb on many boxes. First
+  checks rays running along a box face, where an axis aligned ray gets
+  0 * inf for a slab, give the same answer as the packets.
+*/
+
+
+#include "bench.hpp"
+#include <math/math.hpp>
+#include <vector>
+
+
+int
+main()
+{
+  // Rays along x in the y = 0 and y = 1 faces, both ways, and a miss.
+  {
+    const math::aabb box = math::aabb_init(math::vec3_init(0.f, 0.f, 0.f), math::vec3_init(1.f, 1.f, 1.f));
+    const float face_y[4] = {0.f, 1.f, 0.5f, 2.f};
+
+    math::ray rays[8];
+
+    for(uint32_t i = 0; i < 4; ++i)
+    {
+      rays[i]     = math::ray_init(math::vec3_init(-1.f, face_y[i], 0.5f), math::vec3_init(2.f, face_y[i], 0.5f));
+      rays[i + 4] = math::ray_inverse(rays[i]);
+    }
+
+    uint32_t prepared_mask = 0;
+
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+      prepared_mask |= (math::ray_prepared_test_aabb(math::ray_prepared_init(rays[i]), box) ? 1u : 0u) << i;
+    }
+
+    bench::check(prepared_mask == 0x77, "prepared rays in a face plane hit the box");
+    bench::check(math::ray_packet8_test_aabb(math::ray_packet8_init(rays, 8), box) == prepared_mask, "packet8 agrees with prepared rays in a face plane");
+    bench::check(math::ray_packet4_test_aabb(math::ray_packet4_init(rays, 4), box) == (prepared_mask & 0xF), "packet4 agrees with prepared rays in a face plane");
+  }
+
+  const size_t count = 100000;
+  uint32_t seed = 1;
+
+  std::vector<math::aabb> boxes(count);
+
+  for(math::aabb &box : boxes)
+  {
+    const math::vec3 center = math::vec3_init(bench::random_float(seed, -10.f, 10.f), bench::random_float(seed, -10.f, 10.f), bench::random_float(seed, -10.f, 10.f));
+    const math::vec3 extent = math::vec3_init(0.5f, 0.5f, 0.5f);
+
+    box = math::aabb_init(math::vec3_subtract(center, extent), math::vec3_add(center, extent));
+  }
+
+  const math::ray pick_ray = math::ray_init(math::vec3_init(-20.f, -1.f, -2.f), math::vec3_init(20.f, 2.f, 1.f));
+  const math::ray_prepared prepared = math::ray_prepared_init(pick_ray);
+
+  // Boxes wholly in front of the start, where ray_test_aabb's 0 for a miss can't clash with a hit.
+  size_t single_hits = 0;
+  size_t prepared_hits = 0;
+
+  for(const math::aabb &box : boxes)
+  {
+    single_hits   += math::ray_test_aabb(pick_ray, box) != 0.f ? 1 : 0;
+    prepared_hits += math::ray_prepared_test_aabb(prepared, box) ? 1 : 0;
+  }
+
+  bench::check(single_hits == prepared_hits, "prepared ray hits the same boxes as ray_test_aabb");
+
+  std::vector<uint32_t> hit_mask((count + 31) / 32);
+  std::vector<uint32_t> hit_index(count);
+
+  const double single_ms = bench::time_ms([&]{
+    size_t hits = 0;
+    for(const math::aabb &box : boxes) { hits += math::ray_test_aabb(pick_ray, box) != 0.f ? 1 : 0; }
+    bench::keep((float)hits);
+  });
+
+  const double prepared_ms = bench::time_ms([&]{
+    const math::ray_prepared ray = math::ray_prepared_init(pick_ray);
+    bench::keep((float)math::ray_prepared_test_aabbs(ray, boxes.data(), count, hit_mask.data(), hit_index.data()));
+  });
+
+  printf("ray against aabbs, %zu boxes, %zu hit\n", count, prepared_hits);
+  printf("  ray_test_aabb   %8.3f ms  %6.2f ns a box\n", single_ms, single_ms * 1e6 / count);
+  printf("  prepared        %8.3f ms  %6.2f ns a box  (%.2fx)\n", prepared_ms, prepared_ms * 1e6 / count, single_ms / prepared_ms);
+
+  return bench::failure_count() ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+/*
+  transform_hierarchy_update on one thread, then with a thread_pool of
+  2 up to every hardware thread, doubling. The pooled updates are checked to be
+  bit identical to the single threaded one first.
+*/
+
+
+#include "bench.hpp"
+#include <math/math.hpp>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+
+bool
+same_world_matrices(const math::transform_hierarchy &a, const math::transform_hierarchy &b)
+{
+  for(uint32_t i = 0; i < (uint32_t)math::transform_hierarchy_size(a); ++i)
+  {
+    if(memcmp(math::mat4_get_data(math::transform_hierarchy_get_world_matrix(a, i)), math::mat4_get_data(math::transform_hierarchy_get_world_matrix(b, i)), sizeof(float) * 16) != 0)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+} // ns
+
+
+int
+main(int argc, char **argv)
+{
+  const uint32_t node_count = 200000;
+  uint32_t seed = 1;
+
+  // Four children a node, so the depth levels are wide enough to split.
+  math::transform_hierarchy scene;
+  math::transform_hierarchy_reserve(scene, node_count);
+
+  for(uint32_t i = 0; i < node_count; ++i)
+  {
+    const math::vec3 position = math::vec3_init(bench::random_float(seed, -1.f, 1.f), bench::random_float(seed, -1.f, 1.f), bench::random_float(seed, -1.f, 1.f));
+    const math::vec3 axis     = math::vec3_normalize(math::vec3_init(bench::random_float(seed, -1.f, 1.f), 1.f, bench::random_float(seed, -1.f, 1.f)));
+    const math::quat rotation = math::quat_init_with_axis_angle(axis, bench::random_float(seed, -0.5f, 0.5f));
+
+    const math::transform local = math::transform_init(position, math::vec3_one(), rotation);
+
+    math::transform_hierarchy_add(scene, local, i == 0 ? math::transform_hierarchy_no_parent() : (i - 1) / 4);
+  }
+
+  math::transform_hierarchy reference = scene;
+  math::transform_hierarchy_update(reference);
+
+  // At least two, so the pooled path is always checked. Pass a count to go past the hardware.
+  const uint32_t hardware_threads = std::thread::hardware_concurrency();
+  const uint32_t max_threads = argc > 1 ? (uint32_t)atoi(argv[1]) : (hardware_threads > 2 ? hardware_threads : 2);
+
+  const double single_ms = bench::time_ms([&]{
+    math::transform_hierarchy_set_all_dirty(scene);
+    math::transform_hierarchy_update(scene);
+  });
+
+  printf("transform hierarchy update, %u nodes, %u hardware threads\n", node_count, hardware_threads);
+  printf("  1 thread   %8.3f ms\n", single_ms);
+
+  for(uint32_t threads = 2; threads <= max_threads; threads = threads < max_threads && threads * 2 > max_threads ? max_threads : threads * 2)
+  {
+    math::thread_pool pool(threads - 1);
+
+    math::transform_hierarchy pooled = reference;
+    math::transform_hierarchy_set_all_dirty(pooled);
+    math::transform_hierarchy_update(pooled, pool);
+
+    bench::check(same_world_matrices(reference, pooled), "pooled update matches the single threaded one");
+
+    const double pool_ms = bench::time_ms([&]{
+      math::transform_hierarchy_set_all_dirty(pooled);
+      math::transform_hierarchy_update(pooled, pool);
+    });
+
+    printf("  %u threads  %8.3f ms  (%.2fx)\n", threads, pool_ms, single_ms / pool_ms);
+  }
+
+  return bench::failure_count() ? 1 : 0;
+}
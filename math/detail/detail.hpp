@@ -11,12 +11,67 @@
 
 // Intrinsics settings
 
+/*
+  MATH_USE_SIMD turns on SSE2. Wider paths are picked up when the
+  compiler targets them (-msse4.1, -mavx2 -mfma, -mavx512f), and can
+  be capped with MATH_NO_SSE41, MATH_NO_AVX or MATH_NO_AVX512.
+  The public types are the same size and layout at every level, the
+  static_asserts beside each type check it.
+*/
+
 #ifdef MATH_USE_SIMD
 #define MATH_ON_SIMD 1
 #define MATH_ON_SSE2 1
+#define MATH_SIMD_LEVEL 1
 #include <emmintrin.h>
+
+#ifdef __SSE3__
+#define MATH_ON_SSE3 1
+#include <pmmintrin.h>
+#endif
+
+#if defined(__SSE4_1__) && !defined(MATH_NO_SSE41)
+#define MATH_ON_SSE41 1
+#undef MATH_SIMD_LEVEL
+#define MATH_SIMD_LEVEL 2
+#include <smmintrin.h>
+#endif
+
+#if defined(__AVX__) && !defined(MATH_NO_AVX)
+#define MATH_ON_AVX 1
+#include <immintrin.h>
+
+#ifdef __FMA__
+#define MATH_ON_FMA 1
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+#define MATH_ON_AVX2 1
+#undef MATH_SIMD_LEVEL
+#define MATH_SIMD_LEVEL 3
+#endif
+
+#if defined(__AVX512F__) && !defined(MATH_NO_AVX512)
+#define MATH_ON_AVX512 1
+#undef MATH_SIMD_LEVEL
+#define MATH_SIMD_LEVEL 4
+#endif
+#endif // avx
+
 #else
 #define MATH_ON_FPU 1
+#define MATH_SIMD_LEVEL 0
+#endif
+
+
+/*
+  Runtime dispatch builds kernels for wider sets with target
+  attributes, so it needs GCC or Clang on x86 with SSE2 as the base.
+*/
+
+#if defined(MATH_ON_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(MATH_NO_DISPATCH)
+#define MATH_ON_DISPATCH 1
+#define MATH_TARGET(isa) __attribute__((target(isa)))
 #endif
 
 
@@ -61,8 +116,11 @@
 #define MATH_VEC2_INLINE MATH_INLINE
 #define MATH_VEC3_INLINE MATH_INLINE
 #define MATH_VEC4_INLINE MATH_INLINE
+#define MATH_VEC3X4_INLINE MATH_INLINE
+#define MATH_VEC3X8_INLINE MATH_INLINE
 #define MATH_MAT3_INLINE MATH_INLINE
 #define MATH_MAT4_INLINE MATH_INLINE
+#define MATH_MAT34_INLINE MATH_INLINE
 #define MATH_QUAT_INLINE MATH_INLINE
 #define MATH_AABB_INLINE MATH_INLINE
 #define MATH_GENR_INLINE MATH_INLINE
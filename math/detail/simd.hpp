@@ -0,0 +1,208 @@
+#ifndef SIMD_INCLUDED_5D192FE7_E622_482F_A3A0_70231882B574
+#define SIMD_INCLUDED_5D192FE7_E622_482F_A3A0_70231882B574
+
+
+/*
+  SIMD Helpers
+  Small building blocks shared by the sse / avx impls, these pick
+  the fused instruction when the target has it.
+*/
+
+
+#include "detail.hpp"
+
+
+#ifdef MATH_ON_SSE2
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  // (a * b) + c
+  inline __m128
+  sse_multiply_add(const __m128 a, const __m128 b, const __m128 c)
+  {
+    #ifdef MATH_ON_FMA
+    return _mm_fmadd_ps(a, b, c);
+    #else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+    #endif
+  }
+
+
+  // (a * b) - c
+  inline __m128
+  sse_multiply_sub(const __m128 a, const __m128 b, const __m128 c)
+  {
+    #ifdef MATH_ON_FMA
+    return _mm_fmsub_ps(a, b, c);
+    #else
+    return _mm_sub_ps(_mm_mul_ps(a, b), c);
+    #endif
+  }
+
+
+  // Copies b's last lane into a.
+  inline __m128
+  sse_blend_w(const __m128 a, const __m128 b)
+  {
+    #ifdef MATH_ON_SSE41
+    return _mm_blend_ps(a, b, 0x8);
+    #else
+    const __m128 b_z_w = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,3,2,2));
+    return _mm_shuffle_ps(a, b_z_w, _MM_SHUFFLE(2,0,1,0));
+    #endif
+  }
+
+
+  // Per lane mask ? if_true : if_false, mask lanes are all or no bits.
+  inline __m128
+  sse_select(const __m128 mask, const __m128 if_true, const __m128 if_false)
+  {
+    #ifdef MATH_ON_SSE41
+    return _mm_blendv_ps(if_false, if_true, mask);
+    #else
+    return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+    #endif
+  }
+
+
+  // Per lane sign bit of sign set ? if_set : if_clear, for choosing by a direction's sign.
+  inline __m128
+  sse_select_by_sign(const __m128 sign, const __m128 if_set, const __m128 if_clear)
+  {
+    #ifdef MATH_ON_SSE41
+    return _mm_blendv_ps(if_clear, if_set, sign);
+    #else
+    const __m128 mask = _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(sign), 31));
+    return sse_select(mask, if_set, if_clear);
+    #endif
+  }
+
+
+  // Sum of all four lanes, in lane 0.
+  inline __m128
+  sse_horizontal_add(const __m128 vec)
+  {
+    #ifdef MATH_ON_SSE3
+    const __m128 odd = _mm_movehdup_ps(vec);
+    #else
+    const __m128 odd = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(3,3,1,1));
+    #endif
+
+    const __m128 pairs = _mm_add_ps(vec, odd);
+
+    return _mm_add_ss(pairs, _mm_movehl_ps(odd, pairs));
+  }
+
+
+  /*
+    Dot products, result in lane 0. Lanes past the vector's size are
+    dropped before the sum so stale data there never gets in.
+  */
+
+  inline __m128
+  sse_dot2(const __m128 a, const __m128 b)
+  {
+    #ifdef MATH_ON_SSE41
+    return _mm_dp_ps(a, b, 0x31);
+    #else
+    const __m128 mul = _mm_mul_ps(a, b);
+    return _mm_add_ss(mul, _mm_shuffle_ps(mul, mul, _MM_SHUFFLE(1,1,1,1)));
+    #endif
+  }
+
+
+  inline __m128
+  sse_dot3(const __m128 a, const __m128 b)
+  {
+    #ifdef MATH_ON_SSE41
+    return _mm_dp_ps(a, b, 0x71);
+    #else
+    const __m128 xyz_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    return sse_horizontal_add(_mm_and_ps(_mm_mul_ps(a, b), xyz_mask));
+    #endif
+  }
+
+
+  inline __m128
+  sse_dot4(const __m128 a, const __m128 b)
+  {
+    #ifdef MATH_ON_SSE41
+    return _mm_dp_ps(a, b, 0xF1);
+    #else
+    return sse_horizontal_add(_mm_mul_ps(a, b));
+    #endif
+  }
+
+
+  // Cross product of the xyz lanes, a * b.yzx - a.yzx * b then back to xyz.
+  inline __m128
+  sse_cross(const __m128 a, const __m128 b)
+  {
+    const __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3,0,2,1));
+    const __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3,0,2,1));
+    const __m128 c     = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+
+    return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3,0,2,1));
+  }
+
+
+  // 1 / sqrt(a), the estimate plus one newton step (~22 bits).
+  inline __m128
+  sse_rsqrt(const __m128 a)
+  {
+    const __m128 half        = _mm_set1_ps(0.5f);
+    const __m128 three_halfs = _mm_set1_ps(1.5f);
+    const __m128 estimate    = _mm_rsqrt_ps(a);
+    const __m128 half_a_est  = _mm_mul_ps(_mm_mul_ps(half, a), estimate);
+
+    return _mm_mul_ps(estimate, _mm_sub_ps(three_halfs, _mm_mul_ps(half_a_est, estimate)));
+  }
+
+
+  #ifdef MATH_ON_AVX
+
+  // (a * b) + c
+  inline __m256
+  avx_multiply_add(const __m256 a, const __m256 b, const __m256 c)
+  {
+    #ifdef MATH_ON_FMA
+    return _mm256_fmadd_ps(a, b, c);
+    #else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+    #endif
+  }
+
+
+  // (a * b) - c
+  inline __m256
+  avx_multiply_sub(const __m256 a, const __m256 b, const __m256 c)
+  {
+    #ifdef MATH_ON_FMA
+    return _mm256_fmsub_ps(a, b, c);
+    #else
+    return _mm256_sub_ps(_mm256_mul_ps(a, b), c);
+    #endif
+  }
+
+
+
+  // Per lane sign bit of sign set ? if_set : if_clear.
+  inline __m256
+  avx_select_by_sign(const __m256 sign, const __m256 if_set, const __m256 if_clear)
+  {
+    return _mm256_blendv_ps(if_clear, if_set, sign);
+  }
+
+  #endif // avx
+} // ns
+
+
+_MATH_NS_CLOSE
+
+
+#endif // use sse
+#endif // inc guard
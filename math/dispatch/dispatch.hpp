@@ -0,0 +1,367 @@
+#ifndef DISPATCH_INCLUDED_9B0AF009_F955_47A2_9B7F_A94780325A6A
+#define DISPATCH_INCLUDED_9B0AF009_F955_47A2_9B7F_A94780325A6A
+
+
+/*
+  Dispatch
+  Runtime picked versions of the loop heavy functions, for one
+  binary that runs on mixed cpus. The cpu is checked once, on first
+  use, and a table of kernels for the best supported set is kept.
+  The inline functions elsewhere are unchanged and don't go through here.
+
+  Without MATH_ON_DISPATCH (FPU builds, other compilers or arches)
+  these call the inline functions and the backend is the build's.
+*/
+
+
+#include "../detail/detail.hpp"
+#include "../vec/vec3.hpp"
+#include "../mat/mat4.hpp"
+#include "../geometry/geometry_types.hpp"
+#include "../geometry/aabb.hpp"
+#include "../geometry/ray.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef MATH_ON_DISPATCH
+#include <immintrin.h>
+#endif
+
+
+_MATH_NS_OPEN
+
+
+namespace dispatch {
+
+
+// ----------------------------------------------------------- [ Interface ] --
+
+
+enum class isa : uint32_t
+{
+  fpu,
+  sse2,
+  avx2,   // With fma.
+  avx512,
+};
+
+
+// Backend in use, for logging.
+inline isa          backend();
+inline const char*  backend_name();
+
+// Same results as the inline versions, to float rounding.
+inline aabb         aabb_init_from_xyz_data(const float vertex[], const size_t number_of_floats);
+inline bool         ray_test_triangles(const ray &in_ray, const float tris[], const size_t tri_count, float *out_distance = nullptr);
+inline bool         ray_test_closest_edge(const float tris[], const size_t tri_count, const vec3 point, vec3 &seg_a, vec3 &seg_b);
+inline mat4         mat4_multiply(const mat4 &lhs, const mat4 &rhs);
+
+
+} // ns dispatch
+
+
+namespace detail
+{
+  // ------------------------------------------------------ [ Kernel Table ] --
+
+
+  struct dispatch_table
+  {
+    dispatch::isa backend;
+
+    aabb (*aabb_init_from_xyz_data)(const float vertex[], const size_t number_of_floats);
+    bool (*ray_test_triangles)(const ray &in_ray, const float tris[], const size_t tri_count, float *out_distance);
+    bool (*ray_test_closest_edge)(const float tris[], const size_t tri_count, const vec3 point, vec3 &seg_a, vec3 &seg_b);
+    mat4 (*mat4_multiply)(const mat4 &lhs, const mat4 &rhs);
+  };
+
+
+  // ---------------------------------------------------- [ Shared Scalar ] --
+
+
+  /*
+    Wide kernels keep three registers of running min / max over packed
+    xyz, float k of those registers is always axis k % 3. This folds
+    them into the box.
+  */
+  inline void
+  dispatch_fold_xyz_lanes(const float lanes_min[], const float lanes_max[], const size_t lane_floats, float box_min[3], float box_max[3])
+  {
+    for(size_t i = 0; i < lane_floats; ++i)
+    {
+      box_min[i % 3] = MATH_NS_NAME::min(lanes_min[i], box_min[i % 3]);
+      box_max[i % 3] = MATH_NS_NAME::max(lanes_max[i], box_max[i % 3]);
+    }
+  }
+
+
+  inline void
+  dispatch_xyz_tail(const float vertex[], const size_t start, const size_t count, float box_min[3], float box_max[3])
+  {
+    for(size_t i = start; i < count; ++i)
+    {
+      for(uint32_t axis = 0; axis < 3; ++axis)
+      {
+        box_min[axis] = MATH_NS_NAME::min(vertex[i * 3 + axis], box_min[axis]);
+        box_max[axis] = MATH_NS_NAME::max(vertex[i * 3 + axis], box_max[axis]);
+      }
+    }
+  }
+
+
+  inline aabb
+  dispatch_aabb_from_min_max(const float box_min[3], const float box_max[3])
+  {
+    return aabb_init(
+      vec3_init(box_min[0], box_min[1], box_min[2]),
+      vec3_init(box_max[0], box_max[1], box_max[2])
+    );
+  }
+
+
+  // Distance from point to edge (edge, edge + 1) of a triangle, as ray_test_closest_edge.
+  inline float
+  dispatch_edge_distance(const float tris[], const size_t tri, const uint32_t edge, const vec3 point)
+  {
+    const vec3 va = vec3_init_with_array(&tris[(tri * 9) + (edge * 3)]);
+    const vec3 vb = vec3_init_with_array(&tris[(tri * 9) + (((edge + 1) % 3) * 3)]);
+
+    const vec3 v = vec3_subtract(vb, va);
+    const vec3 w = vec3_subtract(point, va);
+
+    const float c1 = vec3_dot(w, v);
+
+    if(c1 <= 0)
+    {
+      return vec3_length(vec3_subtract(point, va));
+    }
+
+    const float c2 = vec3_dot(v, v);
+
+    if(c2 <= c1)
+    {
+      return vec3_length(vec3_subtract(point, vb));
+    }
+
+    const vec3 p = vec3_add(va, vec3_scale(v, c1 / c2));
+
+    return vec3_length(vec3_subtract(point, p));
+  }
+
+
+  struct dispatch_closest_edge
+  {
+    float  distance;
+    size_t tri;
+    uint32_t edge;
+  };
+
+
+  inline void
+  dispatch_closest_edge_scan(const float tris[], const size_t start, const size_t tri_count, const vec3 point, dispatch_closest_edge &closest)
+  {
+    for(size_t i = start; i < tri_count; ++i)
+    {
+      for(uint32_t j = 0; j < 3; ++j)
+      {
+        const float dist = dispatch_edge_distance(tris, i, j, point);
+
+        if(dist < closest.distance)
+        {
+          closest.distance = dist;
+          closest.tri      = i;
+          closest.edge     = j;
+        }
+      }
+    }
+  }
+
+
+  /*
+    Wide kernels store edge j of lane n at dists[j * width + n], this
+    walks them in triangle order so ties go to the first edge, as the
+    scalar loop does.
+  */
+  inline void
+  dispatch_closest_edge_pick(const float dists[], const size_t width, const size_t first_tri, dispatch_closest_edge &closest)
+  {
+    for(size_t lane = 0; lane < width; ++lane)
+    {
+      for(uint32_t j = 0; j < 3; ++j)
+      {
+        const float dist = dists[(j * width) + lane];
+
+        if(dist < closest.distance)
+        {
+          closest.distance = dist;
+          closest.tri      = first_tri + lane;
+          closest.edge     = j;
+        }
+      }
+    }
+  }
+
+
+  inline bool
+  dispatch_closest_edge_result(const float tris[], const dispatch_closest_edge &closest, const float max_dist, vec3 &seg_a, vec3 &seg_b)
+  {
+    if(closest.distance < max_dist)
+    {
+      seg_a = vec3_init_with_array(&tris[(closest.tri * 9) + (closest.edge * 3)]);
+      seg_b = vec3_init_with_array(&tris[(closest.tri * 9) + (((closest.edge + 1) % 3) * 3)]);
+
+      return true;
+    }
+
+    return false;
+  }
+
+
+  MATH_CONSTEXPR float dispatch_closest_edge_max_dist() { return 10000000000.0f; }
+} // ns
+
+
+_MATH_NS_CLOSE
+
+
+/*
+  Kernels for each set.
+*/
+
+
+#ifdef MATH_ON_DISPATCH
+
+#include "dispatch_sse2.inl"
+#include "dispatch_avx2.inl"
+#include "dispatch_avx512.inl"
+
+#endif
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  inline dispatch_table
+  dispatch_select_table()
+  {
+    #ifdef MATH_ON_DISPATCH
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx512f"))
+    {
+      return dispatch_table{
+        dispatch::isa::avx512,
+        aabb_init_from_xyz_data_avx512,
+        ray_test_triangles_avx512,
+        ray_test_closest_edge_avx512,
+        mat4_multiply_avx512,
+      };
+    }
+
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+      return dispatch_table{
+        dispatch::isa::avx2,
+        aabb_init_from_xyz_data_avx2,
+        ray_test_triangles_avx2,
+        ray_test_closest_edge_avx2,
+        mat4_multiply_avx2,
+      };
+    }
+
+    return dispatch_table{
+      dispatch::isa::sse2,
+      aabb_init_from_xyz_data_sse2,
+      ray_test_triangles_sse2,
+      ray_test_closest_edge_sse2,
+      MATH_NS_NAME::mat4_multiply,
+    };
+    #else
+    return dispatch_table{
+      #ifdef MATH_ON_SSE2
+      dispatch::isa::sse2,
+      #else
+      dispatch::isa::fpu,
+      #endif
+      MATH_NS_NAME::aabb_init_from_xyz_data,
+      MATH_NS_NAME::ray_test_triangles,
+      MATH_NS_NAME::ray_test_closest_edge,
+      MATH_NS_NAME::mat4_multiply,
+    };
+    #endif
+  }
+
+
+  // Picked once, C++11 makes the first call thread safe.
+  inline const dispatch_table&
+  dispatch_get_table()
+  {
+    static const dispatch_table table = dispatch_select_table();
+    return table;
+  }
+} // ns
+
+
+namespace dispatch {
+
+
+// ---------------------------------------------------------------- [ Impl ] --
+
+
+isa
+backend()
+{
+  return detail::dispatch_get_table().backend;
+}
+
+
+const char*
+backend_name()
+{
+  switch(backend())
+  {
+    case(isa::avx512): return "avx512";
+    case(isa::avx2):   return "avx2";
+    case(isa::sse2):   return "sse2";
+    default:           return "fpu";
+  }
+}
+
+
+aabb
+aabb_init_from_xyz_data(const float vertex[], const size_t number_of_floats)
+{
+  return detail::dispatch_get_table().aabb_init_from_xyz_data(vertex, number_of_floats);
+}
+
+
+bool
+ray_test_triangles(const ray &in_ray, const float tris[], const size_t tri_count, float *out_distance)
+{
+  return detail::dispatch_get_table().ray_test_triangles(in_ray, tris, tri_count, out_distance);
+}
+
+
+bool
+ray_test_closest_edge(const float tris[], const size_t tri_count, const vec3 point, vec3 &seg_a, vec3 &seg_b)
+{
+  return detail::dispatch_get_table().ray_test_closest_edge(tris, tri_count, point, seg_a, seg_b);
+}
+
+
+mat4
+mat4_multiply(const mat4 &lhs, const mat4 &rhs)
+{
+  return detail::dispatch_get_table().mat4_multiply(lhs, rhs);
+}
+
+
+} // ns dispatch
+
+
+_MATH_NS_CLOSE
+
+
+#endif // inc guard
@@ -0,0 +1,321 @@
+#ifndef DISPATCH_AVX2_INCLUDED_72305C68_F5BA_4A63_AC59_CFA7E2777738
+#define DISPATCH_AVX2_INCLUDED_72305C68_F5BA_4A63_AC59_CFA7E2777738
+
+
+#include "../detail/detail.hpp"
+#include "dispatch.hpp"
+
+
+#ifdef MATH_ON_DISPATCH
+
+
+/*
+  Dispatch
+  AVX2 + FMA kernels, eight points or triangles a pass.
+  Triangle components are gathered.
+*/
+
+
+#define MATH_TARGET_AVX2 MATH_TARGET("avx2,fma")
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  MATH_TARGET_AVX2 inline __m256
+  dispatch_avx2_dot(const __m256 ax, const __m256 ay, const __m256 az, const __m256 bx, const __m256 by, const __m256 bz)
+  {
+    return _mm256_fmadd_ps(az, bz, _mm256_fmadd_ps(ay, by, _mm256_mul_ps(ax, bx)));
+  }
+
+
+  // (a * b) - (c * d)
+  MATH_TARGET_AVX2 inline __m256
+  dispatch_avx2_mul_sub(const __m256 a, const __m256 b, const __m256 c, const __m256 d)
+  {
+    return _mm256_fmsub_ps(a, b, _mm256_mul_ps(c, d));
+  }
+
+
+  // Lane n is float n * 9 + offset, one component of eight triangles.
+  MATH_TARGET_AVX2 inline __m256
+  dispatch_avx2_tri_component(const float tris[], const size_t offset)
+  {
+    const __m256i stride = _mm256_setr_epi32(0, 9, 18, 27, 36, 45, 54, 63);
+    return _mm256_i32gather_ps(&tris[offset], stride, 4);
+  }
+
+
+  MATH_TARGET_AVX2 inline aabb
+  aabb_init_from_xyz_data_avx2(const float vertex[], const size_t number_of_floats)
+  {
+    assert((number_of_floats % 3) == 0);
+    if((number_of_floats % 3) != 0 || number_of_floats < 24)
+    {
+      return aabb_init_from_xyz_data_sse2(vertex, number_of_floats);
+    }
+
+    const size_t count = number_of_floats / 3;
+
+    // 24 floats is 8 points, so each register keeps the same axis pattern.
+    __m256 min_0 = _mm256_loadu_ps(&vertex[0]);
+    __m256 min_1 = _mm256_loadu_ps(&vertex[8]);
+    __m256 min_2 = _mm256_loadu_ps(&vertex[16]);
+
+    __m256 max_0 = min_0;
+    __m256 max_1 = min_1;
+    __m256 max_2 = min_2;
+
+    size_t i = 8;
+
+    for(; i + 8 <= count; i += 8)
+    {
+      const float *points = &vertex[i * 3];
+
+      const __m256 points_0 = _mm256_loadu_ps(&points[0]);
+      const __m256 points_1 = _mm256_loadu_ps(&points[8]);
+      const __m256 points_2 = _mm256_loadu_ps(&points[16]);
+
+      min_0 = _mm256_min_ps(min_0, points_0);
+      min_1 = _mm256_min_ps(min_1, points_1);
+      min_2 = _mm256_min_ps(min_2, points_2);
+
+      max_0 = _mm256_max_ps(max_0, points_0);
+      max_1 = _mm256_max_ps(max_1, points_1);
+      max_2 = _mm256_max_ps(max_2, points_2);
+    }
+
+    float lanes_min[24];
+    float lanes_max[24];
+
+    _mm256_storeu_ps(&lanes_min[0],  min_0);
+    _mm256_storeu_ps(&lanes_min[8],  min_1);
+    _mm256_storeu_ps(&lanes_min[16], min_2);
+
+    _mm256_storeu_ps(&lanes_max[0],  max_0);
+    _mm256_storeu_ps(&lanes_max[8],  max_1);
+    _mm256_storeu_ps(&lanes_max[16], max_2);
+
+    float box_min[3] = {vertex[0], vertex[1], vertex[2]};
+    float box_max[3] = {vertex[0], vertex[1], vertex[2]};
+
+    dispatch_fold_xyz_lanes(lanes_min, lanes_max, 24, box_min, box_max);
+    dispatch_xyz_tail(vertex, i, count, box_min, box_max);
+
+    return dispatch_aabb_from_min_max(box_min, box_max);
+  }
+
+
+  MATH_TARGET_AVX2 inline bool
+  ray_test_triangles_avx2(const ray &in_ray, const float tris[], const size_t tri_count, float *out_distance)
+  {
+    const vec3 r_dir = MATH_NS_NAME::ray_direction(in_ray);
+
+    const __m256 dir_x = _mm256_set1_ps(vec3_get_x(r_dir));
+    const __m256 dir_y = _mm256_set1_ps(vec3_get_y(r_dir));
+    const __m256 dir_z = _mm256_set1_ps(vec3_get_z(r_dir));
+
+    const __m256 start_x = _mm256_set1_ps(vec3_get_x(in_ray.start));
+    const __m256 start_y = _mm256_set1_ps(vec3_get_y(in_ray.start));
+    const __m256 start_z = _mm256_set1_ps(vec3_get_z(in_ray.start));
+
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one  = _mm256_set1_ps(1.f);
+    const __m256 eps  = _mm256_set1_ps(MATH_NS_NAME::epsilon());
+
+    size_t i = 0;
+
+    for(; i + 8 <= tri_count; i += 8)
+    {
+      const float *tri = &tris[i * 9];
+
+      const __m256 v0_x = dispatch_avx2_tri_component(tri, 0);
+      const __m256 v0_y = dispatch_avx2_tri_component(tri, 1);
+      const __m256 v0_z = dispatch_avx2_tri_component(tri, 2);
+
+      const __m256 e1_x = _mm256_sub_ps(dispatch_avx2_tri_component(tri, 3), v0_x);
+      const __m256 e1_y = _mm256_sub_ps(dispatch_avx2_tri_component(tri, 4), v0_y);
+      const __m256 e1_z = _mm256_sub_ps(dispatch_avx2_tri_component(tri, 5), v0_z);
+
+      const __m256 e2_x = _mm256_sub_ps(dispatch_avx2_tri_component(tri, 6), v0_x);
+      const __m256 e2_y = _mm256_sub_ps(dispatch_avx2_tri_component(tri, 7), v0_y);
+      const __m256 e2_z = _mm256_sub_ps(dispatch_avx2_tri_component(tri, 8), v0_z);
+
+      // p = dir x e2
+      const __m256 p_x = dispatch_avx2_mul_sub(dir_y, e2_z, dir_z, e2_y);
+      const __m256 p_y = dispatch_avx2_mul_sub(dir_z, e2_x, dir_x, e2_z);
+      const __m256 p_z = dispatch_avx2_mul_sub(dir_x, e2_y, dir_y, e2_x);
+
+      const __m256 dot = dispatch_avx2_dot(e1_x, e1_y, e1_z, p_x, p_y, p_z);
+
+      __m256 hit = _mm256_cmp_ps(dot, eps, _CMP_NLT_UQ);
+
+      if(!_mm256_movemask_ps(hit))
+      {
+        continue;
+      }
+
+      const __m256 o_dot = _mm256_div_ps(one, dot);
+
+      const __m256 t_x = _mm256_sub_ps(start_x, v0_x);
+      const __m256 t_y = _mm256_sub_ps(start_y, v0_y);
+      const __m256 t_z = _mm256_sub_ps(start_z, v0_z);
+
+      const __m256 u = _mm256_mul_ps(dispatch_avx2_dot(t_x, t_y, t_z, p_x, p_y, p_z), o_dot);
+
+      hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GT_OQ), _mm256_cmp_ps(u, one, _CMP_LT_OQ)));
+
+      // q = t x e1
+      const __m256 q_x = dispatch_avx2_mul_sub(t_y, e1_z, t_z, e1_y);
+      const __m256 q_y = dispatch_avx2_mul_sub(t_z, e1_x, t_x, e1_z);
+      const __m256 q_z = dispatch_avx2_mul_sub(t_x, e1_y, t_y, e1_x);
+
+      const __m256 v = _mm256_mul_ps(dispatch_avx2_dot(dir_x, dir_y, dir_z, q_x, q_y, q_z), o_dot);
+
+      hit = _mm256_and_ps(hit, _mm256_and_ps(
+        _mm256_cmp_ps(v, zero, _CMP_NLT_UQ),
+        _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_NGT_UQ)
+      ));
+
+      const int hit_mask = _mm256_movemask_ps(hit);
+
+      if(hit_mask)
+      {
+        const uint32_t lane = (uint32_t)__builtin_ctz((uint32_t)hit_mask);
+
+        if(out_distance)
+        {
+          float distances[8];
+          _mm256_storeu_ps(distances, _mm256_mul_ps(dispatch_avx2_dot(e2_x, e2_y, e2_z, q_x, q_y, q_z), o_dot));
+
+          *out_distance = distances[lane];
+        }
+
+        return true;
+      }
+    }
+
+    return ray_test_triangles_sse2(in_ray, &tris[i * 9], tri_count - i, out_distance);
+  }
+
+
+  MATH_TARGET_AVX2 inline bool
+  ray_test_closest_edge_avx2(const float tris[], const size_t tri_count, const vec3 point, vec3 &seg_a, vec3 &seg_b)
+  {
+    dispatch_closest_edge closest{dispatch_closest_edge_max_dist(), 0, 0};
+
+    const __m256 point_x = _mm256_set1_ps(vec3_get_x(point));
+    const __m256 point_y = _mm256_set1_ps(vec3_get_y(point));
+    const __m256 point_z = _mm256_set1_ps(vec3_get_z(point));
+
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t i = 0;
+
+    for(; i + 8 <= tri_count; i += 8)
+    {
+      const float *tri = &tris[i * 9];
+
+      float dists[24];
+      const __m256 closest_in_pass = _mm256_set1_ps(closest.distance);
+      int any_closer = 0;
+
+      for(uint32_t j = 0; j < 3; ++j)
+      {
+        const uint32_t a = j * 3;
+        const uint32_t b = ((j + 1) % 3) * 3;
+
+        const __m256 va_x = dispatch_avx2_tri_component(tri, a + 0);
+        const __m256 va_y = dispatch_avx2_tri_component(tri, a + 1);
+        const __m256 va_z = dispatch_avx2_tri_component(tri, a + 2);
+
+        const __m256 vb_x = dispatch_avx2_tri_component(tri, b + 0);
+        const __m256 vb_y = dispatch_avx2_tri_component(tri, b + 1);
+        const __m256 vb_z = dispatch_avx2_tri_component(tri, b + 2);
+
+        const __m256 v_x = _mm256_sub_ps(vb_x, va_x);
+        const __m256 v_y = _mm256_sub_ps(vb_y, va_y);
+        const __m256 v_z = _mm256_sub_ps(vb_z, va_z);
+
+        const __m256 w_x = _mm256_sub_ps(point_x, va_x);
+        const __m256 w_y = _mm256_sub_ps(point_y, va_y);
+        const __m256 w_z = _mm256_sub_ps(point_z, va_z);
+
+        const __m256 c1 = dispatch_avx2_dot(w_x, w_y, w_z, v_x, v_y, v_z);
+        const __m256 c2 = dispatch_avx2_dot(v_x, v_y, v_z, v_x, v_y, v_z);
+
+        // Before a, past b, or the projection between them.
+        const __m256 before_a = _mm256_cmp_ps(c1, zero, _CMP_LE_OQ);
+        const __m256 past_b   = _mm256_andnot_ps(before_a, _mm256_cmp_ps(c2, c1, _CMP_LE_OQ));
+        const __m256 clamped  = _mm256_or_ps(before_a, past_b);
+
+        const __m256 scale = _mm256_andnot_ps(clamped, _mm256_div_ps(c1, c2));
+
+        const __m256 near_x = _mm256_blendv_ps(_mm256_fmadd_ps(v_x, scale, va_x), vb_x, past_b);
+        const __m256 near_y = _mm256_blendv_ps(_mm256_fmadd_ps(v_y, scale, va_y), vb_y, past_b);
+        const __m256 near_z = _mm256_blendv_ps(_mm256_fmadd_ps(v_z, scale, va_z), vb_z, past_b);
+
+        const __m256 d_x = _mm256_sub_ps(point_x, near_x);
+        const __m256 d_y = _mm256_sub_ps(point_y, near_y);
+        const __m256 d_z = _mm256_sub_ps(point_z, near_z);
+
+        const __m256 dist = _mm256_sqrt_ps(dispatch_avx2_dot(d_x, d_y, d_z, d_x, d_y, d_z));
+
+        any_closer |= _mm256_movemask_ps(_mm256_cmp_ps(dist, closest_in_pass, _CMP_LT_OQ));
+        _mm256_storeu_ps(&dists[j * 8], dist);
+      }
+
+      if(any_closer)
+      {
+        dispatch_closest_edge_pick(dists, 8, i, closest);
+      }
+    }
+
+    dispatch_closest_edge_scan(tris, i, tri_count, point, closest);
+
+    return dispatch_closest_edge_result(tris, closest, dispatch_closest_edge_max_dist(), seg_a, seg_b);
+  }
+
+
+  MATH_TARGET_AVX2 inline mat4
+  mat4_multiply_avx2(const mat4 &lhs, const mat4 &rhs)
+  {
+    const internal_mat4 *left  = reinterpret_cast<const internal_mat4*>(&lhs);
+    const internal_mat4 *right = reinterpret_cast<const internal_mat4*>(&rhs);
+
+    mat4 return_mat;
+    internal_mat4 *internal_mat = reinterpret_cast<internal_mat4*>(&return_mat);
+
+    // Each rhs row in both halves, two lhs rows a register.
+    const __m256 right_0 = _mm256_broadcast_ps(&right->simd_vec[0]);
+    const __m256 right_1 = _mm256_broadcast_ps(&right->simd_vec[1]);
+    const __m256 right_2 = _mm256_broadcast_ps(&right->simd_vec[2]);
+    const __m256 right_3 = _mm256_broadcast_ps(&right->simd_vec[3]);
+
+    for(uint32_t row = 0; row < 16; row += 8)
+    {
+      const __m256 rows = _mm256_loadu_ps(&left->data[row]);
+
+      __m256 result = _mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(0,0,0,0)), right_0);
+      result = _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(1,1,1,1)), right_1, result);
+      result = _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(2,2,2,2)), right_2, result);
+      result = _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(3,3,3,3)), right_3, result);
+
+      _mm256_storeu_ps(&internal_mat->data[row], result);
+    }
+
+    return return_mat;
+  }
+} // ns
+
+
+_MATH_NS_CLOSE
+
+
+#undef MATH_TARGET_AVX2
+
+
+#endif // on dispatch
+#endif // inc guard
@@ -0,0 +1,318 @@
+#ifndef DISPATCH_AVX512_INCLUDED_FFA3D41E_97E0_423D_8A09_C7A20E51C9B8
+#define DISPATCH_AVX512_INCLUDED_FFA3D41E_97E0_423D_8A09_C7A20E51C9B8
+
+
+#include "../detail/detail.hpp"
+#include "dispatch.hpp"
+
+
+#ifdef MATH_ON_DISPATCH
+
+
+/*
+  Dispatch
+  AVX-512 kernels, sixteen points or triangles a pass.
+  Tests are kept in mask registers.
+
+  Intrinsics are the masked forms with every lane set, these are the
+  same instructions. GCC 12's plain forms pass an uninitialised
+  _mm512_undefined_ps() and warn under -Wall.
+*/
+
+
+#define MATH_TARGET_AVX512 MATH_TARGET("avx512f,avx2,fma")
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  MATH_TARGET_AVX512 inline __m512
+  dispatch_avx512_dot(const __m512 ax, const __m512 ay, const __m512 az, const __m512 bx, const __m512 by, const __m512 bz)
+  {
+    return _mm512_fmadd_ps(az, bz, _mm512_fmadd_ps(ay, by, _mm512_mul_ps(ax, bx)));
+  }
+
+
+  // (a * b) - (c * d)
+  MATH_TARGET_AVX512 inline __m512
+  dispatch_avx512_mul_sub(const __m512 a, const __m512 b, const __m512 c, const __m512 d)
+  {
+    return _mm512_fmsub_ps(a, b, _mm512_mul_ps(c, d));
+  }
+
+
+  // Lane n is float n * 9 + offset, one component of sixteen triangles.
+  MATH_TARGET_AVX512 inline __m512
+  dispatch_avx512_tri_component(const float tris[], const size_t offset)
+  {
+    const __m512i stride = _mm512_setr_epi32(0, 9, 18, 27, 36, 45, 54, 63, 72, 81, 90, 99, 108, 117, 126, 135);
+    return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, stride, &tris[offset], 4);
+  }
+
+
+  MATH_TARGET_AVX512 inline aabb
+  aabb_init_from_xyz_data_avx512(const float vertex[], const size_t number_of_floats)
+  {
+    assert((number_of_floats % 3) == 0);
+    if((number_of_floats % 3) != 0 || number_of_floats < 48)
+    {
+      return aabb_init_from_xyz_data_avx2(vertex, number_of_floats);
+    }
+
+    const size_t count = number_of_floats / 3;
+
+    // 48 floats is 16 points, so each register keeps the same axis pattern.
+    __m512 min_0 = _mm512_loadu_ps(&vertex[0]);
+    __m512 min_1 = _mm512_loadu_ps(&vertex[16]);
+    __m512 min_2 = _mm512_loadu_ps(&vertex[32]);
+
+    __m512 max_0 = min_0;
+    __m512 max_1 = min_1;
+    __m512 max_2 = min_2;
+
+    size_t i = 16;
+
+    for(; i + 16 <= count; i += 16)
+    {
+      const float *points = &vertex[i * 3];
+
+      const __m512 points_0 = _mm512_loadu_ps(&points[0]);
+      const __m512 points_1 = _mm512_loadu_ps(&points[16]);
+      const __m512 points_2 = _mm512_loadu_ps(&points[32]);
+
+      min_0 = _mm512_maskz_min_ps(0xFFFF, min_0, points_0);
+      min_1 = _mm512_maskz_min_ps(0xFFFF, min_1, points_1);
+      min_2 = _mm512_maskz_min_ps(0xFFFF, min_2, points_2);
+
+      max_0 = _mm512_maskz_max_ps(0xFFFF, max_0, points_0);
+      max_1 = _mm512_maskz_max_ps(0xFFFF, max_1, points_1);
+      max_2 = _mm512_maskz_max_ps(0xFFFF, max_2, points_2);
+    }
+
+    float lanes_min[48];
+    float lanes_max[48];
+
+    _mm512_storeu_ps(&lanes_min[0],  min_0);
+    _mm512_storeu_ps(&lanes_min[16], min_1);
+    _mm512_storeu_ps(&lanes_min[32], min_2);
+
+    _mm512_storeu_ps(&lanes_max[0],  max_0);
+    _mm512_storeu_ps(&lanes_max[16], max_1);
+    _mm512_storeu_ps(&lanes_max[32], max_2);
+
+    float box_min[3] = {vertex[0], vertex[1], vertex[2]};
+    float box_max[3] = {vertex[0], vertex[1], vertex[2]};
+
+    dispatch_fold_xyz_lanes(lanes_min, lanes_max, 48, box_min, box_max);
+    dispatch_xyz_tail(vertex, i, count, box_min, box_max);
+
+    return dispatch_aabb_from_min_max(box_min, box_max);
+  }
+
+
+  MATH_TARGET_AVX512 inline bool
+  ray_test_triangles_avx512(const ray &in_ray, const float tris[], const size_t tri_count, float *out_distance)
+  {
+    const vec3 r_dir = MATH_NS_NAME::ray_direction(in_ray);
+
+    const __m512 dir_x = _mm512_set1_ps(vec3_get_x(r_dir));
+    const __m512 dir_y = _mm512_set1_ps(vec3_get_y(r_dir));
+    const __m512 dir_z = _mm512_set1_ps(vec3_get_z(r_dir));
+
+    const __m512 start_x = _mm512_set1_ps(vec3_get_x(in_ray.start));
+    const __m512 start_y = _mm512_set1_ps(vec3_get_y(in_ray.start));
+    const __m512 start_z = _mm512_set1_ps(vec3_get_z(in_ray.start));
+
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one  = _mm512_set1_ps(1.f);
+    const __m512 eps  = _mm512_set1_ps(MATH_NS_NAME::epsilon());
+
+    size_t i = 0;
+
+    for(; i + 16 <= tri_count; i += 16)
+    {
+      const float *tri = &tris[i * 9];
+
+      const __m512 v0_x = dispatch_avx512_tri_component(tri, 0);
+      const __m512 v0_y = dispatch_avx512_tri_component(tri, 1);
+      const __m512 v0_z = dispatch_avx512_tri_component(tri, 2);
+
+      const __m512 e1_x = _mm512_sub_ps(dispatch_avx512_tri_component(tri, 3), v0_x);
+      const __m512 e1_y = _mm512_sub_ps(dispatch_avx512_tri_component(tri, 4), v0_y);
+      const __m512 e1_z = _mm512_sub_ps(dispatch_avx512_tri_component(tri, 5), v0_z);
+
+      const __m512 e2_x = _mm512_sub_ps(dispatch_avx512_tri_component(tri, 6), v0_x);
+      const __m512 e2_y = _mm512_sub_ps(dispatch_avx512_tri_component(tri, 7), v0_y);
+      const __m512 e2_z = _mm512_sub_ps(dispatch_avx512_tri_component(tri, 8), v0_z);
+
+      // p = dir x e2
+      const __m512 p_x = dispatch_avx512_mul_sub(dir_y, e2_z, dir_z, e2_y);
+      const __m512 p_y = dispatch_avx512_mul_sub(dir_z, e2_x, dir_x, e2_z);
+      const __m512 p_z = dispatch_avx512_mul_sub(dir_x, e2_y, dir_y, e2_x);
+
+      const __m512 dot = dispatch_avx512_dot(e1_x, e1_y, e1_z, p_x, p_y, p_z);
+
+      __mmask16 hit = _mm512_cmp_ps_mask(dot, eps, _CMP_NLT_UQ);
+
+      if(!hit)
+      {
+        continue;
+      }
+
+      const __m512 o_dot = _mm512_div_ps(one, dot);
+
+      const __m512 t_x = _mm512_sub_ps(start_x, v0_x);
+      const __m512 t_y = _mm512_sub_ps(start_y, v0_y);
+      const __m512 t_z = _mm512_sub_ps(start_z, v0_z);
+
+      const __m512 u = _mm512_mul_ps(dispatch_avx512_dot(t_x, t_y, t_z, p_x, p_y, p_z), o_dot);
+
+      hit = _mm512_mask_cmp_ps_mask(hit, u, zero, _CMP_GT_OQ);
+      hit = _mm512_mask_cmp_ps_mask(hit, u, one, _CMP_LT_OQ);
+
+      // q = t x e1
+      const __m512 q_x = dispatch_avx512_mul_sub(t_y, e1_z, t_z, e1_y);
+      const __m512 q_y = dispatch_avx512_mul_sub(t_z, e1_x, t_x, e1_z);
+      const __m512 q_z = dispatch_avx512_mul_sub(t_x, e1_y, t_y, e1_x);
+
+      const __m512 v = _mm512_mul_ps(dispatch_avx512_dot(dir_x, dir_y, dir_z, q_x, q_y, q_z), o_dot);
+
+      hit = _mm512_mask_cmp_ps_mask(hit, v, zero, _CMP_NLT_UQ);
+      hit = _mm512_mask_cmp_ps_mask(hit, _mm512_add_ps(u, v), one, _CMP_NGT_UQ);
+
+      if(hit)
+      {
+        const uint32_t lane = (uint32_t)__builtin_ctz((uint32_t)hit);
+
+        if(out_distance)
+        {
+          float distances[16];
+          _mm512_storeu_ps(distances, _mm512_mul_ps(dispatch_avx512_dot(e2_x, e2_y, e2_z, q_x, q_y, q_z), o_dot));
+
+          *out_distance = distances[lane];
+        }
+
+        return true;
+      }
+    }
+
+    return ray_test_triangles_avx2(in_ray, &tris[i * 9], tri_count - i, out_distance);
+  }
+
+
+  MATH_TARGET_AVX512 inline bool
+  ray_test_closest_edge_avx512(const float tris[], const size_t tri_count, const vec3 point, vec3 &seg_a, vec3 &seg_b)
+  {
+    dispatch_closest_edge closest{dispatch_closest_edge_max_dist(), 0, 0};
+
+    const __m512 point_x = _mm512_set1_ps(vec3_get_x(point));
+    const __m512 point_y = _mm512_set1_ps(vec3_get_y(point));
+    const __m512 point_z = _mm512_set1_ps(vec3_get_z(point));
+
+    const __m512 zero = _mm512_setzero_ps();
+
+    size_t i = 0;
+
+    for(; i + 16 <= tri_count; i += 16)
+    {
+      const float *tri = &tris[i * 9];
+
+      float dists[48];
+      const __m512 closest_in_pass = _mm512_set1_ps(closest.distance);
+      __mmask16 any_closer = 0;
+
+      for(uint32_t j = 0; j < 3; ++j)
+      {
+        const uint32_t a = j * 3;
+        const uint32_t b = ((j + 1) % 3) * 3;
+
+        const __m512 va_x = dispatch_avx512_tri_component(tri, a + 0);
+        const __m512 va_y = dispatch_avx512_tri_component(tri, a + 1);
+        const __m512 va_z = dispatch_avx512_tri_component(tri, a + 2);
+
+        const __m512 vb_x = dispatch_avx512_tri_component(tri, b + 0);
+        const __m512 vb_y = dispatch_avx512_tri_component(tri, b + 1);
+        const __m512 vb_z = dispatch_avx512_tri_component(tri, b + 2);
+
+        const __m512 v_x = _mm512_sub_ps(vb_x, va_x);
+        const __m512 v_y = _mm512_sub_ps(vb_y, va_y);
+        const __m512 v_z = _mm512_sub_ps(vb_z, va_z);
+
+        const __m512 w_x = _mm512_sub_ps(point_x, va_x);
+        const __m512 w_y = _mm512_sub_ps(point_y, va_y);
+        const __m512 w_z = _mm512_sub_ps(point_z, va_z);
+
+        const __m512 c1 = dispatch_avx512_dot(w_x, w_y, w_z, v_x, v_y, v_z);
+        const __m512 c2 = dispatch_avx512_dot(v_x, v_y, v_z, v_x, v_y, v_z);
+
+        // Before a, past b, or the projection between them.
+        const __mmask16 before_a = _mm512_cmp_ps_mask(c1, zero, _CMP_LE_OQ);
+        const __mmask16 past_b   = _mm512_mask_cmp_ps_mask((__mmask16)~before_a, c2, c1, _CMP_LE_OQ);
+        const __mmask16 between  = (__mmask16)~(before_a | past_b);
+
+        const __m512 scale = _mm512_maskz_div_ps(between, c1, c2);
+
+        const __m512 near_x = _mm512_mask_blend_ps(past_b, _mm512_fmadd_ps(v_x, scale, va_x), vb_x);
+        const __m512 near_y = _mm512_mask_blend_ps(past_b, _mm512_fmadd_ps(v_y, scale, va_y), vb_y);
+        const __m512 near_z = _mm512_mask_blend_ps(past_b, _mm512_fmadd_ps(v_z, scale, va_z), vb_z);
+
+        const __m512 d_x = _mm512_sub_ps(point_x, near_x);
+        const __m512 d_y = _mm512_sub_ps(point_y, near_y);
+        const __m512 d_z = _mm512_sub_ps(point_z, near_z);
+
+        const __m512 dist = _mm512_maskz_sqrt_ps(0xFFFF, dispatch_avx512_dot(d_x, d_y, d_z, d_x, d_y, d_z));
+
+        any_closer |= _mm512_cmp_ps_mask(dist, closest_in_pass, _CMP_LT_OQ);
+        _mm512_storeu_ps(&dists[j * 16], dist);
+      }
+
+      if(any_closer)
+      {
+        dispatch_closest_edge_pick(dists, 16, i, closest);
+      }
+    }
+
+    dispatch_closest_edge_scan(tris, i, tri_count, point, closest);
+
+    return dispatch_closest_edge_result(tris, closest, dispatch_closest_edge_max_dist(), seg_a, seg_b);
+  }
+
+
+  MATH_TARGET_AVX512 inline mat4
+  mat4_multiply_avx512(const mat4 &lhs, const mat4 &rhs)
+  {
+    const internal_mat4 *left  = reinterpret_cast<const internal_mat4*>(&lhs);
+    const internal_mat4 *right = reinterpret_cast<const internal_mat4*>(&rhs);
+
+    mat4 return_mat;
+    internal_mat4 *internal_mat = reinterpret_cast<internal_mat4*>(&return_mat);
+
+    // Whole lhs in one register, each rhs row in all four lanes.
+    const __m512 rows    = _mm512_loadu_ps(&left->data[0]);
+    const __m512 right_0 = _mm512_maskz_broadcast_f32x4(0xFFFF, right->simd_vec[0]);
+    const __m512 right_1 = _mm512_maskz_broadcast_f32x4(0xFFFF, right->simd_vec[1]);
+    const __m512 right_2 = _mm512_maskz_broadcast_f32x4(0xFFFF, right->simd_vec[2]);
+    const __m512 right_3 = _mm512_maskz_broadcast_f32x4(0xFFFF, right->simd_vec[3]);
+
+    __m512 result = _mm512_mul_ps(_mm512_maskz_permute_ps(0xFFFF, rows, _MM_SHUFFLE(0,0,0,0)), right_0);
+    result = _mm512_fmadd_ps(_mm512_maskz_permute_ps(0xFFFF, rows, _MM_SHUFFLE(1,1,1,1)), right_1, result);
+    result = _mm512_fmadd_ps(_mm512_maskz_permute_ps(0xFFFF, rows, _MM_SHUFFLE(2,2,2,2)), right_2, result);
+    result = _mm512_fmadd_ps(_mm512_maskz_permute_ps(0xFFFF, rows, _MM_SHUFFLE(3,3,3,3)), right_3, result);
+
+    _mm512_storeu_ps(&internal_mat->data[0], result);
+
+    return return_mat;
+  }
+} // ns
+
+
+_MATH_NS_CLOSE
+
+
+#undef MATH_TARGET_AVX512
+
+
+#endif // on dispatch
+#endif // inc guard
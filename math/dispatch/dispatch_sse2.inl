@@ -0,0 +1,280 @@
+#ifndef DISPATCH_SSE2_INCLUDED_389316A0_1ABC_42D4_97C1_9119D9AA4F9D
+#define DISPATCH_SSE2_INCLUDED_389316A0_1ABC_42D4_97C1_9119D9AA4F9D
+
+
+#include "../detail/detail.hpp"
+#include "dispatch.hpp"
+
+
+#ifdef MATH_ON_DISPATCH
+
+
+/*
+  Dispatch
+  SSE2 kernels, the base every x86-64 cpu can run.
+  Four points or triangles a pass.
+*/
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  // x * x' + y * y' + z * z' over four lanes.
+  inline __m128
+  dispatch_sse2_dot(const __m128 ax, const __m128 ay, const __m128 az, const __m128 bx, const __m128 by, const __m128 bz)
+  {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+  }
+
+
+  // Lane n is float n * 9 + offset, one component of four triangles.
+  inline __m128
+  dispatch_sse2_tri_component(const float tris[], const size_t offset)
+  {
+    return _mm_setr_ps(tris[offset], tris[offset + 9], tris[offset + 18], tris[offset + 27]);
+  }
+
+
+  inline aabb
+  aabb_init_from_xyz_data_sse2(const float vertex[], const size_t number_of_floats)
+  {
+    assert((number_of_floats % 3) == 0);
+    if((number_of_floats % 3) != 0 || number_of_floats < 12)
+    {
+      return MATH_NS_NAME::aabb_init_from_xyz_data(vertex, number_of_floats);
+    }
+
+    const size_t count = number_of_floats / 3;
+
+    // 12 floats is 4 points, so each register keeps the same axis pattern.
+    __m128 min_0 = _mm_loadu_ps(&vertex[0]);
+    __m128 min_1 = _mm_loadu_ps(&vertex[4]);
+    __m128 min_2 = _mm_loadu_ps(&vertex[8]);
+
+    __m128 max_0 = min_0;
+    __m128 max_1 = min_1;
+    __m128 max_2 = min_2;
+
+    size_t i = 4;
+
+    for(; i + 4 <= count; i += 4)
+    {
+      const float *points = &vertex[i * 3];
+
+      const __m128 points_0 = _mm_loadu_ps(&points[0]);
+      const __m128 points_1 = _mm_loadu_ps(&points[4]);
+      const __m128 points_2 = _mm_loadu_ps(&points[8]);
+
+      min_0 = _mm_min_ps(min_0, points_0);
+      min_1 = _mm_min_ps(min_1, points_1);
+      min_2 = _mm_min_ps(min_2, points_2);
+
+      max_0 = _mm_max_ps(max_0, points_0);
+      max_1 = _mm_max_ps(max_1, points_1);
+      max_2 = _mm_max_ps(max_2, points_2);
+    }
+
+    ALIGN16 float lanes_min[12];
+    ALIGN16 float lanes_max[12];
+
+    _mm_store_ps(&lanes_min[0], min_0);
+    _mm_store_ps(&lanes_min[4], min_1);
+    _mm_store_ps(&lanes_min[8], min_2);
+
+    _mm_store_ps(&lanes_max[0], max_0);
+    _mm_store_ps(&lanes_max[4], max_1);
+    _mm_store_ps(&lanes_max[8], max_2);
+
+    float box_min[3] = {vertex[0], vertex[1], vertex[2]};
+    float box_max[3] = {vertex[0], vertex[1], vertex[2]};
+
+    dispatch_fold_xyz_lanes(lanes_min, lanes_max, 12, box_min, box_max);
+    dispatch_xyz_tail(vertex, i, count, box_min, box_max);
+
+    return dispatch_aabb_from_min_max(box_min, box_max);
+  }
+
+
+  inline bool
+  ray_test_triangles_sse2(const ray &in_ray, const float tris[], const size_t tri_count, float *out_distance)
+  {
+    const vec3 r_dir = MATH_NS_NAME::ray_direction(in_ray);
+
+    const __m128 dir_x = _mm_set1_ps(vec3_get_x(r_dir));
+    const __m128 dir_y = _mm_set1_ps(vec3_get_y(r_dir));
+    const __m128 dir_z = _mm_set1_ps(vec3_get_z(r_dir));
+
+    const __m128 start_x = _mm_set1_ps(vec3_get_x(in_ray.start));
+    const __m128 start_y = _mm_set1_ps(vec3_get_y(in_ray.start));
+    const __m128 start_z = _mm_set1_ps(vec3_get_z(in_ray.start));
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one  = _mm_set1_ps(1.f);
+    const __m128 eps  = _mm_set1_ps(MATH_NS_NAME::epsilon());
+
+    size_t i = 0;
+
+    for(; i + 4 <= tri_count; i += 4)
+    {
+      const float *tri = &tris[i * 9];
+
+      const __m128 v0_x = dispatch_sse2_tri_component(tri, 0);
+      const __m128 v0_y = dispatch_sse2_tri_component(tri, 1);
+      const __m128 v0_z = dispatch_sse2_tri_component(tri, 2);
+
+      const __m128 e1_x = _mm_sub_ps(dispatch_sse2_tri_component(tri, 3), v0_x);
+      const __m128 e1_y = _mm_sub_ps(dispatch_sse2_tri_component(tri, 4), v0_y);
+      const __m128 e1_z = _mm_sub_ps(dispatch_sse2_tri_component(tri, 5), v0_z);
+
+      const __m128 e2_x = _mm_sub_ps(dispatch_sse2_tri_component(tri, 6), v0_x);
+      const __m128 e2_y = _mm_sub_ps(dispatch_sse2_tri_component(tri, 7), v0_y);
+      const __m128 e2_z = _mm_sub_ps(dispatch_sse2_tri_component(tri, 8), v0_z);
+
+      // p = dir x e2
+      const __m128 p_x = _mm_sub_ps(_mm_mul_ps(dir_y, e2_z), _mm_mul_ps(dir_z, e2_y));
+      const __m128 p_y = _mm_sub_ps(_mm_mul_ps(dir_z, e2_x), _mm_mul_ps(dir_x, e2_z));
+      const __m128 p_z = _mm_sub_ps(_mm_mul_ps(dir_x, e2_y), _mm_mul_ps(dir_y, e2_x));
+
+      const __m128 dot = dispatch_sse2_dot(e1_x, e1_y, e1_z, p_x, p_y, p_z);
+
+      // Same tests as the scalar loop, written as what passes.
+      __m128 hit = _mm_cmpnlt_ps(dot, eps);
+
+      if(!_mm_movemask_ps(hit))
+      {
+        continue;
+      }
+
+      const __m128 o_dot = _mm_div_ps(one, dot);
+
+      const __m128 t_x = _mm_sub_ps(start_x, v0_x);
+      const __m128 t_y = _mm_sub_ps(start_y, v0_y);
+      const __m128 t_z = _mm_sub_ps(start_z, v0_z);
+
+      const __m128 u = _mm_mul_ps(dispatch_sse2_dot(t_x, t_y, t_z, p_x, p_y, p_z), o_dot);
+
+      hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpgt_ps(u, zero), _mm_cmplt_ps(u, one)));
+
+      // q = t x e1
+      const __m128 q_x = _mm_sub_ps(_mm_mul_ps(t_y, e1_z), _mm_mul_ps(t_z, e1_y));
+      const __m128 q_y = _mm_sub_ps(_mm_mul_ps(t_z, e1_x), _mm_mul_ps(t_x, e1_z));
+      const __m128 q_z = _mm_sub_ps(_mm_mul_ps(t_x, e1_y), _mm_mul_ps(t_y, e1_x));
+
+      const __m128 v = _mm_mul_ps(dispatch_sse2_dot(dir_x, dir_y, dir_z, q_x, q_y, q_z), o_dot);
+
+      hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpnlt_ps(v, zero), _mm_cmpngt_ps(_mm_add_ps(u, v), one)));
+
+      const int hit_mask = _mm_movemask_ps(hit);
+
+      if(hit_mask)
+      {
+        // First triangle in the array wins, as with the scalar loop.
+        const uint32_t lane = (uint32_t)__builtin_ctz((uint32_t)hit_mask);
+
+        if(out_distance)
+        {
+          ALIGN16 float distances[4];
+          _mm_store_ps(distances, _mm_mul_ps(dispatch_sse2_dot(e2_x, e2_y, e2_z, q_x, q_y, q_z), o_dot));
+
+          *out_distance = distances[lane];
+        }
+
+        return true;
+      }
+    }
+
+    return MATH_NS_NAME::ray_test_triangles(in_ray, &tris[i * 9], tri_count - i, out_distance);
+  }
+
+
+  inline bool
+  ray_test_closest_edge_sse2(const float tris[], const size_t tri_count, const vec3 point, vec3 &seg_a, vec3 &seg_b)
+  {
+    dispatch_closest_edge closest{dispatch_closest_edge_max_dist(), 0, 0};
+
+    const __m128 point_x = _mm_set1_ps(vec3_get_x(point));
+    const __m128 point_y = _mm_set1_ps(vec3_get_y(point));
+    const __m128 point_z = _mm_set1_ps(vec3_get_z(point));
+
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t i = 0;
+
+    for(; i + 4 <= tri_count; i += 4)
+    {
+      const float *tri = &tris[i * 9];
+
+      ALIGN16 float dists[12];
+      __m128 closest_in_pass = _mm_set1_ps(closest.distance);
+      int any_closer = 0;
+
+      for(uint32_t j = 0; j < 3; ++j)
+      {
+        const uint32_t a = j * 3;
+        const uint32_t b = ((j + 1) % 3) * 3;
+
+        const __m128 va_x = dispatch_sse2_tri_component(tri, a + 0);
+        const __m128 va_y = dispatch_sse2_tri_component(tri, a + 1);
+        const __m128 va_z = dispatch_sse2_tri_component(tri, a + 2);
+
+        const __m128 vb_x = dispatch_sse2_tri_component(tri, b + 0);
+        const __m128 vb_y = dispatch_sse2_tri_component(tri, b + 1);
+        const __m128 vb_z = dispatch_sse2_tri_component(tri, b + 2);
+
+        const __m128 v_x = _mm_sub_ps(vb_x, va_x);
+        const __m128 v_y = _mm_sub_ps(vb_y, va_y);
+        const __m128 v_z = _mm_sub_ps(vb_z, va_z);
+
+        const __m128 w_x = _mm_sub_ps(point_x, va_x);
+        const __m128 w_y = _mm_sub_ps(point_y, va_y);
+        const __m128 w_z = _mm_sub_ps(point_z, va_z);
+
+        const __m128 c1 = dispatch_sse2_dot(w_x, w_y, w_z, v_x, v_y, v_z);
+        const __m128 c2 = dispatch_sse2_dot(v_x, v_y, v_z, v_x, v_y, v_z);
+
+        // Before a, past b, or the projection between them.
+        const __m128 before_a = _mm_cmple_ps(c1, zero);
+        const __m128 past_b   = _mm_andnot_ps(before_a, _mm_cmple_ps(c2, c1));
+        const __m128 between  = _mm_andnot_ps(_mm_or_ps(before_a, past_b), _mm_cmpeq_ps(zero, zero));
+
+        const __m128 scale = _mm_and_ps(between, _mm_div_ps(c1, c2));
+
+        const __m128 p_x = _mm_add_ps(va_x, _mm_mul_ps(v_x, scale));
+        const __m128 p_y = _mm_add_ps(va_y, _mm_mul_ps(v_y, scale));
+        const __m128 p_z = _mm_add_ps(va_z, _mm_mul_ps(v_z, scale));
+
+        const __m128 near_x = _mm_or_ps(_mm_and_ps(past_b, vb_x), _mm_andnot_ps(past_b, p_x));
+        const __m128 near_y = _mm_or_ps(_mm_and_ps(past_b, vb_y), _mm_andnot_ps(past_b, p_y));
+        const __m128 near_z = _mm_or_ps(_mm_and_ps(past_b, vb_z), _mm_andnot_ps(past_b, p_z));
+
+        const __m128 d_x = _mm_sub_ps(point_x, near_x);
+        const __m128 d_y = _mm_sub_ps(point_y, near_y);
+        const __m128 d_z = _mm_sub_ps(point_z, near_z);
+
+        const __m128 dist = _mm_sqrt_ps(dispatch_sse2_dot(d_x, d_y, d_z, d_x, d_y, d_z));
+
+        any_closer |= _mm_movemask_ps(_mm_cmplt_ps(dist, closest_in_pass));
+        _mm_store_ps(&dists[j * 4], dist);
+      }
+
+      // Most passes have nothing closer, so the ordered walk is skipped.
+      if(any_closer)
+      {
+        dispatch_closest_edge_pick(dists, 4, i, closest);
+      }
+    }
+
+    dispatch_closest_edge_scan(tris, i, tri_count, point, closest);
+
+    return dispatch_closest_edge_result(tris, closest, dispatch_closest_edge_max_dist(), seg_a, seg_b);
+  }
+} // ns
+
+
+_MATH_NS_CLOSE
+
+
+#endif // on dispatch
+#endif // inc guard
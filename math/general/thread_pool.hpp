@@ -0,0 +1,264 @@
+#ifndef THREAD_POOL_INCLUDED_2E5A80D0_3146_49E1_85E4_608456EA4E19
+#define THREAD_POOL_INCLUDED_2E5A80D0_3146_49E1_85E4_608456EA4E19
+
+
+/*
+  Thread Pool
+  --
+  Small work stealing pool for splitting loops over arrays. A loop is
+  cut into chunks which are dealt out to a queue per thread, threads
+  take from the front of their own queue and steal from the back of
+  the others once theirs is empty. The calling thread works too.
+
+  Nothing here orders the work, results need to be independent of
+  which thread ran them.
+*/
+
+
+#include "../detail/detail.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  struct thread_pool_job
+  {
+    std::function<void(size_t start, size_t end)>  work;
+    std::atomic<size_t>                            chunks_left;
+  };
+
+
+  struct thread_pool_chunk
+  {
+    thread_pool_job *job;
+    size_t          start;
+    size_t          end;
+  };
+
+
+  struct thread_pool_queue
+  {
+    std::mutex                      lock;
+    std::deque<thread_pool_chunk>   chunks;
+  };
+}
+
+
+struct thread_pool
+{
+  // Zero workers is one less than the hardware threads, the caller is the last.
+  explicit thread_pool(const uint32_t worker_count = 0);
+  ~thread_pool();
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  std::vector<std::thread>                                workers;
+  std::vector<std::unique_ptr<detail::thread_pool_queue>> queues; // One per worker, then the caller.
+
+  std::mutex                wake_lock;
+  std::condition_variable   wake;
+  uint64_t                  generation = 0;
+  bool                      stop       = false;
+};
+
+
+// ------------------------------------------------------------ [ Interface ] --
+
+
+inline uint32_t     thread_pool_thread_count(const thread_pool &pool); // Workers plus the caller.
+
+// Runs work(start, end) over [0, count) in chunks of about grain, returns once all are done.
+inline void         thread_pool_parallel_for(thread_pool &pool, const size_t count, const size_t grain, const std::function<void(size_t start, size_t end)> &work);
+
+
+// ----------------------------------------------------------------- [ Impl ] --
+
+
+namespace detail
+{
+  inline bool
+  thread_pool_take(thread_pool &pool, const size_t self, thread_pool_chunk &out_chunk)
+  {
+    const size_t queue_count = pool.queues.size();
+
+    // Own queue from the front, then steal from the back of the others.
+    for(size_t i = 0; i < queue_count; ++i)
+    {
+      thread_pool_queue &queue = *pool.queues[(self + i) % queue_count];
+      std::lock_guard<std::mutex> guard(queue.lock);
+
+      if(!queue.chunks.empty())
+      {
+        if(i == 0)
+        {
+          out_chunk = queue.chunks.front();
+          queue.chunks.pop_front();
+        }
+        else
+        {
+          out_chunk = queue.chunks.back();
+          queue.chunks.pop_back();
+        }
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+
+  inline void
+  thread_pool_run(const thread_pool_chunk &chunk)
+  {
+    chunk.job->work(chunk.start, chunk.end);
+    chunk.job->chunks_left.fetch_sub(1, std::memory_order_acq_rel);
+  }
+
+
+  inline void
+  thread_pool_worker(thread_pool &pool, const size_t self)
+  {
+    uint64_t seen = 0;
+
+    while(true)
+    {
+      thread_pool_chunk chunk;
+
+      while(thread_pool_take(pool, self, chunk))
+      {
+        thread_pool_run(chunk);
+      }
+
+      // Sleep until there is a new job, seen was taken before the queues were checked.
+      std::unique_lock<std::mutex> guard(pool.wake_lock);
+      pool.wake.wait(guard, [&]{ return pool.stop || pool.generation != seen; });
+
+      if(pool.stop)
+      {
+        return;
+      }
+
+      seen = pool.generation;
+    }
+  }
+} // ns
+
+
+inline
+thread_pool::thread_pool(const uint32_t worker_count)
+{
+  const uint32_t hardware = std::thread::hardware_concurrency();
+  const uint32_t count    = worker_count ? worker_count : (hardware > 1 ? hardware - 1 : 0);
+
+  for(uint32_t i = 0; i < count + 1; ++i)
+  {
+    queues.emplace_back(new detail::thread_pool_queue());
+  }
+
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    workers.emplace_back(detail::thread_pool_worker, std::ref(*this), i);
+  }
+}
+
+
+inline
+thread_pool::~thread_pool()
+{
+  {
+    std::lock_guard<std::mutex> guard(wake_lock);
+    stop = true;
+  }
+
+  wake.notify_all();
+
+  for(std::thread &worker : workers)
+  {
+    worker.join();
+  }
+}
+
+
+uint32_t
+thread_pool_thread_count(const thread_pool &pool)
+{
+  return static_cast<uint32_t>(pool.queues.size());
+}
+
+
+void
+thread_pool_parallel_for(thread_pool &pool, const size_t count, const size_t grain, const std::function<void(size_t start, size_t end)> &work)
+{
+  const size_t chunk_size  = grain ? grain : 1;
+  const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+
+  // Not worth waking anyone.
+  if(chunk_count < 2 || pool.workers.empty())
+  {
+    if(count)
+    {
+      work(0, count);
+    }
+
+    return;
+  }
+
+  detail::thread_pool_job job;
+  job.work = work;
+  job.chunks_left.store(chunk_count, std::memory_order_relaxed);
+
+  const size_t queue_count = pool.queues.size();
+
+  for(size_t i = 0; i < chunk_count; ++i)
+  {
+    const size_t start = i * chunk_size;
+    const size_t end   = start + chunk_size < count ? start + chunk_size : count;
+
+    detail::thread_pool_queue &queue = *pool.queues[i % queue_count];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    queue.chunks.push_back(detail::thread_pool_chunk{&job, start, end});
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(pool.wake_lock);
+    ++pool.generation;
+  }
+
+  pool.wake.notify_all();
+
+  // The caller has the last queue.
+  const size_t self = queue_count - 1;
+  detail::thread_pool_chunk chunk;
+
+  while(job.chunks_left.load(std::memory_order_acquire))
+  {
+    if(detail::thread_pool_take(pool, self, chunk))
+    {
+      detail::thread_pool_run(chunk);
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // include guard
@@ -171,34 +171,23 @@ aabb_set_origin(aabb &aabb_to_move, const vec3 new_position)
 }
 
 
-namespace detail
-{
-  // Simple Single Axis Therom test.
-  // We assume we are dealing with just AABB boxes.
-  inline bool
-  sat_test(const float origin_a,
-           const float origin_b,
-           const float combined_length)
-  {
-    return MATH_NS_NAME::abs(origin_b - origin_a) < combined_length;
-  }
-} // ns
-
-
 bool
 aabb_intersection_test(const aabb &a,
                        const aabb &b)
 {
-  const vec3 origin_a = aabb_get_origin(a);
-  const vec3 origin_b = aabb_get_origin(b);
-  
-  const vec3 half_ext_a = aabb_get_half_extents(a);
-  const vec3 half_ext_b = aabb_get_half_extents(b);
-  const vec3 combined_half_extent = vec3_add(half_ext_a, half_ext_b);
-
-  return (detail::sat_test(MATH_NS_NAME::vec3_get_x(origin_a), MATH_NS_NAME::vec3_get_x(origin_b), MATH_NS_NAME::vec3_get_x(combined_half_extent)) &&
-          detail::sat_test(MATH_NS_NAME::vec3_get_y(origin_a), MATH_NS_NAME::vec3_get_y(origin_b), MATH_NS_NAME::vec3_get_y(combined_half_extent)) &&
-          detail::sat_test(MATH_NS_NAME::vec3_get_z(origin_a), MATH_NS_NAME::vec3_get_z(origin_b), MATH_NS_NAME::vec3_get_z(combined_half_extent)));
+  // Overlapping on all three axes, touching faces don't count.
+  #ifdef MATH_ON_SSE2
+  const __m128 overlap = _mm_and_ps(_mm_cmplt_ps(a.min.simd_vec, b.max.simd_vec),
+                                    _mm_cmplt_ps(b.min.simd_vec, a.max.simd_vec));
+
+  return (_mm_movemask_ps(overlap) & 0x7) == 0x7;
+  #else
+  // Twice the center distance against the summed extents, one compare an
+  // axis that mostly fails on x, so the early out predicts well.
+  return (MATH_NS_NAME::abs((vec3_get_x(a.min) + vec3_get_x(a.max)) - (vec3_get_x(b.min) + vec3_get_x(b.max))) < (vec3_get_x(a.max) - vec3_get_x(a.min)) + (vec3_get_x(b.max) - vec3_get_x(b.min))) &&
+         (MATH_NS_NAME::abs((vec3_get_y(a.min) + vec3_get_y(a.max)) - (vec3_get_y(b.min) + vec3_get_y(b.max))) < (vec3_get_y(a.max) - vec3_get_y(a.min)) + (vec3_get_y(b.max) - vec3_get_y(b.min))) &&
+         (MATH_NS_NAME::abs((vec3_get_z(a.min) + vec3_get_z(a.max)) - (vec3_get_z(b.min) + vec3_get_z(b.max))) < (vec3_get_z(a.max) - vec3_get_z(a.min)) + (vec3_get_z(b.max) - vec3_get_z(b.min)));
+  #endif
 }
 
 
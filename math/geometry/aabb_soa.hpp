@@ -0,0 +1,239 @@
+#ifndef AABB_SOA_INCLUDED_1242D055_62E6_42D0_AF89_BD0F79A8CEFC
+#define AABB_SOA_INCLUDED_1242D055_62E6_42D0_AF89_BD0F79A8CEFC
+
+
+/*
+  AABB SoA
+  --
+  Broadphase queries over many boxes. One box against N fills a mask
+  word per 32 boxes, 4 or 8 at a time with SSE or AVX. N against M
+  works through M in tiles small enough to stay in L1 while every box
+  of N goes over them.
+
+  This pays off with AVX, about twice as fast as aabb_intersection_test
+  a pair at a time. With SSE the two are about even. Without SIMD the
+  pair test is quicker, as it stops at the first axis apart and reads
+  each box from one place, so use that instead.
+*/
+
+
+#include "../detail/detail.hpp"
+#include "geometry_types.hpp"
+#include "../vec/vec3.hpp"
+#include "../general/general.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <float.h>
+#include <assert.h>
+
+
+_MATH_NS_OPEN
+
+
+// ----------------------------------------------------------- [ Interface ] --
+
+
+inline aabb_soa     aabb_soa_init(const aabb boxes[], const size_t count);
+inline void         aabb_soa_set(aabb_soa &boxes, const size_t index, const aabb &box);
+inline aabb         aabb_soa_get(const aabb_soa &boxes, const size_t index);
+
+// Returns the number of boxes overlapped. out_hit_mask has a bit per box, (boxes.count + 31) / 32 words.
+inline size_t       aabb_soa_test_aabb(const aabb_soa &boxes, const aabb &box, uint32_t out_hit_mask[]);
+
+// Every box of a against every box of b, returns the number of pairs. Row n of out_hit_mask is a's box n against b, (b.count + 31) / 32 words a row.
+inline size_t       aabb_soa_test_aabb_soa(const aabb_soa &a, const aabb_soa &b, uint32_t out_hit_mask[]);
+
+
+// ---------------------------------------------------------------- [ Impl ] --
+
+
+namespace detail
+{
+  // Words of b each tile holds, 8 words is 256 boxes and 6kb.
+  constexpr size_t aabb_soa_tile_words() { return 8; }
+
+
+  inline uint32_t
+  aabb_soa_bit_count(uint32_t bits)
+  {
+    bits = bits - ((bits >> 1) & 0x55555555u);
+    bits = (bits & 0x33333333u) + ((bits >> 2) & 0x33333333u);
+
+    return (((bits + (bits >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+  }
+
+
+  /*
+    Overlaps of one box against boxes [word * 32, word * 32 + 32), as
+    aabb_intersection_test. The padding boxes never overlap.
+  */
+  inline uint32_t
+  aabb_soa_test_word(const aabb_soa &boxes, const size_t word, const float box_min[3], const float box_max[3])
+  {
+    const size_t first = word * 32;
+    uint32_t mask = 0;
+
+    #if defined(MATH_ON_AVX)
+    for(uint32_t i = 0; i < 32; i += 8)
+    {
+      __m256 overlap = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+      for(uint32_t axis = 0; axis < 3; ++axis)
+      {
+        const __m256 soa_min = _mm256_loadu_ps(&boxes.min[axis][first + i]);
+        const __m256 soa_max = _mm256_loadu_ps(&boxes.max[axis][first + i]);
+
+        overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(_mm256_set1_ps(box_min[axis]), soa_max, _CMP_LT_OQ));
+        overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(soa_min, _mm256_set1_ps(box_max[axis]), _CMP_LT_OQ));
+      }
+
+      mask |= (uint32_t)_mm256_movemask_ps(overlap) << i;
+    }
+    #elif defined(MATH_ON_SSE2)
+    for(uint32_t i = 0; i < 32; i += 4)
+    {
+      __m128 overlap = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+      for(uint32_t axis = 0; axis < 3; ++axis)
+      {
+        const __m128 soa_min = _mm_loadu_ps(&boxes.min[axis][first + i]);
+        const __m128 soa_max = _mm_loadu_ps(&boxes.max[axis][first + i]);
+
+        overlap = _mm_and_ps(overlap, _mm_cmplt_ps(_mm_set1_ps(box_min[axis]), soa_max));
+        overlap = _mm_and_ps(overlap, _mm_cmplt_ps(soa_min, _mm_set1_ps(box_max[axis])));
+      }
+
+      mask |= (uint32_t)_mm_movemask_ps(overlap) << i;
+    }
+    #else
+    // As the scalar aabb_intersection_test, centers and extents doubled.
+    const float center[3] = {box_min[0] + box_max[0], box_min[1] + box_max[1], box_min[2] + box_max[2]};
+    const float extent[3] = {box_max[0] - box_min[0], box_max[1] - box_min[1], box_max[2] - box_min[2]};
+
+    for(uint32_t i = 0; i < 32; ++i)
+    {
+      const size_t box = first + i;
+      bool overlap = true;
+
+      for(uint32_t axis = 0; axis < 3 && overlap; ++axis)
+      {
+        const float soa_center = boxes.min[axis][box] + boxes.max[axis][box];
+        const float soa_extent = boxes.max[axis][box] - boxes.min[axis][box];
+
+        overlap = MATH_NS_NAME::abs(center[axis] - soa_center) < extent[axis] + soa_extent;
+      }
+
+      mask |= (overlap ? 1u : 0u) << i;
+    }
+    #endif
+
+    return mask;
+  }
+} // ns
+
+
+aabb_soa
+aabb_soa_init(const aabb boxes[], const size_t count)
+{
+  const size_t padded = (count + 31) & ~size_t(31);
+
+  aabb_soa out;
+  out.count = count;
+
+  for(uint32_t axis = 0; axis < 3; ++axis)
+  {
+    out.min[axis].assign(padded, +FLT_MAX);
+    out.max[axis].assign(padded, -FLT_MAX);
+  }
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    aabb_soa_set(out, i, boxes[i]);
+  }
+
+  return out;
+}
+
+
+void
+aabb_soa_set(aabb_soa &boxes, const size_t index, const aabb &box)
+{
+  assert(index < boxes.count);
+
+  boxes.min[0][index] = vec3_get_x(box.min);
+  boxes.min[1][index] = vec3_get_y(box.min);
+  boxes.min[2][index] = vec3_get_z(box.min);
+  boxes.max[0][index] = vec3_get_x(box.max);
+  boxes.max[1][index] = vec3_get_y(box.max);
+  boxes.max[2][index] = vec3_get_z(box.max);
+}
+
+
+aabb
+aabb_soa_get(const aabb_soa &boxes, const size_t index)
+{
+  assert(index < boxes.count);
+
+  return aabb{
+    vec3_init(boxes.max[0][index], boxes.max[1][index], boxes.max[2][index]),
+    vec3_init(boxes.min[0][index], boxes.min[1][index], boxes.min[2][index])
+  };
+}
+
+
+size_t
+aabb_soa_test_aabb(const aabb_soa &boxes, const aabb &box, uint32_t out_hit_mask[])
+{
+  const float box_min[3] = {vec3_get_x(box.min), vec3_get_y(box.min), vec3_get_z(box.min)};
+  const float box_max[3] = {vec3_get_x(box.max), vec3_get_y(box.max), vec3_get_z(box.max)};
+
+  const size_t words = (boxes.count + 31) / 32;
+  size_t hit_count = 0;
+
+  for(size_t word = 0; word < words; ++word)
+  {
+    const uint32_t mask = detail::aabb_soa_test_word(boxes, word, box_min, box_max);
+
+    out_hit_mask[word] = mask;
+    hit_count += detail::aabb_soa_bit_count(mask);
+  }
+
+  return hit_count;
+}
+
+
+size_t
+aabb_soa_test_aabb_soa(const aabb_soa &a, const aabb_soa &b, uint32_t out_hit_mask[])
+{
+  const size_t words = (b.count + 31) / 32;
+  size_t hit_count = 0;
+
+  for(size_t tile = 0; tile < words; tile += detail::aabb_soa_tile_words())
+  {
+    const size_t tile_end = tile + detail::aabb_soa_tile_words() < words ? tile + detail::aabb_soa_tile_words() : words;
+
+    for(size_t row = 0; row < a.count; ++row)
+    {
+      const float box_min[3] = {a.min[0][row], a.min[1][row], a.min[2][row]};
+      const float box_max[3] = {a.max[0][row], a.max[1][row], a.max[2][row]};
+
+      uint32_t *row_mask = &out_hit_mask[row * words];
+
+      for(size_t word = tile; word < tile_end; ++word)
+      {
+        const uint32_t mask = detail::aabb_soa_test_word(b, word, box_min, box_max);
+
+        row_mask[word] = mask;
+        hit_count += detail::aabb_soa_bit_count(mask);
+      }
+    }
+  }
+
+  return hit_count;
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // inc guard
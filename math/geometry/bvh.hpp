@@ -0,0 +1,509 @@
+#ifndef BVH_INCLUDED_4D811BE8_B62E_4E00_9B85_595FECB328CD
+#define BVH_INCLUDED_4D811BE8_B62E_4E00_9B85_595FECB328CD
+
+
+/*
+  BVH
+  --
+  Bounding volume hierarchy over a packed triangle soup, the same
+  9 floats per triangle layout as ray_test_triangles. Built once with
+  binned SAH, then rays walk it front to back and return the closest
+  hit, so a query touches a few leaves not every triangle.
+*/
+
+
+#include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
+#include "geometry_types.hpp"
+#include "ray.hpp"
+#include "../vec/vec3.hpp"
+#include "../general/general.hpp"
+#include <vector>
+#include <algorithm>
+#include <stddef.h>
+#include <stdint.h>
+#include <float.h>
+#include <math.h>
+#include <assert.h>
+
+
+_MATH_NS_OPEN
+
+
+// ----------------------------------------------------------- [ Interface ] --
+
+
+inline bvh          bvh_init(const float tris[], const size_t tri_count);
+
+// Closest hit in front of the ray start, back faces are culled as ray_test_triangles.
+inline bool         bvh_test_ray(const bvh &bvh, const ray &in_ray, ray_hit *out_hit = nullptr);
+inline bool         bvh_test_ray(const bvh &bvh, const ray &in_ray, const ray_query query, const ray_cull cull, ray_hit *out_hit = nullptr); // Hits between start and end.
+
+
+// ---------------------------------------------------------------- [ Impl ] --
+
+
+namespace detail
+{
+  MATH_CONSTEXPR uint32_t bvh_bin_count() { return 16; }
+  MATH_CONSTEXPR uint32_t bvh_max_depth() { return 64; }
+  MATH_CONSTEXPR float    bvh_no_hit()    { return FLT_MAX; }
+
+  // Cost of visiting a node, against one triangle test.
+  MATH_CONSTEXPR float    bvh_traversal_cost() { return 1.f; }
+
+
+  struct bvh_bounds
+  {
+    float min[3];
+    float max[3];
+  };
+
+
+  inline bvh_bounds
+  bvh_bounds_empty()
+  {
+    return bvh_bounds{{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+  }
+
+
+  // Plain compares not fminf / fmaxf, they are calls without fast math.
+  inline void
+  bvh_bounds_grow(bvh_bounds &bounds, const bvh_bounds &other)
+  {
+    for(uint32_t axis = 0; axis < 3; ++axis)
+    {
+      bounds.min[axis] = other.min[axis] < bounds.min[axis] ? other.min[axis] : bounds.min[axis];
+      bounds.max[axis] = other.max[axis] > bounds.max[axis] ? other.max[axis] : bounds.max[axis];
+    }
+  }
+
+
+  // Half the surface area, the SAH only compares them.
+  inline float
+  bvh_bounds_half_area(const bvh_bounds &bounds)
+  {
+    if(bounds.min[0] > bounds.max[0])
+    {
+      return 0.f;
+    }
+
+    const float x = bounds.max[0] - bounds.min[0];
+    const float y = bounds.max[1] - bounds.min[1];
+    const float z = bounds.max[2] - bounds.min[2];
+
+    return (x * y) + (y * z) + (z * x);
+  }
+
+
+  // Triangles are partitioned as these, so each split reads them in order.
+  struct bvh_build_ref
+  {
+    bvh_bounds bounds;
+    float      centroid[3];
+    uint32_t   tri;
+  };
+
+
+  inline bvh_node
+  bvh_make_node(const bvh_bounds &bounds, const uint32_t first, const uint32_t count)
+  {
+    return bvh_node{
+      {bounds.min[0], bounds.min[1], bounds.min[2]}, first,
+      {bounds.max[0], bounds.max[1], bounds.max[2]}, count
+    };
+  }
+
+
+  struct bvh_split
+  {
+    uint32_t   axis;
+    uint32_t   bin;         // Bins below go left.
+    float      cmin;        // Centroid bounds min on the axis.
+    float      scale;       // Bins per unit on the axis.
+    float      cost;
+    uint32_t   left_count;
+    bvh_bounds left;
+    bvh_bounds right;
+  };
+
+
+  inline uint32_t
+  bvh_split_bin(const float centroid, const float cmin, const float scale)
+  {
+    const uint32_t bin = static_cast<uint32_t>((centroid - cmin) * scale);
+    return MATH_NS_NAME::min(bin, bvh_bin_count() - 1);
+  }
+
+
+  /*
+    Bins the centroids on all three axes in one pass, then sweeps the
+    planes between the bins, cost is count * area on each side. The
+    cost is bvh_no_hit when nothing splits. The bins also give the
+    bounds of both sides, so the children don't walk their triangles.
+  */
+  inline bvh_split
+  bvh_find_split(const std::vector<bvh_build_ref> &refs, const bvh_node &node)
+  {
+    bvh_split best{};
+    best.cost = bvh_no_hit();
+
+    bvh_bounds centroid_bounds = bvh_bounds_empty();
+
+    for(uint32_t i = node.first; i < node.first + node.count; ++i)
+    {
+      const float *centroid = refs[i].centroid;
+      bvh_bounds_grow(centroid_bounds, bvh_bounds{{centroid[0], centroid[1], centroid[2]}, {centroid[0], centroid[1], centroid[2]}});
+    }
+
+    // Flat axes put everything in the first bin and never split.
+    float scale[3];
+
+    for(uint32_t axis = 0; axis < 3; ++axis)
+    {
+      const float extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+      scale[axis] = extent > 0.f ? bvh_bin_count() / extent : 0.f;
+    }
+
+    bvh_bounds bin_bounds[3][bvh_bin_count()];
+    uint32_t   bin_counts[3][bvh_bin_count()] = {};
+
+    for(uint32_t axis = 0; axis < 3; ++axis)
+    {
+      for(uint32_t bin = 0; bin < bvh_bin_count(); ++bin)
+      {
+        bin_bounds[axis][bin] = bvh_bounds_empty();
+      }
+    }
+
+    for(uint32_t i = node.first; i < node.first + node.count; ++i)
+    {
+      const bvh_build_ref &ref = refs[i];
+
+      for(uint32_t axis = 0; axis < 3; ++axis)
+      {
+        const uint32_t bin = bvh_split_bin(ref.centroid[axis], centroid_bounds.min[axis], scale[axis]);
+
+        bvh_bounds_grow(bin_bounds[axis][bin], ref.bounds);
+        ++bin_counts[axis][bin];
+      }
+    }
+
+    for(uint32_t axis = 0; axis < 3; ++axis)
+    {
+      // Left side of each plane, then the right side on the way back.
+      bvh_bounds left_bounds[bvh_bin_count() - 1];
+      uint32_t   left_count[bvh_bin_count() - 1];
+
+      bvh_bounds left = bvh_bounds_empty();
+      uint32_t left_total = 0;
+
+      for(uint32_t plane = 0; plane < bvh_bin_count() - 1; ++plane)
+      {
+        bvh_bounds_grow(left, bin_bounds[axis][plane]);
+        left_total += bin_counts[axis][plane];
+
+        left_bounds[plane] = left;
+        left_count[plane]  = left_total;
+      }
+
+      bvh_bounds right = bvh_bounds_empty();
+      uint32_t right_total = 0;
+
+      for(uint32_t plane = bvh_bin_count() - 1; plane > 0; --plane)
+      {
+        bvh_bounds_grow(right, bin_bounds[axis][plane]);
+        right_total += bin_counts[axis][plane];
+
+        const uint32_t left_side = plane - 1;
+
+        if(!left_count[left_side] || !right_total)
+        {
+          continue;
+        }
+
+        const float cost = (left_count[left_side] * bvh_bounds_half_area(left_bounds[left_side])) + (right_total * bvh_bounds_half_area(right));
+
+        if(cost < best.cost)
+        {
+          best = bvh_split{axis, plane, centroid_bounds.min[axis], scale[axis], cost, left_count[left_side], left_bounds[left_side], right};
+        }
+      }
+    }
+
+    return best;
+  }
+
+
+  /*
+    Distance the ray enters the node, or bvh_no_hit if it misses or
+    only enters past t_max. Uses the ray_slab_clip rule, so axis
+    aligned rays starting on a node's face still go in.
+  */
+  inline float
+  bvh_node_entry(const bvh_node &node, const vec3 origin, const vec3 inv_dir, const float t_max)
+  {
+    #ifdef MATH_ON_SSE2
+    // The fourth floats of min and max are first and count, their lanes aren't used.
+    float enter;
+    const bool hit = ray_slab_sse(_mm_loadu_ps(node.min), _mm_loadu_ps(node.max), origin.simd_vec, inv_dir.simd_vec, 0.f, t_max, enter);
+    #else
+    const float start[3] = {vec3_get_x(origin), vec3_get_y(origin), vec3_get_z(origin)};
+    const float inv[3]   = {vec3_get_x(inv_dir), vec3_get_y(inv_dir), vec3_get_z(inv_dir)};
+
+    float enter = 0.f;
+    float exit  = t_max;
+
+    for(uint32_t axis = 0; axis < 3; ++axis)
+    {
+      ray_slab_clip(node.min[axis], node.max[axis], start[axis], inv[axis], enter, exit);
+    }
+
+    const bool hit = enter <= exit;
+    #endif
+
+    return hit ? enter : bvh_no_hit();
+  }
+} // ns
+
+
+bvh
+bvh_init(const float tris[], const size_t tri_count)
+{
+  bvh out;
+
+  if(!tri_count)
+  {
+    return out;
+  }
+
+  assert(tri_count < UINT32_MAX);
+
+  const uint32_t count = static_cast<uint32_t>(tri_count);
+
+  std::vector<detail::bvh_build_ref> refs(count);
+  detail::bvh_bounds root_bounds = detail::bvh_bounds_empty();
+
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    detail::bvh_bounds bounds = detail::bvh_bounds_empty();
+
+    for(uint32_t vert = 0; vert < 3; ++vert)
+    {
+      const float *xyz = &tris[(i * 9) + (vert * 3)];
+      detail::bvh_bounds_grow(bounds, detail::bvh_bounds{{xyz[0], xyz[1], xyz[2]}, {xyz[0], xyz[1], xyz[2]}});
+    }
+
+    refs[i].bounds = bounds;
+    refs[i].tri    = i;
+
+    for(uint32_t axis = 0; axis < 3; ++axis)
+    {
+      refs[i].centroid[axis] = (bounds.min[axis] + bounds.max[axis]) * 0.5f;
+    }
+
+    detail::bvh_bounds_grow(root_bounds, bounds);
+  }
+
+  out.nodes.reserve((count * 2) - 1);
+  out.nodes.push_back(detail::bvh_make_node(root_bounds, 0, count));
+
+  // Node and its depth, depth is capped so the traversal stack is fixed.
+  std::vector<uint32_t> todo;
+  todo.push_back(0);
+  todo.push_back(1);
+
+  while(!todo.empty())
+  {
+    const uint32_t depth      = todo.back(); todo.pop_back();
+    const uint32_t node_index = todo.back(); todo.pop_back();
+
+    const bvh_node node = out.nodes[node_index];
+
+    if(node.count <= 1 || depth >= detail::bvh_max_depth())
+    {
+      continue;
+    }
+
+    const detail::bvh_split split = detail::bvh_find_split(refs, node);
+
+    const detail::bvh_bounds node_bounds{{node.min[0], node.min[1], node.min[2]}, {node.max[0], node.max[1], node.max[2]}};
+    const float node_area = detail::bvh_bounds_half_area(node_bounds);
+
+    if(split.cost + (detail::bvh_traversal_cost() * node_area) >= node.count * node_area)
+    {
+      continue;
+    }
+
+    detail::bvh_build_ref *ref_start = refs.data() + node.first;
+
+    std::partition(ref_start, ref_start + node.count, [&](const detail::bvh_build_ref &ref)
+    {
+      return detail::bvh_split_bin(ref.centroid[split.axis], split.cmin, split.scale) < split.bin;
+    });
+
+    const uint32_t left = static_cast<uint32_t>(out.nodes.size());
+
+    out.nodes.push_back(detail::bvh_make_node(split.left, node.first, split.left_count));
+    out.nodes.push_back(detail::bvh_make_node(split.right, node.first + split.left_count, node.count - split.left_count));
+
+    out.nodes[node_index].first = left;
+    out.nodes[node_index].count = 0;
+
+    todo.push_back(left);
+    todo.push_back(depth + 1);
+    todo.push_back(left + 1);
+    todo.push_back(depth + 1);
+  }
+
+  // Leaves read their triangles front to back.
+  out.tris.resize(count * 9);
+  out.tri_index.resize(count);
+
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    out.tri_index[i] = refs[i].tri;
+    std::copy(&tris[refs[i].tri * 9], &tris[(refs[i].tri * 9) + 9], &out.tris[i * 9]);
+  }
+
+  return out;
+}
+
+
+namespace detail
+{
+  /*
+    Walks near child first and skips nodes entered past hit.distance,
+    which starts as the ray's t_max and shrinks with each closer hit.
+  */
+  inline bool
+  bvh_traverse(const bvh &bvh, const vec3 origin, const vec3 dir, const ray_query query, const ray_cull cull, ray_hit &hit)
+  {
+    if(bvh.nodes.empty())
+    {
+      return false;
+    }
+
+    const vec3 inv_dir = vec3_init(1.f / vec3_get_x(dir), 1.f / vec3_get_y(dir), 1.f / vec3_get_z(dir));
+
+    // Far children waiting, with the distance they were entered at.
+    uint32_t stack_node[bvh_max_depth()];
+    float    stack_entry[bvh_max_depth()];
+    uint32_t stack_size = 0;
+
+    uint32_t node_index = 0;
+    bool found = false;
+
+    if(bvh_node_entry(bvh.nodes[0], origin, inv_dir, hit.distance) == bvh_no_hit())
+    {
+      return false;
+    }
+
+    while(true)
+    {
+      const bvh_node &node = bvh.nodes[node_index];
+
+      if(node.count)
+      {
+        if(ray_test_triangle_range(origin, dir, bvh.tris.data(), bvh.tri_index.data(), node.first, node.count, query, cull, hit))
+        {
+          found = true;
+
+          if(query == ray_query::any_hit)
+          {
+            return true;
+          }
+        }
+      }
+      else
+      {
+        uint32_t near_node = node.first;
+        uint32_t far_node  = node.first + 1;
+
+        float near_entry = bvh_node_entry(bvh.nodes[near_node], origin, inv_dir, hit.distance);
+        float far_entry  = bvh_node_entry(bvh.nodes[far_node], origin, inv_dir, hit.distance);
+
+        if(far_entry < near_entry)
+        {
+          std::swap(near_node, far_node);
+          std::swap(near_entry, far_entry);
+        }
+
+        if(near_entry != bvh_no_hit())
+        {
+          if(far_entry != bvh_no_hit())
+          {
+            assert(stack_size < bvh_max_depth());
+
+            stack_node[stack_size]  = far_node;
+            stack_entry[stack_size] = far_entry;
+            ++stack_size;
+          }
+
+          node_index = near_node;
+          continue;
+        }
+      }
+
+      // Skip anything entered past a hit found since it was pushed.
+      while(stack_size && stack_entry[stack_size - 1] > hit.distance)
+      {
+        --stack_size;
+      }
+
+      if(!stack_size)
+      {
+        break;
+      }
+
+      node_index = stack_node[--stack_size];
+    }
+
+    return found;
+  }
+} // ns
+
+
+bool
+bvh_test_ray(const bvh &bvh, const ray &in_ray, ray_hit *out_hit)
+{
+  ray_hit hit{detail::bvh_no_hit(), 0, 0.f, 0.f};
+
+  if(!detail::bvh_traverse(bvh, in_ray.start, ray_direction(in_ray), ray_query::closest_hit, ray_cull::back_faces, hit))
+  {
+    return false;
+  }
+
+  if(out_hit)
+  {
+    *out_hit = hit;
+  }
+
+  return true;
+}
+
+
+bool
+bvh_test_ray(const bvh &bvh, const ray &in_ray, const ray_query query, const ray_cull cull, ray_hit *out_hit)
+{
+  // Just past the end so a hit on it counts, as ray_test_triangles.
+  ray_hit hit{nextafterf(ray_length(in_ray), FLT_MAX), 0, 0.f, 0.f};
+
+  if(!detail::bvh_traverse(bvh, in_ray.start, ray_direction(in_ray), query, cull, hit))
+  {
+    return false;
+  }
+
+  if(out_hit)
+  {
+    *out_hit = hit;
+  }
+
+  return true;
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // inc guard
@@ -4,8 +4,12 @@
 
 #include "geometry_types.hpp"
 #include "ray.hpp"
+#include "ray_prepared.hpp"
 #include "aabb.hpp"
+#include "aabb_soa.hpp"
 #include "plane.hpp"
+#include "bvh.hpp"
+#include "ray_packet.hpp"
 
 
 #endif // inc guard
@@ -3,6 +3,7 @@
 
 
 #include "../detail/detail.hpp"
+#include <stdint.h>
 
 
 _MATH_NS_OPEN
@@ -11,6 +12,15 @@ _MATH_NS_OPEN
 struct ray;
 struct aabb;
 struct plane;
+struct ray_hit;
+enum class ray_query : uint32_t;
+enum class ray_cull : uint32_t;
+struct ray_prepared;
+struct ray_packet4;
+struct ray_packet8;
+struct bvh_node;
+struct bvh;
+struct aabb_soa;
 
 
 _MATH_NS_CLOSE
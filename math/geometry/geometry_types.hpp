@@ -4,6 +4,10 @@
 
 #include "../detail/detail.hpp"
 #include "../vec/vec3.hpp"
+#include "../vec/vec_types.hpp"
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
 
 
 _MATH_NS_OPEN
@@ -30,6 +34,116 @@ struct plane
 };
 
 
+enum class ray_query : uint32_t
+{
+  any_hit,      // Stops at the first hit found, for occlusion.
+  closest_hit,  // Each hit shortens the ray for the tests after it.
+};
+
+
+enum class ray_cull : uint32_t
+{
+  back_faces,   // Triangles wound clockwise from the ray are skipped.
+  none,
+};
+
+
+// The hit point is v0 + u * (v1 - v0) + v * (v2 - v0) of the triangle.
+struct ray_hit
+{
+  float    distance;
+  uint32_t triangle;
+  float    u;
+  float    v;
+};
+
+
+/*
+  A ray with its per ray slab test work done once, for testing
+  against many boxes. Bit n of sign is set when axis n points
+  negative, the max plane is then the near one.
+*/
+struct ray_prepared
+{
+  MATH_NS_NAME::vec3      origin;
+  MATH_NS_NAME::vec3      inv_dir;
+  float                   t_min;
+  float                   t_max;
+  uint32_t                sign;
+};
+
+
+/*
+  Four or eight rays as structure of arrays, for coherent queries.
+  Bit n of active is lane n, tests only run the active lanes.
+*/
+struct ray_packet4
+{
+  MATH_NS_NAME::vec3x4   origin;
+  MATH_NS_NAME::vec3x4   dir;
+  MATH_NS_NAME::vec3x4   inv_dir;
+  MATH_NS_NAME::floatx4  t_min;
+  MATH_NS_NAME::floatx4  t_max;
+  uint32_t                active;
+};
+
+
+struct ray_packet8
+{
+  MATH_NS_NAME::vec3x8   origin;
+  MATH_NS_NAME::vec3x8   dir;
+  MATH_NS_NAME::vec3x8   inv_dir;
+  MATH_NS_NAME::floatx8  t_min;
+  MATH_NS_NAME::floatx8  t_max;
+  uint32_t                active;
+};
+
+
+/*
+  32 bytes. Leaves have a count and first is their first triangle,
+  inner nodes have no count and first is the left child, the right
+  child is next to it.
+*/
+struct bvh_node
+{
+  float    min[3];
+  uint32_t first;
+  float    max[3];
+  uint32_t count;
+};
+
+
+struct bvh
+{
+  std::vector<bvh_node> nodes;
+  std::vector<float>    tris;       // The soup in leaf order.
+  std::vector<uint32_t> tri_index;  // Leaf order to soup index.
+};
+
+
+/*
+  Boxes as structure of arrays, for broadphase queries. The arrays are
+  padded to a multiple of 32 with empty boxes that overlap nothing, so
+  queries work a mask word at a time.
+*/
+struct aabb_soa
+{
+  std::vector<float> min[3];
+  std::vector<float> max[3];
+  size_t             count;
+};
+
+
+static_assert(sizeof(ray) == 32 && alignof(ray) == 16, "ray layout differs by ISA level");
+static_assert(sizeof(aabb) == 32 && alignof(aabb) == 16, "aabb layout differs by ISA level");
+static_assert(sizeof(plane) == 32 && alignof(plane) == 16, "plane layout differs by ISA level");
+static_assert(sizeof(ray_hit) == 16, "ray_hit layout changed");
+static_assert(sizeof(ray_prepared) == 48 && alignof(ray_prepared) == 16, "ray_prepared layout differs by ISA level");
+static_assert(sizeof(ray_packet4) == 192 && alignof(ray_packet4) == 16, "ray_packet4 layout differs by ISA level");
+static_assert(sizeof(ray_packet8) == 384 && alignof(ray_packet8) == 32, "ray_packet8 layout differs by ISA level");
+static_assert(sizeof(bvh_node) == 32, "bvh_node layout changed");
+
+
 _MATH_NS_CLOSE
 
 
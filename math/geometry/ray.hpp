@@ -3,7 +3,10 @@
 
 
 #include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
 #include "geometry_types.hpp"
+#include <float.h>
+#include <math.h>
 
 
 _MATH_NS_OPEN
@@ -20,6 +23,7 @@ inline vec3       ray_direction(const ray &ray);
 inline float      ray_test_aabb(const ray &ray, const aabb &target);
 inline bool       ray_test_plane(const ray &ray, const plane &target, float *out_distance = nullptr);
 inline bool       ray_test_triangles(const ray &in_ray, const float tris[], const size_t tri_count, float *out_distance = nullptr);
+inline bool       ray_test_triangles(const ray &in_ray, const float tris[], const size_t tri_count, const ray_query query, const ray_cull cull, ray_hit *out_hit = nullptr); // Hits between start and end.
 inline bool       ray_test_closest_edge(const float tris[], const size_t tri_count, const vec3 point, vec3 &seg_a, vec3 &seg_b);
 
 
@@ -119,71 +123,193 @@ ray_test_plane(const ray &in_ray, const plane &target, float *out_distance)
 }
 
 
-bool
-ray_test_triangles(
-  const ray &in_ray,
-  const float tris[],
-  const size_t tri_count,
-  float *out_distance)
+namespace detail
 {
-  const vec3 r_dir = MATH_NS_NAME::ray_direction(in_ray);
-  
-  for(size_t i = 0; i < tri_count; ++i)
+  /*
+    Slab rule shared by the prepared ray, ray packets and the bvh. The
+    direction's sign picks each axis's near and far plane. A ray running
+    along an axis with its origin on one of that slab's planes gives
+    0 * inf, a NaN, and the compares against the running range are
+    ordered so a NaN drops out and that slab doesn't clip.
+  */
+  inline void
+  ray_slab_clip(const float plane_min, const float plane_max, const float origin, const float inv_dir, float &t_enter, float &t_exit)
   {
-    const size_t tri_index = i * 3 * 3;
-   
-    const vec3 v0 = MATH_NS_NAME::vec3_init_with_array(
-      &tris[tri_index]
-    );
-    
-    const vec3 v1 = MATH_NS_NAME::vec3_subtract(
-      MATH_NS_NAME::vec3_init_with_array(&tris[tri_index + 3]), v0
-    );
-    
-    const vec3 v2 = MATH_NS_NAME::vec3_subtract(
-      MATH_NS_NAME::vec3_init_with_array(&tris[tri_index + 6]), v0
-    );
+    const float near_t = ((inv_dir < 0.f ? plane_max : plane_min) - origin) * inv_dir;
+    const float far_t  = ((inv_dir < 0.f ? plane_min : plane_max) - origin) * inv_dir;
+
+    t_enter = near_t > t_enter ? near_t : t_enter;
+    t_exit  = far_t < t_exit ? far_t : t_exit;
+  }
+
+
+  #ifdef MATH_ON_SSE2
+  /*
+    ray_slab_clip on x, y and z at once. The w lanes of the planes and
+    origin aren't used. Returns true if the ray is in the box for some
+    t in [t_min, t_max], out_enter is where it enters.
+  */
+  inline bool
+  ray_slab_sse(const __m128 plane_min, const __m128 plane_max, const __m128 origin, const __m128 inv_dir, const float t_min, const float t_max, float &out_enter)
+  {
+    const __m128 near_t = _mm_mul_ps(_mm_sub_ps(sse_select_by_sign(inv_dir, plane_max, plane_min), origin), inv_dir);
+    const __m128 far_t  = _mm_mul_ps(_mm_sub_ps(sse_select_by_sign(inv_dir, plane_min, plane_max), origin), inv_dir);
+
+    // max/min give their second operand when either is NaN, the range goes second.
+    const __m128 range_min = _mm_set1_ps(t_min);
+    const __m128 range_max = _mm_set1_ps(t_max);
+
+    __m128 t_enter = sse_blend_w(_mm_max_ps(near_t, range_min), range_min);
+    __m128 t_exit  = sse_blend_w(_mm_min_ps(far_t, range_max), range_max);
+
+    t_enter = _mm_max_ps(t_enter, _mm_shuffle_ps(t_enter, t_enter, _MM_SHUFFLE(2,3,0,1)));
+    t_enter = _mm_max_ps(t_enter, _mm_shuffle_ps(t_enter, t_enter, _MM_SHUFFLE(1,0,3,2)));
+    t_exit  = _mm_min_ps(t_exit, _mm_shuffle_ps(t_exit, t_exit, _MM_SHUFFLE(2,3,0,1)));
+    t_exit  = _mm_min_ps(t_exit, _mm_shuffle_ps(t_exit, t_exit, _MM_SHUFFLE(1,0,3,2)));
+
+    out_enter = _mm_cvtss_f32(t_enter);
+
+    return _mm_comile_ss(t_enter, t_exit) != 0;
+  }
+  #endif
 
-    const vec3 p_vec = MATH_NS_NAME::vec3_cross(r_dir, v2);
+
+  /*
+    Moller-Trumbore against one triangle of a packed soup, only hits
+    with t_min <= t < t_max count. t is checked before v so hits past
+    t_max are dropped early. The hit is v0 + u * (v1 - v0) + v * (v2 - v0).
+  */
+  inline bool
+  ray_test_triangle(const vec3 start, const vec3 dir, const float tri[], const ray_cull cull, const float t_min, const float t_max, float &out_t, float &out_u, float &out_v)
+  {
+    const vec3 v0 = MATH_NS_NAME::vec3_init_with_array(&tri[0]);
+    const vec3 v1 = MATH_NS_NAME::vec3_subtract(MATH_NS_NAME::vec3_init_with_array(&tri[3]), v0);
+    const vec3 v2 = MATH_NS_NAME::vec3_subtract(MATH_NS_NAME::vec3_init_with_array(&tri[6]), v0);
+
+    const vec3 p_vec = MATH_NS_NAME::vec3_cross(dir, v2);
     const float dot  = MATH_NS_NAME::vec3_dot(v1, p_vec);
 
-    if(dot < MATH_NS_NAME::epsilon())
+    // Culling drops back faces and edge on, two sided only edge on.
+    const float facing = cull == ray_cull::back_faces ? dot : MATH_NS_NAME::abs(dot);
+
+    if(facing < MATH_NS_NAME::epsilon())
     {
-      continue;
+      return false;
     }
 
     const float o_dot = 1 / dot;
-    const vec3 t_vec  = MATH_NS_NAME::vec3_subtract(in_ray.start, v0);
+    const vec3 t_vec  = MATH_NS_NAME::vec3_subtract(start, v0);
     const float u     = MATH_NS_NAME::vec3_dot(t_vec, p_vec) * o_dot;
-  
+
     if(!MATH_NS_NAME::is_between(u, 0.f, 1.f))
     {
-      continue;
+      return false;
     }
- 
+
     const vec3 q_vec = MATH_NS_NAME::vec3_cross(t_vec, v1);
-    const float v    = MATH_NS_NAME::vec3_dot(r_dir, q_vec) * o_dot;
-  
+    const float t    = MATH_NS_NAME::vec3_dot(v2, q_vec) * o_dot;
+
+    if(t < t_min || t >= t_max)
+    {
+      return false;
+    }
+
+    const float v = MATH_NS_NAME::vec3_dot(dir, q_vec) * o_dot;
+
     if (v < 0 || u + v > 1)
     {
-      continue;
+      return false;
     }
- 
-    const float t = MATH_NS_NAME::vec3_dot(v2, q_vec) * o_dot;
-  
-    if(out_distance)
+
+    out_t = t;
+    out_u = u;
+    out_v = v;
+
+    return true;
+  }
+
+
+  /*
+    Runs one query over a range of a soup, hit keeps the best so far
+    and its distance is the running t_max. tri_index maps the range
+    back to soup indices, or is null when it is the soup.
+  */
+  inline bool
+  ray_test_triangle_range(const vec3 start, const vec3 dir, const float tris[], const uint32_t tri_index[], const size_t first, const size_t count, const ray_query query, const ray_cull cull, ray_hit &hit)
+  {
+    bool found = false;
+
+    for(size_t i = first; i < first + count; ++i)
     {
-      *out_distance = t;
+      float t, u, v;
+
+      if(ray_test_triangle(start, dir, &tris[i * 3 * 3], cull, 0.f, hit.distance, t, u, v))
+      {
+        hit = ray_hit{t, tri_index ? tri_index[i] : static_cast<uint32_t>(i), u, v};
+        found = true;
+
+        if(query == ray_query::any_hit)
+        {
+          break;
+        }
+      }
     }
+
+    return found;
+  }
+} // ns
+
+
+bool
+ray_test_triangles(
+  const ray &in_ray,
+  const float tris[],
+  const size_t tri_count,
+  float *out_distance)
+{
+  const vec3 r_dir = MATH_NS_NAME::ray_direction(in_ray);
   
-    return true;
-    
+  for(size_t i = 0; i < tri_count; ++i)
+  {
+    float t, u, v;
+
+    if(detail::ray_test_triangle(in_ray.start, r_dir, &tris[i * 3 * 3], ray_cull::back_faces, -FLT_MAX, FLT_MAX, t, u, v))
+    {
+      if(out_distance)
+      {
+        *out_distance = t;
+      }
+
+      return true;
+    }
   }
   
   return false;
 }
 
 
+bool
+ray_test_triangles(const ray &in_ray, const float tris[], const size_t tri_count, const ray_query query, const ray_cull cull, ray_hit *out_hit)
+{
+  const vec3 r_dir = MATH_NS_NAME::ray_direction(in_ray);
+
+  // Just past the end so a hit on it counts.
+  ray_hit hit{nextafterf(MATH_NS_NAME::ray_length(in_ray), FLT_MAX), 0, 0.f, 0.f};
+
+  if(!detail::ray_test_triangle_range(in_ray.start, r_dir, tris, nullptr, 0, tri_count, query, cull, hit))
+  {
+    return false;
+  }
+
+  if(out_hit)
+  {
+    *out_hit = hit;
+  }
+
+  return true;
+}
+
+
 bool
 ray_test_closest_edge(const float tris[], const size_t tri_count, const vec3 point, vec3 &seg_a, vec3 &seg_b)
 {
@@ -0,0 +1,182 @@
+#ifndef RAY_PACKET_INCLUDED_8F4651ED_1DF3_490B_AC7D_03DEB9493398
+#define RAY_PACKET_INCLUDED_8F4651ED_1DF3_490B_AC7D_03DEB9493398
+
+
+/*
+  Ray Packet
+  --
+  Four or eight rays tested together, one lane each, so a coherent
+  bundle costs about one ray per box or triangle. Lanes that miss a
+  box or finish an any hit query drop out of the active mask, a
+  triangle loop stops when none are left.
+  Masks are bit n for lane n, as vec3x4.
+*/
+
+
+#include "../detail/detail.hpp"
+#include "geometry_types.hpp"
+#include "ray.hpp"
+#include "../vec/vec3.hpp"
+#include "../vec/vec3x4.hpp"
+#include "../vec/vec3x8.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <float.h>
+#include <math.h>
+#include <assert.h>
+
+
+_MATH_NS_OPEN
+
+
+// ----------------------------------------------------------- [ Interface ] --
+
+
+// Lanes past count are inactive. Hits are between each ray's start and end.
+inline ray_packet4  ray_packet4_init(const ray rays[], const size_t count = 4);
+inline ray_packet8  ray_packet8_init(const ray rays[], const size_t count = 8);
+
+// Active lanes that hit, out_masks may be null, then the boxes stop once every lane has hit.
+inline uint32_t     ray_packet4_test_aabb(const ray_packet4 &packet, const aabb &box);
+inline uint32_t     ray_packet4_test_aabbs(const ray_packet4 &packet, const aabb boxes[], const size_t box_count, uint32_t out_masks[] = nullptr);
+inline uint32_t     ray_packet8_test_aabb(const ray_packet8 &packet, const aabb &box);
+inline uint32_t     ray_packet8_test_aabbs(const ray_packet8 &packet, const aabb boxes[], const size_t box_count, uint32_t out_masks[] = nullptr);
+
+// As ray_test_triangles with a query, out_hits[n] is written for each lane in the returned mask.
+inline uint32_t     ray_packet4_test_triangles(const ray_packet4 &packet, const float tris[], const size_t tri_count, const ray_query query, const ray_cull cull, ray_hit out_hits[4]);
+inline uint32_t     ray_packet8_test_triangles(const ray_packet8 &packet, const float tris[], const size_t tri_count, const ray_query query, const ray_cull cull, ray_hit out_hits[8]);
+
+
+// ---------------------------------------------------------------- [ Impl ] --
+
+
+ray_packet4
+ray_packet4_init(const ray rays[], const size_t count)
+{
+  assert(count <= 4);
+
+  float origin[12] = {};
+  float dir[12]    = {};
+  float inv_dir[12] = {};
+  float t_max[4]   = {};
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    const vec3 ray_dir = ray_direction(rays[i]);
+
+    vec3_to_array(rays[i].start, &origin[i * 3]);
+    vec3_to_array(ray_dir, &dir[i * 3]);
+    vec3_to_array(vec3_init(1.f / vec3_get_x(ray_dir), 1.f / vec3_get_y(ray_dir), 1.f / vec3_get_z(ray_dir)), &inv_dir[i * 3]);
+
+    // Just past the end so a hit on it counts, as ray_test_triangles.
+    t_max[i] = nextafterf(ray_length(rays[i]), FLT_MAX);
+  }
+
+  return ray_packet4{
+    vec3x4_init_with_xyz_array(origin),
+    vec3x4_init_with_xyz_array(dir),
+    vec3x4_init_with_xyz_array(inv_dir),
+    floatx4_init(0.f),
+    floatx4_init(t_max[0], t_max[1], t_max[2], t_max[3]),
+    (1u << count) - 1
+  };
+}
+
+
+ray_packet8
+ray_packet8_init(const ray rays[], const size_t count)
+{
+  assert(count <= 8);
+
+  const ray_packet4 lo = ray_packet4_init(rays, count < 4 ? count : 4);
+  const ray_packet4 hi = ray_packet4_init(count > 4 ? &rays[4] : rays, count > 4 ? count - 4 : 0);
+
+  return ray_packet8{
+    vec3x8_init(lo.origin, hi.origin),
+    vec3x8_init(lo.dir, hi.dir),
+    vec3x8_init(lo.inv_dir, hi.inv_dir),
+    floatx8_init(lo.t_min, hi.t_min),
+    floatx8_init(lo.t_max, hi.t_max),
+    lo.active | (hi.active << 4)
+  };
+}
+
+
+uint32_t
+ray_packet4_test_aabbs(const ray_packet4 &packet, const aabb boxes[], const size_t box_count, uint32_t out_masks[])
+{
+  const uint32_t active = packet.active & 0xF;
+  uint32_t any_hit = 0;
+
+  for(size_t i = 0; i < box_count; ++i)
+  {
+    const uint32_t mask = ray_packet4_test_aabb(packet, boxes[i]);
+    any_hit |= mask;
+
+    if(out_masks)
+    {
+      out_masks[i] = mask;
+    }
+    else if(any_hit == active)
+    {
+      break;
+    }
+  }
+
+  return any_hit;
+}
+
+
+uint32_t
+ray_packet8_test_aabbs(const ray_packet8 &packet, const aabb boxes[], const size_t box_count, uint32_t out_masks[])
+{
+  const uint32_t active = packet.active & 0xFF;
+  uint32_t any_hit = 0;
+
+  for(size_t i = 0; i < box_count; ++i)
+  {
+    const uint32_t mask = ray_packet8_test_aabb(packet, boxes[i]);
+    any_hit |= mask;
+
+    if(out_masks)
+    {
+      out_masks[i] = mask;
+    }
+    else if(any_hit == active)
+    {
+      break;
+    }
+  }
+
+  return any_hit;
+}
+
+
+_MATH_NS_CLOSE
+
+
+// What impl to use
+
+#ifdef MATH_ON_SSE2
+
+#include "ray_packet4_sse.inl"
+
+#else
+
+#include "ray_packet4_fallback.inl"
+
+#endif // Choose which impl to use.
+
+
+#ifdef MATH_ON_AVX
+
+#include "ray_packet8_avx.inl"
+
+#else
+
+#include "ray_packet8_fallback.inl"
+
+#endif // Choose which impl to use.
+
+
+#endif // inc guard
@@ -0,0 +1,106 @@
+#ifndef RAY_PACKET4_FALLBACK_INCLUDED_A9F526AD_CC2D_41ED_8007_BD0AE612B0B1
+#define RAY_PACKET4_FALLBACK_INCLUDED_A9F526AD_CC2D_41ED_8007_BD0AE612B0B1
+
+
+#include "../detail/detail.hpp"
+#include "geometry_types.hpp"
+#include "ray.hpp"
+
+
+#ifdef MATH_ON_FPU
+
+
+/*
+  Ray Packet 4
+  Fallback impl, each active lane is tested on its own.
+*/
+
+
+_MATH_NS_OPEN
+
+
+uint32_t
+ray_packet4_test_aabb(const ray_packet4 &packet, const aabb &box)
+{
+  const float box_min[3] = {vec3_get_x(box.min), vec3_get_y(box.min), vec3_get_z(box.min)};
+  const float box_max[3] = {vec3_get_x(box.max), vec3_get_y(box.max), vec3_get_z(box.max)};
+
+  uint32_t hit_mask = 0;
+
+  for(uint32_t lane = 0; lane < 4; ++lane)
+  {
+    if(!(packet.active & (1u << lane)))
+    {
+      continue;
+    }
+
+    const float origin[3]  = {packet.origin.x.data[lane], packet.origin.y.data[lane], packet.origin.z.data[lane]};
+    const float inv_dir[3] = {packet.inv_dir.x.data[lane], packet.inv_dir.y.data[lane], packet.inv_dir.z.data[lane]};
+
+    float t_enter = packet.t_min.data[lane];
+    float t_exit  = packet.t_max.data[lane];
+
+    for(uint32_t axis = 0; axis < 3; ++axis)
+    {
+      detail::ray_slab_clip(box_min[axis], box_max[axis], origin[axis], inv_dir[axis], t_enter, t_exit);
+    }
+
+    if(t_enter <= t_exit)
+    {
+      hit_mask |= 1u << lane;
+    }
+  }
+
+  return hit_mask;
+}
+
+
+uint32_t
+ray_packet4_test_triangles(const ray_packet4 &packet, const float tris[], const size_t tri_count, const ray_query query, const ray_cull cull, ray_hit out_hits[4])
+{
+  uint32_t hit_mask = 0;
+
+  for(uint32_t lane = 0; lane < 4; ++lane)
+  {
+    if(!(packet.active & (1u << lane)))
+    {
+      continue;
+    }
+
+    const vec3 origin = vec3_init(packet.origin.x.data[lane], packet.origin.y.data[lane], packet.origin.z.data[lane]);
+    const vec3 dir    = vec3_init(packet.dir.x.data[lane], packet.dir.y.data[lane], packet.dir.z.data[lane]);
+    const float t_min = packet.t_min.data[lane];
+
+    ray_hit hit{packet.t_max.data[lane], 0, 0.f, 0.f};
+
+    for(size_t i = 0; i < tri_count; ++i)
+    {
+      float t, u, v;
+
+      if(detail::ray_test_triangle(origin, dir, &tris[i * 3 * 3], cull, t_min, hit.distance, t, u, v))
+      {
+        hit = ray_hit{t, static_cast<uint32_t>(i), u, v};
+        hit_mask |= 1u << lane;
+
+        if(query == ray_query::any_hit)
+        {
+          break;
+        }
+      }
+    }
+
+    if(hit_mask & (1u << lane))
+    {
+      out_hits[lane] = hit;
+    }
+  }
+
+  return hit_mask;
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // on fpu
+#endif // inc guard
@@ -0,0 +1,188 @@
+#ifndef RAY_PACKET4_SSE_INCLUDED_6EE1AA88_635F_444A_AC64_056D1EC21746
+#define RAY_PACKET4_SSE_INCLUDED_6EE1AA88_635F_444A_AC64_056D1EC21746
+
+
+#include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
+#include "geometry_types.hpp"
+#include "../general/general.hpp"
+
+
+#ifdef MATH_ON_SSE2
+
+
+/*
+  Ray Packet 4
+  SSE impl, a lane per ray. Boxes and triangles are broadcast.
+*/
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  // All bits set in the lanes whose bit is in mask.
+  inline __m128
+  ray_packet4_sse_lane_mask(const uint32_t mask)
+  {
+    const __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+    return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32((int)mask), bits), bits));
+  }
+
+
+  inline __m128
+  ray_packet4_sse_splat(const __m128 vec, const uint32_t i)
+  {
+    switch(i)
+    {
+      case(0): return _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(0,0,0,0));
+      case(1): return _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(1,1,1,1));
+      default: return _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(2,2,2,2));
+    }
+  }
+} // ns
+
+
+uint32_t
+ray_packet4_test_aabb(const ray_packet4 &packet, const aabb &box)
+{
+  const __m128 origin[3]  = {packet.origin.x.simd_vec, packet.origin.y.simd_vec, packet.origin.z.simd_vec};
+  const __m128 inv_dir[3] = {packet.inv_dir.x.simd_vec, packet.inv_dir.y.simd_vec, packet.inv_dir.z.simd_vec};
+
+  __m128 t_enter = packet.t_min.simd_vec;
+  __m128 t_exit  = packet.t_max.simd_vec;
+
+  // The detail::ray_slab_clip rule, the range goes second so NaN slabs drop out.
+  for(uint32_t axis = 0; axis < 3; ++axis)
+  {
+    const __m128 t_lo = _mm_mul_ps(_mm_sub_ps(detail::ray_packet4_sse_splat(box.min.simd_vec, axis), origin[axis]), inv_dir[axis]);
+    const __m128 t_hi = _mm_mul_ps(_mm_sub_ps(detail::ray_packet4_sse_splat(box.max.simd_vec, axis), origin[axis]), inv_dir[axis]);
+
+    t_enter = _mm_max_ps(detail::sse_select_by_sign(inv_dir[axis], t_hi, t_lo), t_enter);
+    t_exit  = _mm_min_ps(detail::sse_select_by_sign(inv_dir[axis], t_lo, t_hi), t_exit);
+  }
+
+  return (uint32_t)_mm_movemask_ps(_mm_cmple_ps(t_enter, t_exit)) & packet.active & 0xF;
+}
+
+
+uint32_t
+ray_packet4_test_triangles(const ray_packet4 &packet, const float tris[], const size_t tri_count, const ray_query query, const ray_cull cull, ray_hit out_hits[4])
+{
+  const __m128 ox = packet.origin.x.simd_vec;
+  const __m128 oy = packet.origin.y.simd_vec;
+  const __m128 oz = packet.origin.z.simd_vec;
+  const __m128 dx = packet.dir.x.simd_vec;
+  const __m128 dy = packet.dir.y.simd_vec;
+  const __m128 dz = packet.dir.z.simd_vec;
+
+  const __m128 t_min   = packet.t_min.simd_vec;
+  const __m128 zero    = _mm_setzero_ps();
+  const __m128 one     = _mm_set1_ps(1.f);
+  const __m128 eps     = _mm_set1_ps(MATH_NS_NAME::epsilon());
+  const __m128 no_sign = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+  // Closest so far per lane, the running t_max.
+  __m128 t_best = packet.t_max.simd_vec;
+  __m128 active = detail::ray_packet4_sse_lane_mask(packet.active & 0xF);
+
+  uint32_t hit_mask = 0;
+
+  for(size_t i = 0; i < tri_count; ++i)
+  {
+    const float *tri = &tris[i * 3 * 3];
+
+    const __m128 v0x = _mm_set1_ps(tri[0]);
+    const __m128 v0y = _mm_set1_ps(tri[1]);
+    const __m128 v0z = _mm_set1_ps(tri[2]);
+    const __m128 e1x = _mm_set1_ps(tri[3] - tri[0]);
+    const __m128 e1y = _mm_set1_ps(tri[4] - tri[1]);
+    const __m128 e1z = _mm_set1_ps(tri[5] - tri[2]);
+    const __m128 e2x = _mm_set1_ps(tri[6] - tri[0]);
+    const __m128 e2y = _mm_set1_ps(tri[7] - tri[1]);
+    const __m128 e2z = _mm_set1_ps(tri[8] - tri[2]);
+
+    // p = dir x e2
+    const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+
+    const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+    const __m128 facing = cull == ray_cull::back_faces ? det : _mm_and_ps(det, no_sign);
+
+    __m128 mask = _mm_and_ps(active, _mm_cmpge_ps(facing, eps));
+
+    if(!_mm_movemask_ps(mask))
+    {
+      continue;
+    }
+
+    const __m128 inv_det = _mm_div_ps(one, det);
+
+    // s = origin - v0
+    const __m128 sx = _mm_sub_ps(ox, v0x);
+    const __m128 sy = _mm_sub_ps(oy, v0y);
+    const __m128 sz = _mm_sub_ps(oz, v0z);
+
+    const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv_det);
+    mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpgt_ps(u, zero), _mm_cmplt_ps(u, one)));
+
+    // q = s x e1
+    const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+    const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv_det);
+    mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(t, t_min), _mm_cmplt_ps(t, t_best)));
+
+    const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv_det);
+    mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+
+    const uint32_t lanes = (uint32_t)_mm_movemask_ps(mask);
+
+    if(!lanes)
+    {
+      continue;
+    }
+
+    t_best = detail::sse_select(mask, t, t_best);
+
+    ALIGN16 float hit_t[4];
+    ALIGN16 float hit_u[4];
+    ALIGN16 float hit_v[4];
+
+    _mm_store_ps(hit_t, t);
+    _mm_store_ps(hit_u, u);
+    _mm_store_ps(hit_v, v);
+
+    for(uint32_t lane = 0; lane < 4; ++lane)
+    {
+      if(lanes & (1u << lane))
+      {
+        out_hits[lane] = ray_hit{hit_t[lane], static_cast<uint32_t>(i), hit_u[lane], hit_v[lane]};
+      }
+    }
+
+    hit_mask |= lanes;
+
+    if(query == ray_query::any_hit)
+    {
+      active = _mm_andnot_ps(mask, active);
+
+      if(!_mm_movemask_ps(active))
+      {
+        break;
+      }
+    }
+  }
+
+  return hit_mask;
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // use sse
+#endif // inc guard
@@ -0,0 +1,187 @@
+#ifndef RAY_PACKET8_AVX_INCLUDED_54982B78_9C69_4027_AD03_AEAEC9C7A8D8
+#define RAY_PACKET8_AVX_INCLUDED_54982B78_9C69_4027_AD03_AEAEC9C7A8D8
+
+
+#include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
+#include "geometry_types.hpp"
+#include "../general/general.hpp"
+#include "ray_packet4_sse.inl"
+
+
+#ifdef MATH_ON_AVX
+
+
+/*
+  Ray Packet 8
+  AVX impl, a lane per ray. Boxes and triangles are broadcast.
+*/
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  // All bits set in the lanes whose bit is in mask.
+  inline __m256
+  ray_packet8_avx_lane_mask(const uint32_t mask)
+  {
+    const __m128 lo = ray_packet4_sse_lane_mask(mask & 0xF);
+    const __m128 hi = ray_packet4_sse_lane_mask((mask >> 4) & 0xF);
+
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+  }
+
+
+  inline __m256
+  ray_packet8_avx_splat(const __m128 vec, const uint32_t i)
+  {
+    const __m128 lane = ray_packet4_sse_splat(vec, i);
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lane), lane, 1);
+  }
+} // ns
+
+
+uint32_t
+ray_packet8_test_aabb(const ray_packet8 &packet, const aabb &box)
+{
+  const __m256 origin[3]  = {packet.origin.x.simd_vec, packet.origin.y.simd_vec, packet.origin.z.simd_vec};
+  const __m256 inv_dir[3] = {packet.inv_dir.x.simd_vec, packet.inv_dir.y.simd_vec, packet.inv_dir.z.simd_vec};
+
+  __m256 t_enter = packet.t_min.simd_vec;
+  __m256 t_exit  = packet.t_max.simd_vec;
+
+  // The detail::ray_slab_clip rule, the range goes second so NaN slabs drop out.
+  for(uint32_t axis = 0; axis < 3; ++axis)
+  {
+    const __m256 t_lo = _mm256_mul_ps(_mm256_sub_ps(detail::ray_packet8_avx_splat(box.min.simd_vec, axis), origin[axis]), inv_dir[axis]);
+    const __m256 t_hi = _mm256_mul_ps(_mm256_sub_ps(detail::ray_packet8_avx_splat(box.max.simd_vec, axis), origin[axis]), inv_dir[axis]);
+
+    t_enter = _mm256_max_ps(detail::avx_select_by_sign(inv_dir[axis], t_hi, t_lo), t_enter);
+    t_exit  = _mm256_min_ps(detail::avx_select_by_sign(inv_dir[axis], t_lo, t_hi), t_exit);
+  }
+
+  return (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(t_enter, t_exit, _CMP_LE_OQ)) & packet.active & 0xFF;
+}
+
+
+uint32_t
+ray_packet8_test_triangles(const ray_packet8 &packet, const float tris[], const size_t tri_count, const ray_query query, const ray_cull cull, ray_hit out_hits[8])
+{
+  const __m256 ox = packet.origin.x.simd_vec;
+  const __m256 oy = packet.origin.y.simd_vec;
+  const __m256 oz = packet.origin.z.simd_vec;
+  const __m256 dx = packet.dir.x.simd_vec;
+  const __m256 dy = packet.dir.y.simd_vec;
+  const __m256 dz = packet.dir.z.simd_vec;
+
+  const __m256 t_min   = packet.t_min.simd_vec;
+  const __m256 zero    = _mm256_setzero_ps();
+  const __m256 one     = _mm256_set1_ps(1.f);
+  const __m256 eps     = _mm256_set1_ps(MATH_NS_NAME::epsilon());
+  const __m256 no_sign = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+  // Closest so far per lane, the running t_max.
+  __m256 t_best = packet.t_max.simd_vec;
+  __m256 active = detail::ray_packet8_avx_lane_mask(packet.active & 0xFF);
+
+  uint32_t hit_mask = 0;
+
+  for(size_t i = 0; i < tri_count; ++i)
+  {
+    const float *tri = &tris[i * 3 * 3];
+
+    const __m256 v0x = _mm256_set1_ps(tri[0]);
+    const __m256 v0y = _mm256_set1_ps(tri[1]);
+    const __m256 v0z = _mm256_set1_ps(tri[2]);
+    const __m256 e1x = _mm256_set1_ps(tri[3] - tri[0]);
+    const __m256 e1y = _mm256_set1_ps(tri[4] - tri[1]);
+    const __m256 e1z = _mm256_set1_ps(tri[5] - tri[2]);
+    const __m256 e2x = _mm256_set1_ps(tri[6] - tri[0]);
+    const __m256 e2y = _mm256_set1_ps(tri[7] - tri[1]);
+    const __m256 e2z = _mm256_set1_ps(tri[8] - tri[2]);
+
+    // p = dir x e2
+    const __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+    const __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+    const __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+
+    const __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+    const __m256 facing = cull == ray_cull::back_faces ? det : _mm256_and_ps(det, no_sign);
+
+    __m256 mask = _mm256_and_ps(active, _mm256_cmp_ps(facing, eps, _CMP_GE_OQ));
+
+    if(!_mm256_movemask_ps(mask))
+    {
+      continue;
+    }
+
+    const __m256 inv_det = _mm256_div_ps(one, det);
+
+    // s = origin - v0
+    const __m256 sx = _mm256_sub_ps(ox, v0x);
+    const __m256 sy = _mm256_sub_ps(oy, v0y);
+    const __m256 sz = _mm256_sub_ps(oz, v0z);
+
+    const __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)), inv_det);
+    mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GT_OQ), _mm256_cmp_ps(u, one, _CMP_LT_OQ)));
+
+    // q = s x e1
+    const __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+    const __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+    const __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+
+    const __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)), inv_det);
+    mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(t, t_min, _CMP_GE_OQ), _mm256_cmp_ps(t, t_best, _CMP_LT_OQ)));
+
+    const __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)), inv_det);
+    mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+
+    const uint32_t lanes = (uint32_t)_mm256_movemask_ps(mask);
+
+    if(!lanes)
+    {
+      continue;
+    }
+
+    t_best = _mm256_blendv_ps(t_best, t, mask);
+
+    float hit_t[8];
+    float hit_u[8];
+    float hit_v[8];
+
+    _mm256_storeu_ps(hit_t, t);
+    _mm256_storeu_ps(hit_u, u);
+    _mm256_storeu_ps(hit_v, v);
+
+    for(uint32_t lane = 0; lane < 8; ++lane)
+    {
+      if(lanes & (1u << lane))
+      {
+        out_hits[lane] = ray_hit{hit_t[lane], static_cast<uint32_t>(i), hit_u[lane], hit_v[lane]};
+      }
+    }
+
+    hit_mask |= lanes;
+
+    if(query == ray_query::any_hit)
+    {
+      active = _mm256_andnot_ps(mask, active);
+
+      if(!_mm256_movemask_ps(active))
+      {
+        break;
+      }
+    }
+  }
+
+  return hit_mask;
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // use avx
+#endif // inc guard
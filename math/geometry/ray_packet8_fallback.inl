@@ -0,0 +1,64 @@
+#ifndef RAY_PACKET8_FALLBACK_INCLUDED_CF59E11F_D1AB_4CC6_A11D_264DE7E99DD9
+#define RAY_PACKET8_FALLBACK_INCLUDED_CF59E11F_D1AB_4CC6_A11D_264DE7E99DD9
+
+
+#include "../detail/detail.hpp"
+#include "geometry_types.hpp"
+#include "../vec/vec3x8.hpp"
+
+
+#ifndef MATH_ON_AVX
+
+
+/*
+  Ray Packet 8
+  Fallback impl, each half goes through ray_packet4 so
+  SSE still gets used without AVX.
+*/
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  inline ray_packet4
+  ray_packet8_get_half(const ray_packet8 &packet, const uint32_t half)
+  {
+    return ray_packet4{
+      vec3x8_get_half(packet.origin, half),
+      vec3x8_get_half(packet.dir, half),
+      vec3x8_get_half(packet.inv_dir, half),
+      packet.t_min.half[half],
+      packet.t_max.half[half],
+      (packet.active >> (half * 4)) & 0xF
+    };
+  }
+} // ns
+
+
+uint32_t
+ray_packet8_test_aabb(const ray_packet8 &packet, const aabb &box)
+{
+  const uint32_t lo = ray_packet4_test_aabb(detail::ray_packet8_get_half(packet, 0), box);
+  const uint32_t hi = ray_packet4_test_aabb(detail::ray_packet8_get_half(packet, 1), box);
+
+  return lo | (hi << 4);
+}
+
+
+uint32_t
+ray_packet8_test_triangles(const ray_packet8 &packet, const float tris[], const size_t tri_count, const ray_query query, const ray_cull cull, ray_hit out_hits[8])
+{
+  const uint32_t lo = ray_packet4_test_triangles(detail::ray_packet8_get_half(packet, 0), tris, tri_count, query, cull, &out_hits[0]);
+  const uint32_t hi = ray_packet4_test_triangles(detail::ray_packet8_get_half(packet, 1), tris, tri_count, query, cull, &out_hits[4]);
+
+  return lo | (hi << 4);
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // no avx
+#endif // inc guard
@@ -0,0 +1,147 @@
+#ifndef RAY_PREPARED_INCLUDED_CBAED74C_DF32_4602_AA06_77106E27881A
+#define RAY_PREPARED_INCLUDED_CBAED74C_DF32_4602_AA06_77106E27881A
+
+
+/*
+  Prepared Ray
+  --
+  ray_test_aabb normalizes the direction and divides on every call.
+  A prepared ray does that once, so each box after is a few subtracts,
+  multiplies and min/max with no branches. The slabs follow the same
+  rule as the BVH and ray packets, so they agree on rays in a face plane.
+*/
+
+
+#include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
+#include "geometry_types.hpp"
+#include "ray.hpp"
+#include "../vec/vec3.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+
+_MATH_NS_OPEN
+
+
+// ----------------------------------------------------------- [ Interface ] --
+
+
+inline ray_prepared   ray_prepared_init(const ray &in_ray); // Hits between start and end.
+
+inline bool           ray_prepared_test_aabb(const ray_prepared &ray, const aabb &box, float *out_distance = nullptr);
+
+// Returns the number of boxes hit. out_hit_mask has a bit per box, (box_count + 31) / 32 words. out_hit_index lists the boxes hit in order, it needs room for box_count. Both may be null.
+inline size_t         ray_prepared_test_aabbs(const ray_prepared &ray, const aabb boxes[], const size_t box_count, uint32_t out_hit_mask[], uint32_t out_hit_index[] = nullptr);
+
+
+// ---------------------------------------------------------------- [ Impl ] --
+
+
+ray_prepared
+ray_prepared_init(const ray &in_ray)
+{
+  const vec3 dir = ray_direction(in_ray);
+
+  const vec3 inv = vec3_init(1.f / vec3_get_x(dir), 1.f / vec3_get_y(dir), 1.f / vec3_get_z(dir));
+
+  // Axis aligned rays get infinite inverses, and an origin on a slab
+  // plane gives 0 * inf. The sign is taken from the inverse so -0 picks
+  // the right plane, and the NaN slab drops out as detail::ray_slab_clip.
+  return ray_prepared{
+    in_ray.start,
+    inv,
+    0.f,
+    ray_length(in_ray),
+    (vec3_get_x(inv) < 0.f ? 1u : 0u) | (vec3_get_y(inv) < 0.f ? 2u : 0u) | (vec3_get_z(inv) < 0.f ? 4u : 0u)
+  };
+}
+
+
+bool
+ray_prepared_test_aabb(const ray_prepared &ray, const aabb &box, float *out_distance)
+{
+  #ifdef MATH_ON_SSE2
+  float t_enter;
+  const bool hit = detail::ray_slab_sse(box.min.simd_vec, box.max.simd_vec, ray.origin.simd_vec, ray.inv_dir.simd_vec, ray.t_min, ray.t_max, t_enter);
+
+  if(out_distance)
+  {
+    *out_distance = t_enter;
+  }
+  #else
+  const float origin[3] = {vec3_get_x(ray.origin), vec3_get_y(ray.origin), vec3_get_z(ray.origin)};
+  const float inv[3]    = {vec3_get_x(ray.inv_dir), vec3_get_y(ray.inv_dir), vec3_get_z(ray.inv_dir)};
+
+  const float planes[2][3] = {
+    {vec3_get_x(box.min), vec3_get_y(box.min), vec3_get_z(box.min)},
+    {vec3_get_x(box.max), vec3_get_y(box.max), vec3_get_z(box.max)},
+  };
+
+  float t_enter = ray.t_min;
+  float t_exit  = ray.t_max;
+
+  for(uint32_t axis = 0; axis < 3; ++axis)
+  {
+    // The sign picks which plane is near, so no min/max of the pair. A NaN
+    // slab fails both compares and drops out, as detail::ray_slab_clip.
+    const uint32_t flip = (ray.sign >> axis) & 1u;
+
+    const float near_t = (planes[flip][axis] - origin[axis]) * inv[axis];
+    const float far_t  = (planes[flip ^ 1u][axis] - origin[axis]) * inv[axis];
+
+    t_enter = near_t > t_enter ? near_t : t_enter;
+    t_exit  = far_t < t_exit ? far_t : t_exit;
+  }
+
+  const bool hit = t_enter <= t_exit;
+
+  if(out_distance)
+  {
+    *out_distance = t_enter;
+  }
+  #endif
+
+  return hit;
+}
+
+
+size_t
+ray_prepared_test_aabbs(const ray_prepared &ray, const aabb boxes[], const size_t box_count, uint32_t out_hit_mask[], uint32_t out_hit_index[])
+{
+  size_t hit_count = 0;
+  uint32_t word = 0;
+
+  for(size_t i = 0; i < box_count; ++i)
+  {
+    const uint32_t hit = ray_prepared_test_aabb(ray, boxes[i]) ? 1u : 0u;
+
+    word |= hit << (i & 31);
+
+    if(out_hit_index)
+    {
+      // Written every time, only kept when the count moves on.
+      out_hit_index[hit_count] = static_cast<uint32_t>(i);
+    }
+
+    hit_count += hit;
+
+    if((i & 31) == 31 || i + 1 == box_count)
+    {
+      if(out_hit_mask)
+      {
+        out_hit_mask[i >> 5] = word;
+      }
+
+      word = 0;
+    }
+  }
+
+  return hit_count;
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // inc guard
@@ -9,6 +9,8 @@
 
 #include "mat_types.hpp"
 #include "mat4.hpp"
+#include "mat4_batch.hpp"
+#include "mat34.hpp"
 #include "mat3.hpp"
 
 
@@ -0,0 +1,113 @@
+#ifndef MATRIX34_INCLUDED_434A8119_5D6F_4FB9_82DB_6731306A5E5E
+#define MATRIX34_INCLUDED_434A8119_5D6F_4FB9_82DB_6731306A5E5E
+
+
+/*
+  Matrix 34
+  A world matrix without the last column, which is always (0,0,0,1).
+  Stored as the first three columns of the mat4, so each is a register
+  with the translation in w, this is the 3x4 layout shaders take.
+  Row and col arguments are as the mat4 it came from.
+*/
+
+
+#include "../detail/detail.hpp"
+#include "mat_types.hpp"
+#include "mat4.hpp"
+#include "../vec/vec3.hpp"
+#include <assert.h>
+
+
+_MATH_NS_OPEN
+
+
+// Constants
+MATH_MAT34_INLINE mat34                      mat34_id();
+
+// Init
+MATH_MAT34_INLINE mat34                      mat34_init(); // will return an id matrix
+MATH_MAT34_INLINE mat34                      mat34_init_with_array(const float arr[]); // 12 floats, as mat34_to_array
+MATH_MAT34_INLINE mat34                      mat34_init_with_mat4(const mat4 &mat); // Last column is dropped.
+
+// Operations
+MATH_MAT34_INLINE mat34                      mat34_multiply(const mat34 &lhs, const mat34 &rhs); // As mat4_multiply.
+MATH_MAT34_INLINE vec3                       mat34_transform_point(const mat34 &mat, const vec3 point);
+MATH_MAT34_INLINE vec3                       mat34_transform_direction(const mat34 &mat, const vec3 dir);
+
+// Transform matrices into other forms
+MATH_MAT34_INLINE mat34                      mat34_get_inverse(const mat34 &mat);
+MATH_MAT34_INLINE mat4                       mat34_to_mat4(const mat34 &mat);
+
+// Get/Set information
+MATH_MAT34_INLINE float                      mat34_get(const mat34 &mat, const uint32_t row, const uint32_t col);
+MATH_MAT34_INLINE vec3                       mat34_get_position(const mat34 &mat);
+
+MATH_MAT34_INLINE void                       mat34_to_array(const mat34 &mat, float *array); // Column by column.
+
+
+// Impl
+
+
+mat34
+mat34_id()
+{
+  const float id_array[12] = {
+    1.f, 0.f, 0.f, 0.f,
+    0.f, 1.f, 0.f, 0.f,
+    0.f, 0.f, 1.f, 0.f,
+  };
+
+  return mat34_init_with_array(id_array);
+}
+
+
+mat34
+mat34_init()
+{
+  return mat34_id();
+}
+
+
+float
+mat34_get(const mat34 &mat, const uint32_t row, const uint32_t col)
+{
+  assert(row < 4 && col < 4);
+
+  if(col == 3)
+  {
+    return row == 3 ? 1.f : 0.f;
+  }
+
+  const detail::internal_mat34 *internal_mat = reinterpret_cast<const detail::internal_mat34*>(&mat);
+
+  return internal_mat->data[(col * 4) + row];
+}
+
+
+vec3
+mat34_get_position(const mat34 &mat)
+{
+  return vec3_init(mat34_get(mat, 3, 0), mat34_get(mat, 3, 1), mat34_get(mat, 3, 2));
+}
+
+
+_MATH_NS_CLOSE
+
+
+/*
+  Include the correct impl
+*/
+
+
+#ifdef MATH_ON_SSE2
+
+#include "mat34_sse.inl"
+
+#else
+
+#include "mat34_fallback.inl"
+
+#endif // impl choice
+
+
+#endif // include guard
@@ -0,0 +1,198 @@
+#ifndef MAT34_FALLBACK_INLINE_INCLUDED_728C5A95_0A6F_453D_BB43_3C91E3F37E39
+#define MAT34_FALLBACK_INLINE_INCLUDED_728C5A95_0A6F_453D_BB43_3C91E3F37E39
+
+
+#include "../detail/detail.hpp"
+#include "mat_types.hpp"
+#include "../vec/vec3.hpp"
+#include <assert.h>
+
+
+#ifdef MATH_ON_FPU
+
+
+/*
+  Matrix 34
+  3x4 matrix fallback impl.
+  data[(col * 4) + row] is the mat4's (row, col).
+*/
+
+
+_MATH_NS_OPEN
+
+
+mat34
+mat34_init_with_array(const float arr[])
+{
+  mat34 return_mat;
+  detail::internal_mat34 *internal_mat = reinterpret_cast<detail::internal_mat34*>(&return_mat);
+
+  for(uint32_t i = 0; i < 12; ++i)
+  {
+    internal_mat->data[i] = arr[i];
+  }
+
+  return return_mat;
+}
+
+
+mat34
+mat34_init_with_mat4(const mat4 &mat)
+{
+  mat34 return_mat;
+  detail::internal_mat34 *internal_mat = reinterpret_cast<detail::internal_mat34*>(&return_mat);
+
+  for(uint32_t col = 0; col < 3; ++col)
+  {
+    for(uint32_t row = 0; row < 4; ++row)
+    {
+      internal_mat->data[(col * 4) + row] = mat4_get(mat, row, col);
+    }
+  }
+
+  return return_mat;
+}
+
+
+mat34
+mat34_multiply(const mat34 &lhs, const mat34 &rhs)
+{
+  const detail::internal_mat34 *left  = reinterpret_cast<const detail::internal_mat34*>(&lhs);
+  const detail::internal_mat34 *right = reinterpret_cast<const detail::internal_mat34*>(&rhs);
+
+  mat34 return_mat;
+  detail::internal_mat34 *internal_mat = reinterpret_cast<detail::internal_mat34*>(&return_mat);
+
+  // The implied (0,0,0,1) column of lhs only adds rhs's translation.
+  for(uint32_t col = 0; col < 3; ++col)
+  {
+    const float *right_col = &right->data[col * 4];
+
+    for(uint32_t row = 0; row < 4; ++row)
+    {
+      internal_mat->data[(col * 4) + row] =
+        (left->data[row] * right_col[0]) +
+        (left->data[4 + row] * right_col[1]) +
+        (left->data[8 + row] * right_col[2]) +
+        (row == 3 ? right_col[3] : 0.f);
+    }
+  }
+
+  return return_mat;
+}
+
+
+vec3
+mat34_transform_point(const mat34 &mat, const vec3 point)
+{
+  const detail::internal_mat34 *internal_mat = reinterpret_cast<const detail::internal_mat34*>(&mat);
+  const float *d = internal_mat->data;
+
+  const float x = vec3_get_x(point);
+  const float y = vec3_get_y(point);
+  const float z = vec3_get_z(point);
+
+  return vec3_init(
+    (d[0] * x) + (d[1] * y) + (d[2]  * z) + d[3],
+    (d[4] * x) + (d[5] * y) + (d[6]  * z) + d[7],
+    (d[8] * x) + (d[9] * y) + (d[10] * z) + d[11]
+  );
+}
+
+
+vec3
+mat34_transform_direction(const mat34 &mat, const vec3 dir)
+{
+  const detail::internal_mat34 *internal_mat = reinterpret_cast<const detail::internal_mat34*>(&mat);
+  const float *d = internal_mat->data;
+
+  const float x = vec3_get_x(dir);
+  const float y = vec3_get_y(dir);
+  const float z = vec3_get_z(dir);
+
+  return vec3_init(
+    (d[0] * x) + (d[1] * y) + (d[2]  * z),
+    (d[4] * x) + (d[5] * y) + (d[6]  * z),
+    (d[8] * x) + (d[9] * y) + (d[10] * z)
+  );
+}
+
+
+mat34
+mat34_get_inverse(const mat34 &mat)
+{
+  const detail::internal_mat34 *to_i = reinterpret_cast<const detail::internal_mat34*>(&mat);
+
+  const vec3 col_0 = vec3_init(to_i->data[0], to_i->data[1], to_i->data[2]);
+  const vec3 col_1 = vec3_init(to_i->data[4], to_i->data[5], to_i->data[6]);
+  const vec3 col_2 = vec3_init(to_i->data[8], to_i->data[9], to_i->data[10]);
+
+  // Rows of the 3x3 inverse are crosses of its columns over the determinant.
+  const vec3 row_0 = vec3_cross(col_1, col_2);
+  const vec3 row_1 = vec3_cross(col_2, col_0);
+  const vec3 row_2 = vec3_cross(col_0, col_1);
+
+  const float det = vec3_dot(col_0, row_0);
+  assert(det != 0);
+
+  float rows[9];
+  vec3_to_array(vec3_scale(row_0, 1.f / det), &rows[0]);
+  vec3_to_array(vec3_scale(row_1, 1.f / det), &rows[3]);
+  vec3_to_array(vec3_scale(row_2, 1.f / det), &rows[6]);
+
+  // Translation is -position * inverse 3x3, position is the columns' w.
+  const float position[3] = {to_i->data[3], to_i->data[7], to_i->data[11]};
+
+  mat34 return_mat;
+  detail::internal_mat34 *internal_mat = reinterpret_cast<detail::internal_mat34*>(&return_mat);
+
+  for(uint32_t col = 0; col < 3; ++col)
+  {
+    internal_mat->data[(col * 4) + 0] = rows[col];
+    internal_mat->data[(col * 4) + 1] = rows[3 + col];
+    internal_mat->data[(col * 4) + 2] = rows[6 + col];
+    internal_mat->data[(col * 4) + 3] = -((position[0] * rows[col]) + (position[1] * rows[3 + col]) + (position[2] * rows[6 + col]));
+  }
+
+  return return_mat;
+}
+
+
+mat4
+mat34_to_mat4(const mat34 &mat)
+{
+  const detail::internal_mat34 *from = reinterpret_cast<const detail::internal_mat34*>(&mat);
+
+  float mat_data[16];
+
+  for(uint32_t row = 0; row < 4; ++row)
+  {
+    for(uint32_t col = 0; col < 3; ++col)
+    {
+      mat_data[(row * 4) + col] = from->data[(col * 4) + row];
+    }
+
+    mat_data[(row * 4) + 3] = row == 3 ? 1.f : 0.f;
+  }
+
+  return mat4_init_with_array(mat_data);
+}
+
+
+void
+mat34_to_array(const mat34 &mat, float *array)
+{
+  const detail::internal_mat34 *internal_mat = reinterpret_cast<const detail::internal_mat34*>(&mat);
+
+  for(uint32_t i = 0; i < 12; ++i)
+  {
+    array[i] = internal_mat->data[i];
+  }
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // on fpu
+#endif // inc guard
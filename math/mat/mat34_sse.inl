@@ -0,0 +1,215 @@
+#ifndef MAT34_SSE_INLINE_INCLUDED_B08FD58C_8408_4DCC_9873_A907CE3235B6
+#define MAT34_SSE_INLINE_INCLUDED_B08FD58C_8408_4DCC_9873_A907CE3235B6
+
+
+#include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
+#include "mat_types.hpp"
+#include "../vec/vec3.hpp"
+#include <assert.h>
+
+
+#ifdef MATH_ON_SSE2
+
+
+/*
+  Matrix 34
+  3x4 matrix sse impl.
+  Each column lives in its own register.
+*/
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  // Row vector * matrix, vec's w is 1 for points and 0 for directions.
+  inline __m128
+  mat34_sse_transform(const internal_mat34 *mat, const __m128 vec)
+  {
+    __m128 x = _mm_mul_ps(mat->simd_vec[0], vec);
+    __m128 y = _mm_mul_ps(mat->simd_vec[1], vec);
+    __m128 z = _mm_mul_ps(mat->simd_vec[2], vec);
+    __m128 w = _mm_setzero_ps();
+
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+
+    return _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, w));
+  }
+} // ns
+
+
+mat34
+mat34_init_with_array(const float arr[])
+{
+  mat34 return_mat;
+  detail::internal_mat34 *internal_mat = reinterpret_cast<detail::internal_mat34*>(&return_mat);
+
+  internal_mat->simd_vec[0] = _mm_loadu_ps(&arr[0]);
+  internal_mat->simd_vec[1] = _mm_loadu_ps(&arr[4]);
+  internal_mat->simd_vec[2] = _mm_loadu_ps(&arr[8]);
+
+  return return_mat;
+}
+
+
+mat34
+mat34_init_with_mat4(const mat4 &mat)
+{
+  const detail::internal_mat4 *from = reinterpret_cast<const detail::internal_mat4*>(&mat);
+
+  __m128 row_0 = from->simd_vec[0];
+  __m128 row_1 = from->simd_vec[1];
+  __m128 row_2 = from->simd_vec[2];
+  __m128 row_3 = from->simd_vec[3];
+
+  _MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+
+  mat34 return_mat;
+  detail::internal_mat34 *internal_mat = reinterpret_cast<detail::internal_mat34*>(&return_mat);
+
+  internal_mat->simd_vec[0] = row_0;
+  internal_mat->simd_vec[1] = row_1;
+  internal_mat->simd_vec[2] = row_2;
+
+  return return_mat;
+}
+
+
+mat34
+mat34_multiply(const mat34 &lhs, const mat34 &rhs)
+{
+  const detail::internal_mat34 *left  = reinterpret_cast<const detail::internal_mat34*>(&lhs);
+  const detail::internal_mat34 *right = reinterpret_cast<const detail::internal_mat34*>(&rhs);
+
+  mat34 return_mat;
+  detail::internal_mat34 *internal_mat = reinterpret_cast<detail::internal_mat34*>(&return_mat);
+
+  const __m128 w_mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+  /*
+    Each column of the result is the lhs columns weighted by the rhs
+    column, the implied (0,0,0,1) column of lhs only adds rhs's w.
+    Nine register multiplies, 36 floats against mat4's 64.
+  */
+  for(uint32_t col = 0; col < 3; ++col)
+  {
+    const __m128 right_col = right->simd_vec[col];
+
+    const __m128 x = _mm_shuffle_ps(right_col, right_col, _MM_SHUFFLE(0,0,0,0));
+    const __m128 y = _mm_shuffle_ps(right_col, right_col, _MM_SHUFFLE(1,1,1,1));
+    const __m128 z = _mm_shuffle_ps(right_col, right_col, _MM_SHUFFLE(2,2,2,2));
+
+    __m128 result = _mm_and_ps(right_col, w_mask);
+    result = detail::sse_multiply_add(x, left->simd_vec[0], result);
+    result = detail::sse_multiply_add(y, left->simd_vec[1], result);
+    result = detail::sse_multiply_add(z, left->simd_vec[2], result);
+
+    internal_mat->simd_vec[col] = result;
+  }
+
+  return return_mat;
+}
+
+
+vec3
+mat34_transform_point(const mat34 &mat, const vec3 point)
+{
+  const detail::internal_mat34 *internal_mat = reinterpret_cast<const detail::internal_mat34*>(&mat);
+
+  return vec3{{detail::mat34_sse_transform(internal_mat, detail::sse_blend_w(point.simd_vec, _mm_set1_ps(1.f)))}};
+}
+
+
+vec3
+mat34_transform_direction(const mat34 &mat, const vec3 dir)
+{
+  const detail::internal_mat34 *internal_mat = reinterpret_cast<const detail::internal_mat34*>(&mat);
+
+  return vec3{{detail::mat34_sse_transform(internal_mat, detail::sse_blend_w(dir.simd_vec, _mm_setzero_ps()))}};
+}
+
+
+mat34
+mat34_get_inverse(const mat34 &mat)
+{
+  const detail::internal_mat34 *to_i = reinterpret_cast<const detail::internal_mat34*>(&mat);
+
+  const __m128 col_0 = to_i->simd_vec[0];
+  const __m128 col_1 = to_i->simd_vec[1];
+  const __m128 col_2 = to_i->simd_vec[2];
+
+  // Rows of the 3x3 inverse are crosses of its columns over the determinant.
+  __m128 row_0 = detail::sse_cross(col_1, col_2);
+  __m128 row_1 = detail::sse_cross(col_2, col_0);
+  __m128 row_2 = detail::sse_cross(col_0, col_1);
+
+  const float det = _mm_cvtss_f32(detail::sse_dot3(col_0, row_0));
+  assert(det != 0);
+
+  const __m128 one_over_det = _mm_set1_ps(1.f / det);
+
+  row_0 = _mm_mul_ps(row_0, one_over_det);
+  row_1 = _mm_mul_ps(row_1, one_over_det);
+  row_2 = _mm_mul_ps(row_2, one_over_det);
+
+  // Translation is -position * inverse 3x3, position is the columns' w.
+  __m128 row_3 = _mm_mul_ps(_mm_shuffle_ps(col_0, col_0, _MM_SHUFFLE(3,3,3,3)), row_0);
+  row_3 = detail::sse_multiply_add(_mm_shuffle_ps(col_1, col_1, _MM_SHUFFLE(3,3,3,3)), row_1, row_3);
+  row_3 = detail::sse_multiply_add(_mm_shuffle_ps(col_2, col_2, _MM_SHUFFLE(3,3,3,3)), row_2, row_3);
+  row_3 = _mm_sub_ps(_mm_setzero_ps(), row_3);
+
+  _MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+
+  mat34 return_mat;
+  detail::internal_mat34 *internal_mat = reinterpret_cast<detail::internal_mat34*>(&return_mat);
+
+  internal_mat->simd_vec[0] = row_0;
+  internal_mat->simd_vec[1] = row_1;
+  internal_mat->simd_vec[2] = row_2;
+
+  return return_mat;
+}
+
+
+mat4
+mat34_to_mat4(const mat34 &mat)
+{
+  const detail::internal_mat34 *from = reinterpret_cast<const detail::internal_mat34*>(&mat);
+
+  __m128 row_0 = from->simd_vec[0];
+  __m128 row_1 = from->simd_vec[1];
+  __m128 row_2 = from->simd_vec[2];
+  __m128 row_3 = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+
+  _MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  internal_mat->simd_vec[0] = row_0;
+  internal_mat->simd_vec[1] = row_1;
+  internal_mat->simd_vec[2] = row_2;
+  internal_mat->simd_vec[3] = row_3;
+
+  return return_mat;
+}
+
+
+void
+mat34_to_array(const mat34 &mat, float *array)
+{
+  const detail::internal_mat34 *internal_mat = reinterpret_cast<const detail::internal_mat34*>(&mat);
+
+  _mm_storeu_ps(&array[0], internal_mat->simd_vec[0]);
+  _mm_storeu_ps(&array[4], internal_mat->simd_vec[1]);
+  _mm_storeu_ps(&array[8], internal_mat->simd_vec[2]);
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // use sse
+#endif // inc guard
@@ -50,6 +50,7 @@ MATH_MAT4_INLINE mat4                       mat4_multiply(const mat4 &one, const
 // Transform matrices into other forms
 MATH_MAT4_INLINE mat4                       mat4_get_transpose(const mat4 &a);
 MATH_MAT4_INLINE mat4                       mat4_get_inverse(const mat4 &a);
+MATH_MAT4_INLINE mat4                       mat4_get_inverse_affine(const mat4 &a); //!< Only for rotation, axis scale and translation (no shear/projection).
 MATH_MAT4_INLINE float                      mat4_get_determinant(const mat4 &a);
 MATH_MAT4_INLINE mat4                       mat4_get_scale(const mat4 &a, const vec3 scale);
 
@@ -67,15 +68,6 @@ MATH_MAT4_INLINE void                       mat4_to_array(const mat4 &m, float *
 
 // Impl
 
-namespace detail
-{
-  struct internal_mat4
-  {
-    float data[16];
-  };
-
-}
-
 
 mat4
 mat4_id()
@@ -252,43 +244,6 @@ mat4_orthographic(const float width, const float height, const float near_plane,
 }
 
 
-// Operations
-mat4
-mat4_add(const mat4 &lhs, const mat4 &rhs)
-{
-  const detail::internal_mat4 *left = reinterpret_cast<const detail::internal_mat4*>(&lhs);
-  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
-
-  mat4 return_mat; 
-  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
-
-  for(int i = 0; i < 16; ++i)
-  {
-    internal_mat->data[i] = left->data[0] + right->data[0];
-  }
-
-  return return_mat;
-}
-
-
-mat4
-mat4_subtract(const mat4 &lhs, const mat4 &rhs)
-{
-  const detail::internal_mat4 *left = reinterpret_cast<const detail::internal_mat4*>(&lhs);
-  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
-
-  mat4 return_mat; 
-  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
-
-  for(uint32_t i = 0; i < 16; ++i)
-  {
-    internal_mat->data[i] = left->data[0] - right->data[0];
-  }
-
-  return return_mat;
-}
-
-
 mat4
 mat4_scale(const vec3 scale_vec)
 {
@@ -310,228 +265,6 @@ mat4_scale(const float x, const float y, const float z)
 }
 
 
-mat4
-mat4_multiply(const float lhs, const mat4 &rhs)
-{
-  mat4 multiply_mat = mat4_init(lhs);
-  
-  return mat4_multiply(multiply_mat, rhs);
-}
-
-
-vec4
-mat4_multiply(const vec4 lhs, const mat4 &rhs)
-{
-  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
-  float result[4];
-
-  for(uint32_t i = 0; i < 4; ++i)
-  {
-    const vec4 dot_vec = vec4_init(right->data[i + 0],
-                                   right->data[i + 4],
-                                   right->data[i + 8],
-                                   right->data[i + 12]);
-
-    result[i] = vec4_dot(lhs, dot_vec);
-  }
-
-  return vec4_init_with_array(result);
-}
-
-
-mat4
-mat4_multiply(const mat4 &one, const mat4 &two, const mat4 &three)
-{
-  return mat4_multiply(mat4_multiply(one, two), three);
-}
-
-
-mat4
-mat4_multiply(const mat4 &lhs, const mat4 &rhs)
-{
-  const detail::internal_mat4 *left  = reinterpret_cast<const detail::internal_mat4*>(&lhs);
-  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
-
-  mat4 return_mat = mat4_id();
-  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
-
-  for(uint32_t i = 0; i < 16; ++i)
-  {
-    // Starting index for data.
-    const uint32_t row = (i / 4) * 4;
-    const uint32_t col = (i % 4);
-
-    const vec4 row_vec = vec4_init(left->data[row + 0],
-                                   left->data[row + 1],
-                                   left->data[row + 2],
-                                   left->data[row + 3]);
-
-    const vec4 col_vec = vec4_init(right->data[col + 0],
-                                   right->data[col + 4],
-                                   right->data[col + 8],
-                                   right->data[col + 12]);
-
-    const float dot = vec4_dot(row_vec, col_vec);
-    
-    internal_mat->data[i] = dot;
-  }
-
-  return return_mat;
-}
-
-
-mat4
-mat4_get_transpose(const mat4 &to_transpose)
-{
-  const detail::internal_mat4 *transpose_data = reinterpret_cast<const detail::internal_mat4*>(&to_transpose);
-  
-  const float mat_transpose[16]
-  {
-    transpose_data->data[0],  transpose_data->data[4],  transpose_data->data[8],  transpose_data->data[12],
-    transpose_data->data[1],  transpose_data->data[5],  transpose_data->data[9],  transpose_data->data[13],
-    transpose_data->data[2],  transpose_data->data[6],  transpose_data->data[10], transpose_data->data[14],
-    transpose_data->data[3],  transpose_data->data[7],  transpose_data->data[11], transpose_data->data[15],
-  };
-  
-  return mat4_init_with_array(mat_transpose);
-}
-
-
-mat4
-mat4_get_inverse(const mat4 &to_inverse)
-{
-  const detail::internal_mat4 *to_i = reinterpret_cast<const detail::internal_mat4*>(&to_inverse);
-  
-  float inverse[16]
-  {
-    to_i->data[5]  * to_i->data[10] * to_i->data[15] -
-    to_i->data[5]  * to_i->data[11] * to_i->data[14] -
-    to_i->data[9]  * to_i->data[6]  * to_i->data[15] + 
-    to_i->data[9]  * to_i->data[7]  * to_i->data[14] +
-    to_i->data[13] * to_i->data[6]  * to_i->data[11] - 
-    to_i->data[13] * to_i->data[7]  * to_i->data[10],
-
-    -to_i->data[4]  * to_i->data[10] * to_i->data[15] +
-    to_i->data[4]  * to_i->data[11] * to_i->data[14] +
-    to_i->data[8]  * to_i->data[6]  * to_i->data[15] - 
-    to_i->data[8]  * to_i->data[7]  * to_i->data[14] - 
-    to_i->data[12] * to_i->data[6]  * to_i->data[11] + 
-    to_i->data[12] * to_i->data[7]  * to_i->data[10],
-
-    to_i->data[4]  * to_i->data[9] * to_i->data[15] -
-    to_i->data[4]  * to_i->data[11] * to_i->data[13] -
-    to_i->data[8]  * to_i->data[5] * to_i->data[15] + 
-    to_i->data[8]  * to_i->data[7] * to_i->data[13] + 
-    to_i->data[12] * to_i->data[5] * to_i->data[11] - 
-    to_i->data[12] * to_i->data[7] * to_i->data[9],
-
-    -to_i->data[4]  * to_i->data[9] * to_i->data[14] +
-    to_i->data[4]  * to_i->data[10] * to_i->data[13] +
-    to_i->data[8]  * to_i->data[5] * to_i->data[14] - 
-    to_i->data[8]  * to_i->data[6] * to_i->data[13] - 
-    to_i->data[12] * to_i->data[5] * to_i->data[10] + 
-    to_i->data[12] * to_i->data[6] * to_i->data[9],
-
-    -to_i->data[1]  * to_i->data[10] * to_i->data[15] +
-    to_i->data[1]  * to_i->data[11] * to_i->data[14] +
-    to_i->data[9]  * to_i->data[2] * to_i->data[15] - 
-    to_i->data[9]  * to_i->data[3] * to_i->data[14] - 
-    to_i->data[13] * to_i->data[2] * to_i->data[11] + 
-    to_i->data[13] * to_i->data[3] * to_i->data[10],
-
-    to_i->data[0]  * to_i->data[10] * to_i->data[15] - 
-    to_i->data[0]  * to_i->data[11] * to_i->data[14] - 
-    to_i->data[8]  * to_i->data[2] * to_i->data[15] + 
-    to_i->data[8]  * to_i->data[3] * to_i->data[14] + 
-    to_i->data[12] * to_i->data[2] * to_i->data[11] - 
-    to_i->data[12] * to_i->data[3] * to_i->data[10],
-
-    -to_i->data[0]  * to_i->data[9] * to_i->data[15] + 
-    to_i->data[0]  * to_i->data[11] * to_i->data[13] + 
-    to_i->data[8]  * to_i->data[1] * to_i->data[15] - 
-    to_i->data[8]  * to_i->data[3] * to_i->data[13] - 
-    to_i->data[12] * to_i->data[1] * to_i->data[11] + 
-    to_i->data[12] * to_i->data[3] * to_i->data[9],
-
-    to_i->data[0]  * to_i->data[9] * to_i->data[14] - 
-    to_i->data[0]  * to_i->data[10] * to_i->data[13] - 
-    to_i->data[8]  * to_i->data[1] * to_i->data[14] + 
-    to_i->data[8]  * to_i->data[2] * to_i->data[13] + 
-    to_i->data[12] * to_i->data[1] * to_i->data[10] - 
-    to_i->data[12] * to_i->data[2] * to_i->data[9],
-
-    to_i->data[1]  * to_i->data[6] * to_i->data[15] - 
-    to_i->data[1]  * to_i->data[7] * to_i->data[14] - 
-    to_i->data[5]  * to_i->data[2] * to_i->data[15] + 
-    to_i->data[5]  * to_i->data[3] * to_i->data[14] + 
-    to_i->data[13] * to_i->data[2] * to_i->data[7] - 
-    to_i->data[13] * to_i->data[3] * to_i->data[6],
-
-    -to_i->data[0]  * to_i->data[6] * to_i->data[15] + 
-    to_i->data[0]  * to_i->data[7] * to_i->data[14] + 
-    to_i->data[4]  * to_i->data[2] * to_i->data[15] - 
-    to_i->data[4]  * to_i->data[3] * to_i->data[14] - 
-    to_i->data[12] * to_i->data[2] * to_i->data[7] + 
-    to_i->data[12] * to_i->data[3] * to_i->data[6],
-
-    to_i->data[0]  * to_i->data[5] * to_i->data[15] - 
-    to_i->data[0]  * to_i->data[7] * to_i->data[13] - 
-    to_i->data[4]  * to_i->data[1] * to_i->data[15] + 
-    to_i->data[4]  * to_i->data[3] * to_i->data[13] + 
-    to_i->data[12] * to_i->data[1] * to_i->data[7] - 
-    to_i->data[12] * to_i->data[3] * to_i->data[5],
-
-    -to_i->data[0]  * to_i->data[5] * to_i->data[14] + 
-     to_i->data[0]  * to_i->data[6] * to_i->data[13] + 
-     to_i->data[4]  * to_i->data[1] * to_i->data[14] - 
-     to_i->data[4]  * to_i->data[2] * to_i->data[13] - 
-     to_i->data[12] * to_i->data[1] * to_i->data[6] + 
-     to_i->data[12] * to_i->data[2] * to_i->data[5],
-
-    -to_i->data[1] * to_i->data[6] * to_i->data[11] + 
-    to_i->data[1] * to_i->data[7] * to_i->data[10] + 
-    to_i->data[5] * to_i->data[2] * to_i->data[11] - 
-    to_i->data[5] * to_i->data[3] * to_i->data[10] - 
-    to_i->data[9] * to_i->data[2] * to_i->data[7] + 
-    to_i->data[9] * to_i->data[3] * to_i->data[6],
-
-    to_i->data[0] * to_i->data[6] * to_i->data[11] - 
-    to_i->data[0] * to_i->data[7] * to_i->data[10] - 
-    to_i->data[4] * to_i->data[2] * to_i->data[11] + 
-    to_i->data[4] * to_i->data[3] * to_i->data[10] + 
-    to_i->data[8] * to_i->data[2] * to_i->data[7] - 
-    to_i->data[8] * to_i->data[3] * to_i->data[6],
-
-    -to_i->data[0] * to_i->data[5] * to_i->data[11] + 
-     to_i->data[0] * to_i->data[7] * to_i->data[9] + 
-     to_i->data[4] * to_i->data[1] * to_i->data[11] - 
-     to_i->data[4] * to_i->data[3] * to_i->data[9] - 
-     to_i->data[8] * to_i->data[1] * to_i->data[7] + 
-     to_i->data[8] * to_i->data[3] * to_i->data[5],
-
-    to_i->data[0] * to_i->data[5] * to_i->data[10] - 
-    to_i->data[0] * to_i->data[6] * to_i->data[9] - 
-    to_i->data[4] * to_i->data[1] * to_i->data[10] + 
-    to_i->data[4] * to_i->data[2] * to_i->data[9] + 
-    to_i->data[8] * to_i->data[1] * to_i->data[6] - 
-    to_i->data[8] * to_i->data[2] * to_i->data[5],
-  };
-  
-  const float determinant = to_i->data[0] * inverse[0] + to_i->data[1] * inverse[4] + to_i->data[2] * inverse[8] + to_i->data[3] * inverse[12];
-
-  assert(determinant != 0);
-  
-  const float one_over_det = 1.f / determinant;
-  
-  for (auto &i : inverse)
-  {
-    i = i * one_over_det;
-  }
-  
-  return mat4_init_with_array(inverse);
-}
-
-
 float
 mat4_get_determinant(const mat4 &det)
 {
@@ -714,4 +447,20 @@ mat4_get_sub_mat3(const mat4 &m)
 _MATH_NS_CLOSE
 
 
+/*
+  Include the correct impl
+*/
+
+
+#ifdef MATH_ON_SSE2
+
+#include "mat4_sse.inl"
+
+#else
+
+#include "mat4_fallback.inl"
+
+#endif // impl choice
+
+
 #endif // include guard
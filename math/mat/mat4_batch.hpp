@@ -0,0 +1,75 @@
+#ifndef MATRIX44_BATCH_INCLUDED_EB52B2DD_055B_4171_948F_1145D0F03905
+#define MATRIX44_BATCH_INCLUDED_EB52B2DD_055B_4171_948F_1145D0F03905
+
+
+/*
+  Matrix 44 Batch
+  Operations over contiguous arrays of matrices, for when a
+  whole array of local matrices is pushed through one parent
+  or view projection matrix.
+*/
+
+
+#include "../detail/detail.hpp"
+#include "mat_types.hpp"
+#include "mat4.hpp"
+#include <stddef.h>
+
+
+_MATH_NS_OPEN
+
+
+// out[i] = lhs[i] * rhs, out can be lhs.
+MATH_MAT4_INLINE void                       mat4_multiply_array(const mat4 lhs[], const mat4 &rhs, mat4 out[], const size_t count);
+
+// out[i] = lhs[i] * rhs[i], out can be lhs or rhs.
+MATH_MAT4_INLINE void                       mat4_multiply_array(const mat4 lhs[], const mat4 rhs[], mat4 out[], const size_t count);
+
+// lhs_and_out[i] = lhs_and_out[i] * rhs
+MATH_MAT4_INLINE void                       mat4_multiply_array_in_place(mat4 lhs_and_out[], const mat4 &rhs, const size_t count);
+
+/*
+  Transform xyz streams, strides are in floats (3 for packed xyz as
+  used by aabb_init_from_xyz_data and ray_test_triangles).
+  Points get the translation, directions don't. w_divide is for
+  projection matrices. out can be in when the strides match.
+*/
+MATH_MAT4_INLINE void                       mat4_transform_points(const mat4 &mat, const float in_xyz[], const size_t in_stride, float out_xyz[], const size_t out_stride, const size_t count, const bool w_divide = false);
+MATH_MAT4_INLINE void                       mat4_transform_directions(const mat4 &mat, const float in_xyz[], const size_t in_stride, float out_xyz[], const size_t out_stride, const size_t count);
+
+
+namespace detail
+{
+  // Batches with more results than this are written with non temporal
+  // stores, as they won't fit in cache anyway (1MB of output).
+  MATH_CONSTEXPR size_t mat4_batch_stream_count() { return 16384; }
+}
+
+
+void
+mat4_multiply_array_in_place(mat4 lhs_and_out[], const mat4 &rhs, const size_t count)
+{
+  mat4_multiply_array(lhs_and_out, rhs, lhs_and_out, count);
+}
+
+
+_MATH_NS_CLOSE
+
+
+/*
+  Include the correct impl
+*/
+
+
+#ifdef MATH_ON_SSE2
+
+#include "mat4_batch_sse.inl"
+
+#else
+
+#include "mat4_batch_fallback.inl"
+
+#endif // impl choice
+
+
+#endif // include guard
@@ -0,0 +1,101 @@
+#ifndef MATRIX44_BATCH_FALLBACK_INCLUDED_59191D0E_FF63_4F21_B3E2_B38BF1DD0341
+#define MATRIX44_BATCH_FALLBACK_INCLUDED_59191D0E_FF63_4F21_B3E2_B38BF1DD0341
+
+
+#include "../detail/detail.hpp"
+#include "mat_types.hpp"
+#include "mat4.hpp"
+
+
+#ifdef MATH_ON_FPU
+
+
+/*
+  Matrix 44 Batch
+  Fallback impl.
+*/
+
+
+_MATH_NS_OPEN
+
+
+void
+mat4_multiply_array(const mat4 lhs[], const mat4 &rhs, mat4 out[], const size_t count)
+{
+  const mat4 right = rhs; // rhs can alias out.
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    out[i] = mat4_multiply(lhs[i], right);
+  }
+}
+
+
+void
+mat4_multiply_array(const mat4 lhs[], const mat4 rhs[], mat4 out[], const size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    out[i] = mat4_multiply(lhs[i], rhs[i]);
+  }
+}
+
+
+namespace detail
+{
+  // w is 1 for points and 0 for directions.
+  inline void
+  mat4_transform_xyz(const internal_mat4 *mat, const float in_xyz[], const size_t in_stride, float out_xyz[], const size_t out_stride, const size_t count, const float w, const bool w_divide)
+  {
+    for(size_t i = 0; i < count; ++i)
+    {
+      const float *in = &in_xyz[i * in_stride];
+      float *out      = &out_xyz[i * out_stride];
+
+      const float x = in[0];
+      const float y = in[1];
+      const float z = in[2];
+
+      float result[4];
+
+      for(uint32_t col = 0; col < 4; ++col)
+      {
+        result[col] = (x * mat->data[col + 0]) +
+                      (y * mat->data[col + 4]) +
+                      (z * mat->data[col + 8]) +
+                      (w * mat->data[col + 12]);
+      }
+
+      const float one_over_w = w_divide ? 1.f / result[3] : 1.f;
+
+      out[0] = result[0] * one_over_w;
+      out[1] = result[1] * one_over_w;
+      out[2] = result[2] * one_over_w;
+    }
+  }
+} // ns
+
+
+void
+mat4_transform_points(const mat4 &mat, const float in_xyz[], const size_t in_stride, float out_xyz[], const size_t out_stride, const size_t count, const bool w_divide)
+{
+  const detail::internal_mat4 *internal_mat = reinterpret_cast<const detail::internal_mat4*>(&mat);
+
+  detail::mat4_transform_xyz(internal_mat, in_xyz, in_stride, out_xyz, out_stride, count, 1.f, w_divide);
+}
+
+
+void
+mat4_transform_directions(const mat4 &mat, const float in_xyz[], const size_t in_stride, float out_xyz[], const size_t out_stride, const size_t count)
+{
+  const detail::internal_mat4 *internal_mat = reinterpret_cast<const detail::internal_mat4*>(&mat);
+
+  detail::mat4_transform_xyz(internal_mat, in_xyz, in_stride, out_xyz, out_stride, count, 0.f, false);
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // on fpu
+#endif // inc guard
@@ -0,0 +1,319 @@
+#ifndef MATRIX44_BATCH_SSE_INCLUDED_B46B624C_720C_47D6_9A78_047371FAC196
+#define MATRIX44_BATCH_SSE_INCLUDED_B46B624C_720C_47D6_9A78_047371FAC196
+
+
+#include "../detail/detail.hpp"
+#include "mat_types.hpp"
+#include "mat4.hpp"
+
+
+#ifdef MATH_ON_SSE2
+
+
+/*
+  Matrix 44 Batch
+  SSE impl, AVX does two matrices a pass and AVX-512 a whole
+  matrix per register when available.
+*/
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  inline void
+  mat4_sse_store_row(float *out, const __m128 row, const bool stream)
+  {
+    if(stream)
+    {
+      _mm_stream_ps(out, row);
+    }
+    else
+    {
+      _mm_store_ps(out, row);
+    }
+  }
+
+
+  inline void
+  mat4_sse_multiply_into(const internal_mat4 *lhs, const internal_mat4 *rhs, internal_mat4 *out, const bool stream)
+  {
+    // All rows are done before storing, out can be lhs or rhs.
+    const __m128 row_0 = mat4_sse_combine_rows(lhs->simd_vec[0], rhs);
+    const __m128 row_1 = mat4_sse_combine_rows(lhs->simd_vec[1], rhs);
+    const __m128 row_2 = mat4_sse_combine_rows(lhs->simd_vec[2], rhs);
+    const __m128 row_3 = mat4_sse_combine_rows(lhs->simd_vec[3], rhs);
+
+    mat4_sse_store_row(&out->data[0],  row_0, stream);
+    mat4_sse_store_row(&out->data[4],  row_1, stream);
+    mat4_sse_store_row(&out->data[8],  row_2, stream);
+    mat4_sse_store_row(&out->data[12], row_3, stream);
+  }
+
+
+  #ifdef MATH_ON_AVX
+
+  inline void
+  mat4_avx_store_rows(float *out, const __m256 rows, const bool stream)
+  {
+    // Matrices are only 16 byte aligned, so stream each half.
+    if(stream)
+    {
+      _mm_stream_ps(out + 0, _mm256_castps256_ps128(rows));
+      _mm_stream_ps(out + 4, _mm256_extractf128_ps(rows, 1));
+    }
+    else
+    {
+      _mm256_storeu_ps(out, rows);
+    }
+  }
+
+  #endif // avx
+
+
+  #ifdef MATH_ON_AVX512
+
+  inline void
+  mat4_avx512_store(float *out, const __m512 mat, const bool stream)
+  {
+    // Matrices are only 16 byte aligned, so stream each row.
+    if(stream)
+    {
+      _mm_stream_ps(out + 0,  _mm512_maskz_extractf32x4_ps(0xF, mat, 0));
+      _mm_stream_ps(out + 4,  _mm512_maskz_extractf32x4_ps(0xF, mat, 1));
+      _mm_stream_ps(out + 8,  _mm512_maskz_extractf32x4_ps(0xF, mat, 2));
+      _mm_stream_ps(out + 12, _mm512_maskz_extractf32x4_ps(0xF, mat, 3));
+    }
+    else
+    {
+      _mm512_storeu_ps(out, mat);
+    }
+  }
+
+  #endif // avx512
+
+
+  // Only x, y, z are written so packed streams can be done in place.
+  inline void
+  sse_store_xyz(float *out, const __m128 xyzw)
+  {
+    _mm_storel_pi(reinterpret_cast<__m64*>(out), xyzw);
+    _mm_store_ss(out + 2, _mm_movehl_ps(xyzw, xyzw));
+  }
+
+
+  inline __m128
+  sse_w_divide(const __m128 xyzw)
+  {
+    return _mm_div_ps(xyzw, _mm_shuffle_ps(xyzw, xyzw, _MM_SHUFFLE(3,3,3,3)));
+  }
+
+
+  // w is 1 for points and 0 for directions.
+  inline void
+  mat4_sse_transform_xyz(const internal_mat4 *mat, const float in_xyz[], const size_t in_stride, float out_xyz[], const size_t out_stride, const size_t count, const float w, const bool w_divide)
+  {
+    const internal_mat4 rows = *mat;
+
+    size_t i = 0;
+
+    #ifdef MATH_ON_AVX512
+    const mat4_avx512_rows avx512_rows = mat4_avx512_load_rows(&rows);
+
+    // Four points per pass, one in each 128 bit lane.
+    for(; i + 4 <= count; i += 4)
+    {
+      const float *in_a = &in_xyz[(i + 0) * in_stride];
+      const float *in_b = &in_xyz[(i + 1) * in_stride];
+      const float *in_c = &in_xyz[(i + 2) * in_stride];
+      const float *in_d = &in_xyz[(i + 3) * in_stride];
+
+      __m512 points = _mm512_castps128_ps512(_mm_setr_ps(in_a[0], in_a[1], in_a[2], w));
+      points = _mm512_insertf32x4(points, _mm_setr_ps(in_b[0], in_b[1], in_b[2], w), 1);
+      points = _mm512_insertf32x4(points, _mm_setr_ps(in_c[0], in_c[1], in_c[2], w), 2);
+      points = _mm512_insertf32x4(points, _mm_setr_ps(in_d[0], in_d[1], in_d[2], w), 3);
+
+      __m512 result = mat4_avx512_combine_rows(points, avx512_rows);
+
+      if(w_divide)
+      {
+        result = _mm512_div_ps(result, _mm512_maskz_permute_ps(0xFFFF, result, _MM_SHUFFLE(3,3,3,3)));
+      }
+
+      sse_store_xyz(&out_xyz[(i + 0) * out_stride], _mm512_maskz_extractf32x4_ps(0xF, result, 0));
+      sse_store_xyz(&out_xyz[(i + 1) * out_stride], _mm512_maskz_extractf32x4_ps(0xF, result, 1));
+      sse_store_xyz(&out_xyz[(i + 2) * out_stride], _mm512_maskz_extractf32x4_ps(0xF, result, 2));
+      sse_store_xyz(&out_xyz[(i + 3) * out_stride], _mm512_maskz_extractf32x4_ps(0xF, result, 3));
+    }
+    #endif
+
+    #ifdef MATH_ON_AVX
+    const mat4_avx_rows avx_rows = mat4_avx_load_rows(&rows);
+
+    // Two points per pass, one in each half.
+    for(; i + 2 <= count; i += 2)
+    {
+      const float *in_a = &in_xyz[(i + 0) * in_stride];
+      const float *in_b = &in_xyz[(i + 1) * in_stride];
+
+      const __m128 point_a = _mm_setr_ps(in_a[0], in_a[1], in_a[2], w);
+      const __m128 point_b = _mm_setr_ps(in_b[0], in_b[1], in_b[2], w);
+
+      __m256 result = mat4_avx_combine_rows(
+        _mm256_insertf128_ps(_mm256_castps128_ps256(point_a), point_b, 1),
+        avx_rows
+      );
+
+      if(w_divide)
+      {
+        result = _mm256_div_ps(result, _mm256_permute_ps(result, _MM_SHUFFLE(3,3,3,3)));
+      }
+
+      sse_store_xyz(&out_xyz[(i + 0) * out_stride], _mm256_castps256_ps128(result));
+      sse_store_xyz(&out_xyz[(i + 1) * out_stride], _mm256_extractf128_ps(result, 1));
+    }
+    #endif
+
+    for(; i < count; ++i)
+    {
+      const float *in = &in_xyz[i * in_stride];
+
+      __m128 result = mat4_sse_combine_rows(_mm_setr_ps(in[0], in[1], in[2], w), &rows);
+
+      if(w_divide)
+      {
+        result = sse_w_divide(result);
+      }
+
+      sse_store_xyz(&out_xyz[i * out_stride], result);
+    }
+  }
+} // ns
+
+
+void
+mat4_multiply_array(const mat4 lhs[], const mat4 &rhs, mat4 out[], const size_t count)
+{
+  const detail::internal_mat4 *left = reinterpret_cast<const detail::internal_mat4*>(lhs);
+  detail::internal_mat4 *internal_out = reinterpret_cast<detail::internal_mat4*>(out);
+
+  // rhs is held for the whole batch, it can alias out.
+  const detail::internal_mat4 right = *reinterpret_cast<const detail::internal_mat4*>(&rhs);
+  const bool stream = count > detail::mat4_batch_stream_count();
+
+  size_t i = 0;
+
+  #if defined(MATH_ON_AVX512)
+  const detail::mat4_avx512_rows right_rows = detail::mat4_avx512_load_rows(&right);
+
+  for(; i < count; ++i)
+  {
+    const __m512 result = detail::mat4_avx512_combine_rows(_mm512_loadu_ps(&left[i].data[0]), right_rows);
+    detail::mat4_avx512_store(&internal_out[i].data[0], result, stream);
+  }
+  #elif defined(MATH_ON_AVX)
+  const detail::mat4_avx_rows right_rows = detail::mat4_avx_load_rows(&right);
+
+  for(; i + 2 <= count; i += 2)
+  {
+    const __m256 a_rows_01 = _mm256_loadu_ps(&left[i + 0].data[0]);
+    const __m256 a_rows_23 = _mm256_loadu_ps(&left[i + 0].data[8]);
+    const __m256 b_rows_01 = _mm256_loadu_ps(&left[i + 1].data[0]);
+    const __m256 b_rows_23 = _mm256_loadu_ps(&left[i + 1].data[8]);
+
+    const __m256 a_out_01 = detail::mat4_avx_combine_rows(a_rows_01, right_rows);
+    const __m256 a_out_23 = detail::mat4_avx_combine_rows(a_rows_23, right_rows);
+    const __m256 b_out_01 = detail::mat4_avx_combine_rows(b_rows_01, right_rows);
+    const __m256 b_out_23 = detail::mat4_avx_combine_rows(b_rows_23, right_rows);
+
+    detail::mat4_avx_store_rows(&internal_out[i + 0].data[0], a_out_01, stream);
+    detail::mat4_avx_store_rows(&internal_out[i + 0].data[8], a_out_23, stream);
+    detail::mat4_avx_store_rows(&internal_out[i + 1].data[0], b_out_01, stream);
+    detail::mat4_avx_store_rows(&internal_out[i + 1].data[8], b_out_23, stream);
+  }
+  #endif
+
+  for(; i < count; ++i)
+  {
+    detail::mat4_sse_multiply_into(&left[i], &right, &internal_out[i], stream);
+  }
+
+  if(stream)
+  {
+    _mm_sfence();
+  }
+}
+
+
+void
+mat4_multiply_array(const mat4 lhs[], const mat4 rhs[], mat4 out[], const size_t count)
+{
+  const detail::internal_mat4 *left = reinterpret_cast<const detail::internal_mat4*>(lhs);
+  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(rhs);
+  detail::internal_mat4 *internal_out = reinterpret_cast<detail::internal_mat4*>(out);
+
+  const bool stream = count > detail::mat4_batch_stream_count();
+
+  size_t i = 0;
+
+  #if defined(MATH_ON_AVX512)
+  for(; i < count; ++i)
+  {
+    const detail::mat4_avx512_rows right_rows = detail::mat4_avx512_load_rows(&right[i]);
+    const __m512 result = detail::mat4_avx512_combine_rows(_mm512_loadu_ps(&left[i].data[0]), right_rows);
+    detail::mat4_avx512_store(&internal_out[i].data[0], result, stream);
+  }
+  #elif defined(MATH_ON_AVX)
+  for(; i + 2 <= count; i += 2)
+  {
+    const detail::mat4_avx_rows a_right = detail::mat4_avx_load_rows(&right[i + 0]);
+    const detail::mat4_avx_rows b_right = detail::mat4_avx_load_rows(&right[i + 1]);
+
+    const __m256 a_out_01 = detail::mat4_avx_combine_rows(_mm256_loadu_ps(&left[i + 0].data[0]), a_right);
+    const __m256 a_out_23 = detail::mat4_avx_combine_rows(_mm256_loadu_ps(&left[i + 0].data[8]), a_right);
+    const __m256 b_out_01 = detail::mat4_avx_combine_rows(_mm256_loadu_ps(&left[i + 1].data[0]), b_right);
+    const __m256 b_out_23 = detail::mat4_avx_combine_rows(_mm256_loadu_ps(&left[i + 1].data[8]), b_right);
+
+    detail::mat4_avx_store_rows(&internal_out[i + 0].data[0], a_out_01, stream);
+    detail::mat4_avx_store_rows(&internal_out[i + 0].data[8], a_out_23, stream);
+    detail::mat4_avx_store_rows(&internal_out[i + 1].data[0], b_out_01, stream);
+    detail::mat4_avx_store_rows(&internal_out[i + 1].data[8], b_out_23, stream);
+  }
+  #endif
+
+  for(; i < count; ++i)
+  {
+    detail::mat4_sse_multiply_into(&left[i], &right[i], &internal_out[i], stream);
+  }
+
+  if(stream)
+  {
+    _mm_sfence();
+  }
+}
+
+
+void
+mat4_transform_points(const mat4 &mat, const float in_xyz[], const size_t in_stride, float out_xyz[], const size_t out_stride, const size_t count, const bool w_divide)
+{
+  const detail::internal_mat4 *internal_mat = reinterpret_cast<const detail::internal_mat4*>(&mat);
+
+  detail::mat4_sse_transform_xyz(internal_mat, in_xyz, in_stride, out_xyz, out_stride, count, 1.f, w_divide);
+}
+
+
+void
+mat4_transform_directions(const mat4 &mat, const float in_xyz[], const size_t in_stride, float out_xyz[], const size_t out_stride, const size_t count)
+{
+  const detail::internal_mat4 *internal_mat = reinterpret_cast<const detail::internal_mat4*>(&mat);
+
+  detail::mat4_sse_transform_xyz(internal_mat, in_xyz, in_stride, out_xyz, out_stride, count, 0.f, false);
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // use sse
+#endif // inc guard
@@ -0,0 +1,354 @@
+#ifndef MAT4_FALLBACK_INLINE_INCLUDED_AD1029B4_DDAD_456A_B2D6_59E47873BFEA
+#define MAT4_FALLBACK_INLINE_INCLUDED_AD1029B4_DDAD_456A_B2D6_59E47873BFEA
+
+
+#include "../detail/detail.hpp"
+#include "mat_types.hpp"
+#include "../vec/vec4.hpp"
+
+
+#ifdef MATH_ON_FPU
+
+
+/*
+  Matrix 44
+  4x4 matrix fallback impl.
+*/
+
+
+_MATH_NS_OPEN
+
+
+mat4
+mat4_add(const mat4 &lhs, const mat4 &rhs)
+{
+  const detail::internal_mat4 *left = reinterpret_cast<const detail::internal_mat4*>(&lhs);
+  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  for(uint32_t i = 0; i < 16; ++i)
+  {
+    internal_mat->data[i] = left->data[i] + right->data[i];
+  }
+
+  return return_mat;
+}
+
+
+mat4
+mat4_subtract(const mat4 &lhs, const mat4 &rhs)
+{
+  const detail::internal_mat4 *left = reinterpret_cast<const detail::internal_mat4*>(&lhs);
+  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  for(uint32_t i = 0; i < 16; ++i)
+  {
+    internal_mat->data[i] = left->data[i] - right->data[i];
+  }
+
+  return return_mat;
+}
+
+
+mat4
+mat4_multiply(const float lhs, const mat4 &rhs)
+{
+  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  for(uint32_t i = 0; i < 16; ++i)
+  {
+    internal_mat->data[i] = lhs * right->data[i];
+  }
+
+  return return_mat;
+}
+
+
+namespace detail
+{
+  // Row vector * matrix, each lhs element weights a row of the matrix.
+  inline void
+  mat4_combine_rows(const float vec[4], const internal_mat4 *mat, float out[4])
+  {
+    for(uint32_t col = 0; col < 4; ++col)
+    {
+      out[col] = (vec[0] * mat->data[col + 0]) +
+                 (vec[1] * mat->data[col + 4]) +
+                 (vec[2] * mat->data[col + 8]) +
+                 (vec[3] * mat->data[col + 12]);
+    }
+  }
+} // ns
+
+
+vec4
+mat4_multiply(const vec4 lhs, const mat4 &rhs)
+{
+  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
+
+  float vec[4];
+  vec4_to_array(lhs, vec);
+
+  float result[4];
+  detail::mat4_combine_rows(vec, right, result);
+
+  return vec4_init_with_array(result);
+}
+
+
+mat4
+mat4_multiply(const mat4 &lhs, const mat4 &rhs)
+{
+  const detail::internal_mat4 *left  = reinterpret_cast<const detail::internal_mat4*>(&lhs);
+  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  for(uint32_t row = 0; row < 16; row += 4)
+  {
+    detail::mat4_combine_rows(&left->data[row], right, &internal_mat->data[row]);
+  }
+
+  return return_mat;
+}
+
+
+mat4
+mat4_multiply(const mat4 &one, const mat4 &two, const mat4 &three)
+{
+  const detail::internal_mat4 *first  = reinterpret_cast<const detail::internal_mat4*>(&one);
+  const detail::internal_mat4 *second = reinterpret_cast<const detail::internal_mat4*>(&two);
+  const detail::internal_mat4 *third  = reinterpret_cast<const detail::internal_mat4*>(&three);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  // Carry one row through both products, no intermediate matrix.
+  for(uint32_t row = 0; row < 16; row += 4)
+  {
+    float partial[4];
+
+    detail::mat4_combine_rows(&first->data[row], second, partial);
+    detail::mat4_combine_rows(partial, third, &internal_mat->data[row]);
+  }
+
+  return return_mat;
+}
+
+
+mat4
+mat4_get_transpose(const mat4 &to_transpose)
+{
+  const detail::internal_mat4 *transpose_data = reinterpret_cast<const detail::internal_mat4*>(&to_transpose);
+
+  const float mat_transpose[16]
+  {
+    transpose_data->data[0],  transpose_data->data[4],  transpose_data->data[8],  transpose_data->data[12],
+    transpose_data->data[1],  transpose_data->data[5],  transpose_data->data[9],  transpose_data->data[13],
+    transpose_data->data[2],  transpose_data->data[6],  transpose_data->data[10], transpose_data->data[14],
+    transpose_data->data[3],  transpose_data->data[7],  transpose_data->data[11], transpose_data->data[15],
+  };
+
+  return mat4_init_with_array(mat_transpose);
+}
+
+
+mat4
+mat4_get_inverse(const mat4 &to_inverse)
+{
+  const detail::internal_mat4 *to_i = reinterpret_cast<const detail::internal_mat4*>(&to_inverse);
+  
+  // Cofactor matrix, the inverse is its transpose over the determinant.
+  const float cofactor[16]
+  {
+    to_i->data[5]  * to_i->data[10] * to_i->data[15] -
+    to_i->data[5]  * to_i->data[11] * to_i->data[14] -
+    to_i->data[9]  * to_i->data[6]  * to_i->data[15] + 
+    to_i->data[9]  * to_i->data[7]  * to_i->data[14] +
+    to_i->data[13] * to_i->data[6]  * to_i->data[11] - 
+    to_i->data[13] * to_i->data[7]  * to_i->data[10],
+
+    -to_i->data[4]  * to_i->data[10] * to_i->data[15] +
+    to_i->data[4]  * to_i->data[11] * to_i->data[14] +
+    to_i->data[8]  * to_i->data[6]  * to_i->data[15] - 
+    to_i->data[8]  * to_i->data[7]  * to_i->data[14] - 
+    to_i->data[12] * to_i->data[6]  * to_i->data[11] + 
+    to_i->data[12] * to_i->data[7]  * to_i->data[10],
+
+    to_i->data[4]  * to_i->data[9] * to_i->data[15] -
+    to_i->data[4]  * to_i->data[11] * to_i->data[13] -
+    to_i->data[8]  * to_i->data[5] * to_i->data[15] + 
+    to_i->data[8]  * to_i->data[7] * to_i->data[13] + 
+    to_i->data[12] * to_i->data[5] * to_i->data[11] - 
+    to_i->data[12] * to_i->data[7] * to_i->data[9],
+
+    -to_i->data[4]  * to_i->data[9] * to_i->data[14] +
+    to_i->data[4]  * to_i->data[10] * to_i->data[13] +
+    to_i->data[8]  * to_i->data[5] * to_i->data[14] - 
+    to_i->data[8]  * to_i->data[6] * to_i->data[13] - 
+    to_i->data[12] * to_i->data[5] * to_i->data[10] + 
+    to_i->data[12] * to_i->data[6] * to_i->data[9],
+
+    -to_i->data[1]  * to_i->data[10] * to_i->data[15] +
+    to_i->data[1]  * to_i->data[11] * to_i->data[14] +
+    to_i->data[9]  * to_i->data[2] * to_i->data[15] - 
+    to_i->data[9]  * to_i->data[3] * to_i->data[14] - 
+    to_i->data[13] * to_i->data[2] * to_i->data[11] + 
+    to_i->data[13] * to_i->data[3] * to_i->data[10],
+
+    to_i->data[0]  * to_i->data[10] * to_i->data[15] - 
+    to_i->data[0]  * to_i->data[11] * to_i->data[14] - 
+    to_i->data[8]  * to_i->data[2] * to_i->data[15] + 
+    to_i->data[8]  * to_i->data[3] * to_i->data[14] + 
+    to_i->data[12] * to_i->data[2] * to_i->data[11] - 
+    to_i->data[12] * to_i->data[3] * to_i->data[10],
+
+    -to_i->data[0]  * to_i->data[9] * to_i->data[15] + 
+    to_i->data[0]  * to_i->data[11] * to_i->data[13] + 
+    to_i->data[8]  * to_i->data[1] * to_i->data[15] - 
+    to_i->data[8]  * to_i->data[3] * to_i->data[13] - 
+    to_i->data[12] * to_i->data[1] * to_i->data[11] + 
+    to_i->data[12] * to_i->data[3] * to_i->data[9],
+
+    to_i->data[0]  * to_i->data[9] * to_i->data[14] - 
+    to_i->data[0]  * to_i->data[10] * to_i->data[13] - 
+    to_i->data[8]  * to_i->data[1] * to_i->data[14] + 
+    to_i->data[8]  * to_i->data[2] * to_i->data[13] + 
+    to_i->data[12] * to_i->data[1] * to_i->data[10] - 
+    to_i->data[12] * to_i->data[2] * to_i->data[9],
+
+    to_i->data[1]  * to_i->data[6] * to_i->data[15] - 
+    to_i->data[1]  * to_i->data[7] * to_i->data[14] - 
+    to_i->data[5]  * to_i->data[2] * to_i->data[15] + 
+    to_i->data[5]  * to_i->data[3] * to_i->data[14] + 
+    to_i->data[13] * to_i->data[2] * to_i->data[7] - 
+    to_i->data[13] * to_i->data[3] * to_i->data[6],
+
+    -to_i->data[0]  * to_i->data[6] * to_i->data[15] + 
+    to_i->data[0]  * to_i->data[7] * to_i->data[14] + 
+    to_i->data[4]  * to_i->data[2] * to_i->data[15] - 
+    to_i->data[4]  * to_i->data[3] * to_i->data[14] - 
+    to_i->data[12] * to_i->data[2] * to_i->data[7] + 
+    to_i->data[12] * to_i->data[3] * to_i->data[6],
+
+    to_i->data[0]  * to_i->data[5] * to_i->data[15] - 
+    to_i->data[0]  * to_i->data[7] * to_i->data[13] - 
+    to_i->data[4]  * to_i->data[1] * to_i->data[15] + 
+    to_i->data[4]  * to_i->data[3] * to_i->data[13] + 
+    to_i->data[12] * to_i->data[1] * to_i->data[7] - 
+    to_i->data[12] * to_i->data[3] * to_i->data[5],
+
+    -to_i->data[0]  * to_i->data[5] * to_i->data[14] + 
+     to_i->data[0]  * to_i->data[6] * to_i->data[13] + 
+     to_i->data[4]  * to_i->data[1] * to_i->data[14] - 
+     to_i->data[4]  * to_i->data[2] * to_i->data[13] - 
+     to_i->data[12] * to_i->data[1] * to_i->data[6] + 
+     to_i->data[12] * to_i->data[2] * to_i->data[5],
+
+    -to_i->data[1] * to_i->data[6] * to_i->data[11] + 
+    to_i->data[1] * to_i->data[7] * to_i->data[10] + 
+    to_i->data[5] * to_i->data[2] * to_i->data[11] - 
+    to_i->data[5] * to_i->data[3] * to_i->data[10] - 
+    to_i->data[9] * to_i->data[2] * to_i->data[7] + 
+    to_i->data[9] * to_i->data[3] * to_i->data[6],
+
+    to_i->data[0] * to_i->data[6] * to_i->data[11] - 
+    to_i->data[0] * to_i->data[7] * to_i->data[10] - 
+    to_i->data[4] * to_i->data[2] * to_i->data[11] + 
+    to_i->data[4] * to_i->data[3] * to_i->data[10] + 
+    to_i->data[8] * to_i->data[2] * to_i->data[7] - 
+    to_i->data[8] * to_i->data[3] * to_i->data[6],
+
+    -to_i->data[0] * to_i->data[5] * to_i->data[11] + 
+     to_i->data[0] * to_i->data[7] * to_i->data[9] + 
+     to_i->data[4] * to_i->data[1] * to_i->data[11] - 
+     to_i->data[4] * to_i->data[3] * to_i->data[9] - 
+     to_i->data[8] * to_i->data[1] * to_i->data[7] + 
+     to_i->data[8] * to_i->data[3] * to_i->data[5],
+
+    to_i->data[0] * to_i->data[5] * to_i->data[10] - 
+    to_i->data[0] * to_i->data[6] * to_i->data[9] - 
+    to_i->data[4] * to_i->data[1] * to_i->data[10] + 
+    to_i->data[4] * to_i->data[2] * to_i->data[9] + 
+    to_i->data[8] * to_i->data[1] * to_i->data[6] - 
+    to_i->data[8] * to_i->data[2] * to_i->data[5],
+  };
+  
+  const float determinant = to_i->data[0] * cofactor[0] + to_i->data[1] * cofactor[1] + to_i->data[2] * cofactor[2] + to_i->data[3] * cofactor[3];
+
+  assert(determinant != 0);
+  
+  const float one_over_det = 1.f / determinant;
+  
+  // Transposed as it's scaled, spelt out so it stays one pass of multiplies.
+  const float inverse[16]
+  {
+    cofactor[0] * one_over_det, cofactor[4] * one_over_det, cofactor[8]  * one_over_det, cofactor[12] * one_over_det,
+    cofactor[1] * one_over_det, cofactor[5] * one_over_det, cofactor[9]  * one_over_det, cofactor[13] * one_over_det,
+    cofactor[2] * one_over_det, cofactor[6] * one_over_det, cofactor[10] * one_over_det, cofactor[14] * one_over_det,
+    cofactor[3] * one_over_det, cofactor[7] * one_over_det, cofactor[11] * one_over_det, cofactor[15] * one_over_det,
+  };
+  
+  return mat4_init_with_array(inverse);
+}
+
+
+mat4
+mat4_get_inverse_affine(const mat4 &to_inverse)
+{
+  const detail::internal_mat4 *to_i = reinterpret_cast<const detail::internal_mat4*>(&to_inverse);
+
+  // Rows of the 3x3 are orthogonal, so the inverse is the transpose
+  // with each column divided by that row's squared length.
+  float one_over_sq[3];
+
+  for(uint32_t i = 0; i < 3; ++i)
+  {
+    const float *row = &to_i->data[i * 4];
+    const float length_sq = (row[0] * row[0]) + (row[1] * row[1]) + (row[2] * row[2]);
+
+    assert(length_sq != 0);
+
+    one_over_sq[i] = 1.f / length_sq;
+  }
+
+  float inverse[16];
+
+  for(uint32_t row = 0; row < 3; ++row)
+  {
+    for(uint32_t col = 0; col < 3; ++col)
+    {
+      inverse[(row * 4) + col] = to_i->data[(col * 4) + row] * one_over_sq[col];
+    }
+
+    inverse[(row * 4) + 3] = 0.f;
+  }
+
+  // Back transform the translation.
+  for(uint32_t col = 0; col < 3; ++col)
+  {
+    inverse[12 + col] = -((to_i->data[12] * inverse[col + 0]) +
+                          (to_i->data[13] * inverse[col + 4]) +
+                          (to_i->data[14] * inverse[col + 8]));
+  }
+
+  inverse[15] = 1.f;
+
+  return mat4_init_with_array(inverse);
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // on fpu
+#endif // inc guard
@@ -0,0 +1,457 @@
+#ifndef MAT4_SSE_INLINE_INCLUDED_63078214_DF8F_44A9_B723_FD72615925DE
+#define MAT4_SSE_INLINE_INCLUDED_63078214_DF8F_44A9_B723_FD72615925DE
+
+
+#include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
+#include "mat_types.hpp"
+#include "../vec/vec4.hpp"
+#include <assert.h>
+
+
+#ifdef MATH_ON_SSE2
+
+
+/*
+  Matrix 44
+  4x4 matrix sse impl.
+  Each row lives in its own register.
+*/
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  // Row vector * matrix, this is x * row0 + y * row1 + z * row2 + w * row3.
+  inline __m128
+  mat4_sse_combine_rows(const __m128 vec, const internal_mat4 *mat)
+  {
+    const __m128 x = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(0,0,0,0));
+    const __m128 y = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(1,1,1,1));
+    const __m128 z = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(2,2,2,2));
+    const __m128 w = _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(3,3,3,3));
+
+    #ifdef MATH_ON_FMA
+    // Fused chain, one rounding per row.
+    __m128 result = _mm_mul_ps(x, mat->simd_vec[0]);
+    result = _mm_fmadd_ps(y, mat->simd_vec[1], result);
+    result = _mm_fmadd_ps(z, mat->simd_vec[2], result);
+    result = _mm_fmadd_ps(w, mat->simd_vec[3], result);
+
+    return result;
+    #else
+    // Two independent pairs, shorter dependency chain without fma.
+    const __m128 xy = _mm_add_ps(_mm_mul_ps(x, mat->simd_vec[0]), _mm_mul_ps(y, mat->simd_vec[1]));
+    const __m128 zw = _mm_add_ps(_mm_mul_ps(z, mat->simd_vec[2]), _mm_mul_ps(w, mat->simd_vec[3]));
+
+    return _mm_add_ps(xy, zw);
+    #endif
+  }
+
+
+  #ifdef MATH_ON_AVX
+
+  // Each rhs row duplicated into both halves, so two lhs rows are done at once.
+  struct mat4_avx_rows
+  {
+    __m256 row[4];
+  };
+
+
+  inline mat4_avx_rows
+  mat4_avx_load_rows(const internal_mat4 *mat)
+  {
+    return mat4_avx_rows{{
+      _mm256_broadcast_ps(&mat->simd_vec[0]),
+      _mm256_broadcast_ps(&mat->simd_vec[1]),
+      _mm256_broadcast_ps(&mat->simd_vec[2]),
+      _mm256_broadcast_ps(&mat->simd_vec[3]),
+    }};
+  }
+
+
+  // (row_a | row_b) * mat
+  inline __m256
+  mat4_avx_combine_rows(const __m256 rows, const mat4_avx_rows &mat)
+  {
+    __m256 result = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(0,0,0,0)), mat.row[0]);
+    result = avx_multiply_add(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(1,1,1,1)), mat.row[1], result);
+    result = avx_multiply_add(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(2,2,2,2)), mat.row[2], result);
+    result = avx_multiply_add(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(3,3,3,3)), mat.row[3], result);
+
+    return result;
+  }
+
+  #endif // avx
+
+
+  #ifdef MATH_ON_AVX512
+
+  // The avx512 kernels use the zero masked intrinsics with every lane set.
+  // They are the same instructions, but GCC 12's plain forms pass an
+  // uninitialised _mm512_undefined_ps() and warn under -Wall.
+
+  // Each rhs row in all four 128 bit lanes, so a whole lhs matrix is done at once.
+  struct mat4_avx512_rows
+  {
+    __m512 row[4];
+  };
+
+
+  inline mat4_avx512_rows
+  mat4_avx512_load_rows(const internal_mat4 *mat)
+  {
+    return mat4_avx512_rows{{
+      _mm512_maskz_broadcast_f32x4(0xFFFF, mat->simd_vec[0]),
+      _mm512_maskz_broadcast_f32x4(0xFFFF, mat->simd_vec[1]),
+      _mm512_maskz_broadcast_f32x4(0xFFFF, mat->simd_vec[2]),
+      _mm512_maskz_broadcast_f32x4(0xFFFF, mat->simd_vec[3]),
+    }};
+  }
+
+
+  // (row_0 | row_1 | row_2 | row_3) * mat
+  inline __m512
+  mat4_avx512_combine_rows(const __m512 rows, const mat4_avx512_rows &mat)
+  {
+    __m512 result = _mm512_mul_ps(_mm512_maskz_permute_ps(0xFFFF, rows, _MM_SHUFFLE(0,0,0,0)), mat.row[0]);
+    result = _mm512_fmadd_ps(_mm512_maskz_permute_ps(0xFFFF, rows, _MM_SHUFFLE(1,1,1,1)), mat.row[1], result);
+    result = _mm512_fmadd_ps(_mm512_maskz_permute_ps(0xFFFF, rows, _MM_SHUFFLE(2,2,2,2)), mat.row[2], result);
+    result = _mm512_fmadd_ps(_mm512_maskz_permute_ps(0xFFFF, rows, _MM_SHUFFLE(3,3,3,3)), mat.row[3], result);
+
+    return result;
+  }
+
+  #endif // avx512
+} // ns
+
+
+mat4
+mat4_add(const mat4 &lhs, const mat4 &rhs)
+{
+  const detail::internal_mat4 *left = reinterpret_cast<const detail::internal_mat4*>(&lhs);
+  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  internal_mat->simd_vec[0] = _mm_add_ps(left->simd_vec[0], right->simd_vec[0]);
+  internal_mat->simd_vec[1] = _mm_add_ps(left->simd_vec[1], right->simd_vec[1]);
+  internal_mat->simd_vec[2] = _mm_add_ps(left->simd_vec[2], right->simd_vec[2]);
+  internal_mat->simd_vec[3] = _mm_add_ps(left->simd_vec[3], right->simd_vec[3]);
+
+  return return_mat;
+}
+
+
+mat4
+mat4_subtract(const mat4 &lhs, const mat4 &rhs)
+{
+  const detail::internal_mat4 *left = reinterpret_cast<const detail::internal_mat4*>(&lhs);
+  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  internal_mat->simd_vec[0] = _mm_sub_ps(left->simd_vec[0], right->simd_vec[0]);
+  internal_mat->simd_vec[1] = _mm_sub_ps(left->simd_vec[1], right->simd_vec[1]);
+  internal_mat->simd_vec[2] = _mm_sub_ps(left->simd_vec[2], right->simd_vec[2]);
+  internal_mat->simd_vec[3] = _mm_sub_ps(left->simd_vec[3], right->simd_vec[3]);
+
+  return return_mat;
+}
+
+
+mat4
+mat4_multiply(const float lhs, const mat4 &rhs)
+{
+  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  const __m128 scale = _mm_set1_ps(lhs);
+
+  internal_mat->simd_vec[0] = _mm_mul_ps(scale, right->simd_vec[0]);
+  internal_mat->simd_vec[1] = _mm_mul_ps(scale, right->simd_vec[1]);
+  internal_mat->simd_vec[2] = _mm_mul_ps(scale, right->simd_vec[2]);
+  internal_mat->simd_vec[3] = _mm_mul_ps(scale, right->simd_vec[3]);
+
+  return return_mat;
+}
+
+
+vec4
+mat4_multiply(const vec4 lhs, const mat4 &rhs)
+{
+  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
+
+  return vec4{{detail::mat4_sse_combine_rows(lhs.simd_vec, right)}};
+}
+
+
+mat4
+mat4_multiply(const mat4 &lhs, const mat4 &rhs)
+{
+  const detail::internal_mat4 *left  = reinterpret_cast<const detail::internal_mat4*>(&lhs);
+  const detail::internal_mat4 *right = reinterpret_cast<const detail::internal_mat4*>(&rhs);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  // Each row of the result is the lhs row weighting the rhs rows.
+  #if defined(MATH_ON_AVX512)
+  const detail::mat4_avx512_rows right_rows = detail::mat4_avx512_load_rows(right);
+
+  _mm512_storeu_ps(&internal_mat->data[0], detail::mat4_avx512_combine_rows(_mm512_loadu_ps(&left->data[0]), right_rows));
+  #elif defined(MATH_ON_AVX)
+  const detail::mat4_avx_rows right_rows = detail::mat4_avx_load_rows(right);
+
+  _mm256_storeu_ps(&internal_mat->data[0], detail::mat4_avx_combine_rows(_mm256_loadu_ps(&left->data[0]), right_rows));
+  _mm256_storeu_ps(&internal_mat->data[8], detail::mat4_avx_combine_rows(_mm256_loadu_ps(&left->data[8]), right_rows));
+  #else
+  internal_mat->simd_vec[0] = detail::mat4_sse_combine_rows(left->simd_vec[0], right);
+  internal_mat->simd_vec[1] = detail::mat4_sse_combine_rows(left->simd_vec[1], right);
+  internal_mat->simd_vec[2] = detail::mat4_sse_combine_rows(left->simd_vec[2], right);
+  internal_mat->simd_vec[3] = detail::mat4_sse_combine_rows(left->simd_vec[3], right);
+  #endif
+
+  return return_mat;
+}
+
+
+mat4
+mat4_multiply(const mat4 &one, const mat4 &two, const mat4 &three)
+{
+  const detail::internal_mat4 *first  = reinterpret_cast<const detail::internal_mat4*>(&one);
+  const detail::internal_mat4 *second = reinterpret_cast<const detail::internal_mat4*>(&two);
+  const detail::internal_mat4 *third  = reinterpret_cast<const detail::internal_mat4*>(&three);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  // Carry each row through both products, no intermediate matrix.
+  #if defined(MATH_ON_AVX512)
+  const detail::mat4_avx512_rows second_rows = detail::mat4_avx512_load_rows(second);
+  const detail::mat4_avx512_rows third_rows  = detail::mat4_avx512_load_rows(third);
+
+  const __m512 partial = detail::mat4_avx512_combine_rows(_mm512_loadu_ps(&first->data[0]), second_rows);
+  _mm512_storeu_ps(&internal_mat->data[0], detail::mat4_avx512_combine_rows(partial, third_rows));
+  #elif defined(MATH_ON_AVX)
+  const detail::mat4_avx_rows second_rows = detail::mat4_avx_load_rows(second);
+  const detail::mat4_avx_rows third_rows  = detail::mat4_avx_load_rows(third);
+
+  for(uint32_t row = 0; row < 16; row += 8)
+  {
+    const __m256 partial = detail::mat4_avx_combine_rows(_mm256_loadu_ps(&first->data[row]), second_rows);
+    _mm256_storeu_ps(&internal_mat->data[row], detail::mat4_avx_combine_rows(partial, third_rows));
+  }
+  #else
+  for(uint32_t row = 0; row < 4; ++row)
+  {
+    const __m128 partial = detail::mat4_sse_combine_rows(first->simd_vec[row], second);
+    internal_mat->simd_vec[row] = detail::mat4_sse_combine_rows(partial, third);
+  }
+  #endif
+
+  return return_mat;
+}
+
+
+mat4
+mat4_get_transpose(const mat4 &to_transpose)
+{
+  const detail::internal_mat4 *transpose_data = reinterpret_cast<const detail::internal_mat4*>(&to_transpose);
+
+  __m128 row_0 = transpose_data->simd_vec[0];
+  __m128 row_1 = transpose_data->simd_vec[1];
+  __m128 row_2 = transpose_data->simd_vec[2];
+  __m128 row_3 = transpose_data->simd_vec[3];
+
+  _MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  internal_mat->simd_vec[0] = row_0;
+  internal_mat->simd_vec[1] = row_1;
+  internal_mat->simd_vec[2] = row_2;
+  internal_mat->simd_vec[3] = row_3;
+
+  return return_mat;
+}
+
+
+namespace detail
+{
+  /*
+    2x2 helpers for the block inverse. A 2x2 matrix is packed
+    row major into one register as (m00, m01, m10, m11).
+  */
+
+  // a * b
+  inline __m128
+  mat2_sse_multiply(const __m128 a, const __m128 b)
+  {
+    return sse_multiply_add(
+      a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3,0,3,0)),
+      _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2,3,0,1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1,2,1,2)))
+    );
+  }
+
+  // adjugate(a) * b
+  inline __m128
+  mat2_sse_adj_multiply(const __m128 a, const __m128 b)
+  {
+    return sse_multiply_sub(
+      _mm_shuffle_ps(a, a, _MM_SHUFFLE(0,0,3,3)), b,
+      _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2,2,1,1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1,0,3,2)))
+    );
+  }
+
+  // a * adjugate(b)
+  inline __m128
+  mat2_sse_multiply_adj(const __m128 a, const __m128 b)
+  {
+    return sse_multiply_sub(
+      a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0,3,0,3)),
+      _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2,3,0,1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1,2,1,2)))
+    );
+  }
+} // ns
+
+
+mat4
+mat4_get_inverse(const mat4 &to_inverse)
+{
+  /*
+    Block inverse, the matrix is split into four 2x2 matrices.
+    | A B |
+    | C D |
+  */
+  const detail::internal_mat4 *to_i = reinterpret_cast<const detail::internal_mat4*>(&to_inverse);
+
+  const __m128 row_0 = to_i->simd_vec[0];
+  const __m128 row_1 = to_i->simd_vec[1];
+  const __m128 row_2 = to_i->simd_vec[2];
+  const __m128 row_3 = to_i->simd_vec[3];
+
+  const __m128 a = _mm_movelh_ps(row_0, row_1);
+  const __m128 b = _mm_movehl_ps(row_1, row_0);
+  const __m128 c = _mm_movelh_ps(row_2, row_3);
+  const __m128 d = _mm_movehl_ps(row_3, row_2);
+
+  // Determinants of the sub matrices (|A|, |B|, |C|, |D|).
+  const __m128 det_sub = _mm_sub_ps(
+    _mm_mul_ps(_mm_shuffle_ps(row_0, row_2, _MM_SHUFFLE(2,0,2,0)), _mm_shuffle_ps(row_1, row_3, _MM_SHUFFLE(3,1,3,1))),
+    _mm_mul_ps(_mm_shuffle_ps(row_0, row_2, _MM_SHUFFLE(3,1,3,1)), _mm_shuffle_ps(row_1, row_3, _MM_SHUFFLE(2,0,2,0)))
+  );
+
+  const __m128 det_a = _mm_shuffle_ps(det_sub, det_sub, _MM_SHUFFLE(0,0,0,0));
+  const __m128 det_b = _mm_shuffle_ps(det_sub, det_sub, _MM_SHUFFLE(1,1,1,1));
+  const __m128 det_c = _mm_shuffle_ps(det_sub, det_sub, _MM_SHUFFLE(2,2,2,2));
+  const __m128 det_d = _mm_shuffle_ps(det_sub, det_sub, _MM_SHUFFLE(3,3,3,3));
+
+  const __m128 d_adj_c = detail::mat2_sse_adj_multiply(d, c);
+  const __m128 a_adj_b = detail::mat2_sse_adj_multiply(a, b);
+
+  // Adjugates of the inverse's blocks.
+  __m128 x = detail::sse_multiply_sub(det_d, a, detail::mat2_sse_multiply(b, d_adj_c));
+  __m128 w = detail::sse_multiply_sub(det_a, d, detail::mat2_sse_multiply(c, a_adj_b));
+  __m128 y = detail::sse_multiply_sub(det_b, c, detail::mat2_sse_multiply_adj(d, a_adj_b));
+  __m128 z = detail::sse_multiply_sub(det_c, b, detail::mat2_sse_multiply_adj(a, d_adj_c));
+
+  // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+  __m128 trace = _mm_mul_ps(a_adj_b, _mm_shuffle_ps(d_adj_c, d_adj_c, _MM_SHUFFLE(3,1,2,0)));
+  trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(2,3,0,1)));
+  trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1,0,3,2)));
+
+  const __m128 det_m = _mm_sub_ps(
+    _mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)),
+    trace
+  );
+
+  assert(_mm_cvtss_f32(det_m) != 0);
+
+  const __m128 adj_sign   = _mm_setr_ps(1.f, -1.f, -1.f, 1.f);
+  const __m128 one_over_det = _mm_div_ps(adj_sign, det_m);
+
+  x = _mm_mul_ps(x, one_over_det);
+  y = _mm_mul_ps(y, one_over_det);
+  z = _mm_mul_ps(z, one_over_det);
+  w = _mm_mul_ps(w, one_over_det);
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  // Adjugate shuffle and store shuffle are combined.
+  internal_mat->simd_vec[0] = _mm_shuffle_ps(x, y, _MM_SHUFFLE(1,3,1,3));
+  internal_mat->simd_vec[1] = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0,2,0,2));
+  internal_mat->simd_vec[2] = _mm_shuffle_ps(z, w, _MM_SHUFFLE(1,3,1,3));
+  internal_mat->simd_vec[3] = _mm_shuffle_ps(z, w, _MM_SHUFFLE(0,2,0,2));
+
+  return return_mat;
+}
+
+
+mat4
+mat4_get_inverse_affine(const mat4 &to_inverse)
+{
+  const detail::internal_mat4 *to_i = reinterpret_cast<const detail::internal_mat4*>(&to_inverse);
+
+  // Rows of the 3x3 are orthogonal, so the inverse is the transpose
+  // with each column divided by that row's squared length.
+  __m128 row_0 = to_i->simd_vec[0];
+  __m128 row_1 = to_i->simd_vec[1];
+  __m128 row_2 = to_i->simd_vec[2];
+  __m128 row_3 = _mm_setzero_ps();
+
+  _MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+
+  const __m128 length_sq = detail::sse_multiply_add(
+    row_2, row_2,
+    detail::sse_multiply_add(row_1, row_1, _mm_mul_ps(row_0, row_0))
+  );
+
+  assert(_mm_movemask_ps(_mm_cmpeq_ps(length_sq, _mm_setzero_ps())) == 0x8);
+
+  // Last lane is 0 so it is bumped to 1 to keep the w column at 0.
+  const __m128 one_over_sq = _mm_div_ps(
+    _mm_set1_ps(1.f),
+    _mm_add_ps(length_sq, _mm_setr_ps(0.f, 0.f, 0.f, 1.f))
+  );
+
+  const __m128 inv_0 = _mm_mul_ps(row_0, one_over_sq);
+  const __m128 inv_1 = _mm_mul_ps(row_1, one_over_sq);
+  const __m128 inv_2 = _mm_mul_ps(row_2, one_over_sq);
+
+  // Back transform the translation.
+  const __m128 pos = to_i->simd_vec[3];
+  const __m128 pos_x = _mm_shuffle_ps(pos, pos, _MM_SHUFFLE(0,0,0,0));
+  const __m128 pos_y = _mm_shuffle_ps(pos, pos, _MM_SHUFFLE(1,1,1,1));
+  const __m128 pos_z = _mm_shuffle_ps(pos, pos, _MM_SHUFFLE(2,2,2,2));
+
+  const __m128 moved = detail::sse_multiply_add(
+    pos_z, inv_2,
+    detail::sse_multiply_add(pos_y, inv_1, _mm_mul_ps(pos_x, inv_0))
+  );
+
+  mat4 return_mat;
+  detail::internal_mat4 *internal_mat = reinterpret_cast<detail::internal_mat4*>(&return_mat);
+
+  internal_mat->simd_vec[0] = inv_0;
+  internal_mat->simd_vec[1] = inv_1;
+  internal_mat->simd_vec[2] = inv_2;
+  internal_mat->simd_vec[3] = detail::sse_blend_w(_mm_sub_ps(_mm_setzero_ps(), moved), _mm_set1_ps(1.f));
+
+  return return_mat;
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // use sse
+#endif // inc guard
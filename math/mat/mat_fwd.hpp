@@ -10,6 +10,7 @@ _MATH_NS_OPEN
 
 class mat3;
 class mat4;
+class mat34;
 
 
 _MATH_NS_CLOSE
@@ -8,6 +8,7 @@
 
 
 #include "../detail/detail.hpp"
+#include "../vec/vec_types.hpp"
 
 
 _MATH_NS_OPEN
@@ -18,12 +19,49 @@ class mat3
 	float data[9];
 };
 
-class mat4
+namespace detail
+{
+  // Storage is a base of mat4 so the impl can reach it without aliasing issues.
+  struct alignas(16) internal_mat4
+  {
+    union
+    {
+      SIMD_TYPE simd_vec[4]; // rows
+      float data[16];
+    };
+  };
+}
+
+
+class mat4 : detail::internal_mat4
+{
+};
+
+
+namespace detail
+{
+  // The first three columns of a mat4, a register each, translation in w.
+  struct alignas(16) internal_mat34
+  {
+    union
+    {
+      SIMD_TYPE simd_vec[3]; // columns
+      float data[12];
+    };
+  };
+}
+
+
+class mat34 : detail::internal_mat34
 {
-	float data[16];
 };
 
 
+static_assert(sizeof(mat3) == 36 && alignof(mat3) == 4, "mat3 layout differs by ISA level");
+static_assert(sizeof(mat4) == 64 && alignof(mat4) == 16, "mat4 layout differs by ISA level");
+static_assert(sizeof(mat34) == 48 && alignof(mat34) == 16, "mat34 layout differs by ISA level");
+
+
 _MATH_NS_CLOSE
 
 
@@ -10,9 +10,12 @@
 #include "vec/vec.hpp"
 #include "mat/mat.hpp"
 #include "quat/quat.hpp"
+#include "quat/dual_quat.hpp"
 #include "transform/transform.hpp"
+#include "transform/transform_hierarchy.hpp"
 #include "geometry/geometry.hpp"
 #include "general/general.hpp"
+#include "dispatch/dispatch.hpp"
 
 
 #endif // inc guard
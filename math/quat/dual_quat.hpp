@@ -0,0 +1,310 @@
+#ifndef DUAL_QUAT_INCLUDED_E29BE445_9EFE_4570_8C0B_B312354D667E
+#define DUAL_QUAT_INCLUDED_E29BE445_9EFE_4570_8C0B_B312354D667E
+
+
+/*
+  Dual Quaternion
+  A rotation and translation in two quats, for skinning. Blending
+  dual quats keeps the volume around twisting joints where blending
+  matrices collapses it, and a palette entry is 8 floats not 16.
+  Scale is not carried, it is dropped on the way in.
+*/
+
+
+#include "../detail/detail.hpp"
+#include "quat_types.hpp"
+#include "quat.hpp"
+#include "../vec/vec3.hpp"
+#include "../vec/vec3x4.hpp"
+#include "../mat/mat4.hpp"
+#include "../transform/transform.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+
+
+_MATH_NS_OPEN
+
+
+// Interface
+
+inline dual_quat        dual_quat_init();
+inline dual_quat        dual_quat_init(const quat rotation, const vec3 translation);
+inline dual_quat        dual_quat_init_with_transform(const transform &transform); // Rigid only, scale is dropped. Asserts unit scale in debug.
+inline dual_quat        dual_quat_init_with_mat4(const mat4 &matrix); // Rigid only, scale and reflection are dropped. Asserts neither in debug.
+
+inline dual_quat        dual_quat_multiply(const dual_quat &child, const dual_quat &parent); // As transform_inherited.
+inline dual_quat        dual_quat_normalize(const dual_quat &to_normalize);
+inline vec3             dual_quat_transform_point(const dual_quat &dq, const vec3 point);
+inline vec3             dual_quat_transform_direction(const dual_quat &dq, const vec3 dir);
+
+inline quat             dual_quat_get_rotation(const dual_quat &dq);
+inline vec3             dual_quat_get_translation(const dual_quat &dq);
+inline mat4             dual_quat_get_world_matrix(const dual_quat &dq);
+
+/*
+  Skins vertex_count vertices, packed xyz. Each vertex has four joint
+  indices into the palette and four weights, unused slots take a weight
+  of zero. normals may be null, then out_normals is not written.
+  Vertices are moved four at a time with vec3x4.
+*/
+inline void             dual_quat_skin(const dual_quat palette[], const float in_positions[], const float in_normals[], const uint16_t joints[], const float weights[], float out_positions[], float out_normals[], const size_t vertex_count);
+
+
+// Impl
+
+dual_quat
+dual_quat_init()
+{
+  return dual_quat{quat_init(), quat_init(0.f, 0.f, 0.f, 0.f)};
+}
+
+
+dual_quat
+dual_quat_init(const quat rotation, const vec3 translation)
+{
+  const quat trans = quat_init(vec3_get_x(translation), vec3_get_y(translation), vec3_get_z(translation), 0.f);
+
+  return dual_quat{rotation, quat_scale(quat_multiply(rotation, trans), 0.5f)};
+}
+
+
+dual_quat
+dual_quat_init_with_transform(const transform &transform)
+{
+  // A reflected mat4 comes through here as a negative x scale.
+  assert(vec3_is_near(transform.scale, vec3_one(), 1e-3f));
+
+  return dual_quat_init(transform.rotation, transform.position);
+}
+
+
+dual_quat
+dual_quat_init_with_mat4(const mat4 &matrix)
+{
+  return dual_quat_init_with_transform(transform_init_from_world_matrix(matrix));
+}
+
+
+dual_quat
+dual_quat_multiply(const dual_quat &child, const dual_quat &parent)
+{
+  return dual_quat{
+    quat_multiply(child.real, parent.real),
+    detail::quat_blend(quat_multiply(child.real, parent.dual), 1.f, quat_multiply(child.dual, parent.real), 1.f)
+  };
+}
+
+
+dual_quat
+dual_quat_normalize(const dual_quat &to_normalize)
+{
+  const float inv_length = 1.f / quat_length(to_normalize.real);
+
+  return dual_quat{quat_scale(to_normalize.real, inv_length), quat_scale(to_normalize.dual, inv_length)};
+}
+
+
+vec3
+dual_quat_transform_point(const dual_quat &dq, const vec3 point)
+{
+  return vec3_add(quat_rotate_point(dq.real, point), dual_quat_get_translation(dq));
+}
+
+
+vec3
+dual_quat_transform_direction(const dual_quat &dq, const vec3 dir)
+{
+  return quat_rotate_point(dq.real, dir);
+}
+
+
+quat
+dual_quat_get_rotation(const dual_quat &dq)
+{
+  return dq.real;
+}
+
+
+vec3
+dual_quat_get_translation(const dual_quat &dq)
+{
+  const quat trans = quat_multiply(quat_conjugate(dq.real), dq.dual);
+
+  return vec3_scale(vec3_init(quat_get_x(trans), quat_get_y(trans), quat_get_z(trans)), 2.f);
+}
+
+
+mat4
+dual_quat_get_world_matrix(const dual_quat &dq)
+{
+  return mat4_init_with_trs(dual_quat_get_translation(dq), vec3_one(), dq.real);
+}
+
+
+namespace detail
+{
+  // Four dual quats as structure of arrays.
+  struct dual_quat_skin_lanes
+  {
+    vec3x4  real;
+    floatx4 real_w;
+    vec3x4  dual;
+    floatx4 dual_w;
+  };
+
+
+  // One joint slot of four vertices as lanes, group_joints has 4 indices a vertex.
+  inline dual_quat_skin_lanes
+  dual_quat_skin_gather(const dual_quat palette[], const uint16_t group_joints[16], const uint32_t slot)
+  {
+    const dual_quat *joints[4] = {
+      &palette[group_joints[slot]], &palette[group_joints[4 + slot]],
+      &palette[group_joints[8 + slot]], &palette[group_joints[12 + slot]],
+    };
+
+    #ifdef MATH_ON_SSE2
+    __m128 real[4] = {joints[0]->real.simd_vec, joints[1]->real.simd_vec, joints[2]->real.simd_vec, joints[3]->real.simd_vec};
+    __m128 dual[4] = {joints[0]->dual.simd_vec, joints[1]->dual.simd_vec, joints[2]->dual.simd_vec, joints[3]->dual.simd_vec};
+
+    _MM_TRANSPOSE4_PS(real[0], real[1], real[2], real[3]);
+    _MM_TRANSPOSE4_PS(dual[0], dual[1], dual[2], dual[3]);
+
+    return dual_quat_skin_lanes{
+      vec3x4{{{real[0]}}, {{real[1]}}, {{real[2]}}},
+      floatx4{{real[3]}},
+      vec3x4{{{dual[0]}}, {{dual[1]}}, {{dual[2]}}},
+      floatx4{{dual[3]}},
+    };
+    #else
+    dual_quat_skin_lanes lanes;
+
+    for(uint32_t lane = 0; lane < 4; ++lane)
+    {
+      lanes.real.x.data[lane] = quat_get_x(joints[lane]->real);
+      lanes.real.y.data[lane] = quat_get_y(joints[lane]->real);
+      lanes.real.z.data[lane] = quat_get_z(joints[lane]->real);
+      lanes.real_w.data[lane] = quat_get_w(joints[lane]->real);
+      lanes.dual.x.data[lane] = quat_get_x(joints[lane]->dual);
+      lanes.dual.y.data[lane] = quat_get_y(joints[lane]->dual);
+      lanes.dual.z.data[lane] = quat_get_z(joints[lane]->dual);
+      lanes.dual_w.data[lane] = quat_get_w(joints[lane]->dual);
+    }
+
+    return lanes;
+    #endif
+  }
+
+
+  // Four vertices' weights, 4 a vertex, turned into a set of lanes per joint slot.
+  inline void
+  dual_quat_skin_weights(const float group_weights[16], floatx4 out_slots[4])
+  {
+    #ifdef MATH_ON_SSE2
+    __m128 rows[4] = {_mm_loadu_ps(&group_weights[0]), _mm_loadu_ps(&group_weights[4]), _mm_loadu_ps(&group_weights[8]), _mm_loadu_ps(&group_weights[12])};
+
+    _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+
+    for(uint32_t slot = 0; slot < 4; ++slot)
+    {
+      out_slots[slot] = floatx4{{rows[slot]}};
+    }
+    #else
+    for(uint32_t slot = 0; slot < 4; ++slot)
+    {
+      out_slots[slot] = floatx4_init(group_weights[slot], group_weights[4 + slot], group_weights[8 + slot], group_weights[12 + slot]);
+    }
+    #endif
+  }
+
+
+  // As quat_rotate_point, four points at once.
+  inline vec3x4
+  dual_quat_skin_rotate(const vec3x4 axis, const floatx4 w, const vec3x4 point)
+  {
+    const vec3x4 t = vec3x4_scale(vec3x4_cross(point, axis), 2.f);
+
+    return vec3x4_add(vec3x4_add(point, vec3x4_scale(t, w)), vec3x4_cross(t, axis));
+  }
+} // ns
+
+
+void
+dual_quat_skin(const dual_quat palette[], const float in_positions[], const float in_normals[], const uint16_t joints[], const float weights[], float out_positions[], float out_normals[], const size_t vertex_count)
+{
+  for(size_t i = 0; i < vertex_count; i += 4)
+  {
+    const size_t count = vertex_count - i < 4 ? vertex_count - i : 4;
+
+    const uint16_t *group_joints  = &joints[i * 4];
+    const float    *group_weights = &weights[i * 4];
+
+    // Lanes past the end copy the first vertex, their results aren't written.
+    uint16_t tail_joints[16];
+    float    tail_weights[16];
+
+    if(count < 4)
+    {
+      for(uint32_t k = 0; k < 16; ++k)
+      {
+        const size_t vertex = i + ((k / 4) < count ? (k / 4) : 0);
+
+        tail_joints[k]  = joints[vertex * 4 + (k % 4)];
+        tail_weights[k] = weights[vertex * 4 + (k % 4)];
+      }
+
+      group_joints  = tail_joints;
+      group_weights = tail_weights;
+    }
+
+    floatx4 slot_weights[4];
+    detail::dual_quat_skin_weights(group_weights, slot_weights);
+
+    const detail::dual_quat_skin_lanes first = detail::dual_quat_skin_gather(palette, group_joints, 0);
+
+    vec3x4  real   = vec3x4_scale(first.real, slot_weights[0]);
+    floatx4 real_w = floatx4_multiply(first.real_w, slot_weights[0]);
+    vec3x4  dual   = vec3x4_scale(first.dual, slot_weights[0]);
+    floatx4 dual_w = floatx4_multiply(first.dual_w, slot_weights[0]);
+
+    // Joints facing away from the first take the other sign, or the blend goes the long way round.
+    for(uint32_t j = 1; j < 4; ++j)
+    {
+      const detail::dual_quat_skin_lanes joint = detail::dual_quat_skin_gather(palette, group_joints, j);
+
+      const floatx4 facing = floatx4_add(vec3x4_dot(first.real, joint.real), floatx4_multiply(first.real_w, joint.real_w));
+      const floatx4 weight = floatx4_copy_sign(slot_weights[j], facing);
+
+      real   = vec3x4_add(real, vec3x4_scale(joint.real, weight));
+      real_w = floatx4_add(real_w, floatx4_multiply(joint.real_w, weight));
+      dual   = vec3x4_add(dual, vec3x4_scale(joint.dual, weight));
+      dual_w = floatx4_add(dual_w, floatx4_multiply(joint.dual_w, weight));
+    }
+
+    // As dual_quat_normalize.
+    const floatx4 inv_length = floatx4_divide(floatx4_init(1.f), floatx4_sqrt(floatx4_add(vec3x4_dot(real, real), floatx4_multiply(real_w, real_w))));
+
+    real   = vec3x4_scale(real, inv_length);
+    real_w = floatx4_multiply(real_w, inv_length);
+    dual   = vec3x4_scale(dual, inv_length);
+    dual_w = floatx4_multiply(dual_w, inv_length);
+
+    // As dual_quat_get_translation, 2 * conjugate(real) * dual written out.
+    const vec3x4 translation = vec3x4_scale(vec3x4_subtract(vec3x4_subtract(vec3x4_scale(dual, real_w), vec3x4_scale(real, dual_w)), vec3x4_cross(real, dual)), 2.f);
+
+    const vec3x4 positions = detail::dual_quat_skin_rotate(real, real_w, vec3x4_init_with_xyz_array(&in_positions[i * 3], count));
+    vec3x4_to_xyz_array(vec3x4_add(positions, translation), &out_positions[i * 3], count);
+
+    if(in_normals)
+    {
+      const vec3x4 normals = detail::dual_quat_skin_rotate(real, real_w, vec3x4_init_with_xyz_array(&in_normals[i * 3], count));
+      vec3x4_to_xyz_array(normals, &out_normals[i * 3], count);
+    }
+  }
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // inc guard
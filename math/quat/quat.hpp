@@ -13,6 +13,7 @@
 #include "../general/general.hpp"
 #include "../mat/mat4.hpp"
 #include "../mat/mat3.hpp"
+#include "../mat/mat4_batch.hpp"
 #include "../vec/vec3.hpp"
 
 
@@ -32,8 +33,17 @@ inline quat             quat_conjugate(const quat to_conj);
 inline quat             quat_multiply(const quat left, const quat right);
 inline quat             quat_multiply(const quat a, const quat b, const quat c);
 inline quat             quat_normalize(const quat to_normalize);
+inline quat             quat_scale(const quat to_scale, const float scale);
 inline float            quat_length(const quat to_length);
+inline float            quat_dot(const quat a, const quat b);
 inline vec3             quat_rotate_point(const quat rotation, const vec3 point);
+inline void             quat_rotate_points(const quat rotation, const float in_xyz[], const size_t in_stride, float out_xyz[], const size_t out_stride, const size_t count);
+
+// Interpolation, all take the shortest path.
+inline quat             quat_nlerp(const quat start, const quat end, const float dt);
+inline quat             quat_slerp(const quat start, const quat end, const float dt);
+inline quat             quat_slerp_fast(const quat start, const quat end, const float dt); // No trig, each component within 4e-5 of an exact slerp of unit quats.
+inline void             quat_slerp_array(const quat start[], const quat end[], const float dt[], quat out[], const size_t count); // As quat_slerp_fast.
 
 inline mat3             quat_get_rotation_matrix(const quat to_mat3);
 inline vec3             quat_get_axis();
@@ -54,36 +64,138 @@ inline float            get_z(const quat quat) { return quat_get_z(quat); }
 inline float            get_w(const quat quat) { return quat_get_w(quat); }
 
 
-// Impl
+// Shared impl
 
 namespace detail
 {
-  struct internal_quat
+  /*
+    Shepperd's method. The largest of w, x, y, z is picked from the
+    diagonal and is the only square root, the other three come from
+    sums and differences off the diagonal, so they carry their own
+    signs. rot is a pure rotation, row major as quat_get_rotation_matrix.
+    Ties go w, x, y then z, w is kept positive.
+  */
+  inline quat
+  quat_init_with_rotation_array(const float rot[9])
   {
+    const float t_w = 1.f + rot[0] + rot[4] + rot[8];
+    const float t_x = 1.f + rot[0] - rot[4] - rot[8];
+    const float t_y = 1.f - rot[0] + rot[4] - rot[8];
+    const float t_z = 1.f - rot[0] - rot[4] + rot[8];
+
+    const float diff_x = rot[7] - rot[5];
+    const float diff_y = rot[2] - rot[6];
+    const float diff_z = rot[3] - rot[1];
+    const float sum_xy = rot[1] + rot[3];
+    const float sum_xz = rot[2] + rot[6];
+    const float sum_yz = rot[5] + rot[7];
+
     float x, y, z, w;
-  };
-}
 
+    // The four t's sum to 4, the largest is at least 1.
+    if(t_w >= t_x && t_w >= t_y && t_w >= t_z)
+    {
+      const float root = MATH_NS_NAME::sqrt(t_w);
+      const float f    = 0.5f / root;
+
+      w = 0.5f * root; x = diff_x * f; y = diff_y * f; z = diff_z * f;
+    }
+    else if(t_x >= t_y && t_x >= t_z)
+    {
+      const float root = MATH_NS_NAME::sqrt(t_x);
+      const float f    = 0.5f / root;
+
+      w = diff_x * f; x = 0.5f * root; y = sum_xy * f; z = sum_xz * f;
+    }
+    else if(t_y >= t_z)
+    {
+      const float root = MATH_NS_NAME::sqrt(t_y);
+      const float f    = 0.5f / root;
+
+      w = diff_y * f; x = sum_xy * f; y = 0.5f * root; z = sum_yz * f;
+    }
+    else
+    {
+      const float root = MATH_NS_NAME::sqrt(t_z);
+      const float f    = 0.5f / root;
+
+      w = diff_z * f; x = sum_xz * f; y = sum_yz * f; z = 0.5f * root;
+    }
+
+    return w < 0.f ? quat_init(-x, -y, -z, -w) : quat_init(x, y, z, w);
+  }
 
-quat
-quat_init()
-{
-  return quat_init(0,0,0,1);
-}
 
+  // (a * a_weight) + (b * b_weight)
+  inline quat quat_blend(const quat a, const float a_weight, const quat b, const float b_weight);
 
-quat
-quat_init(const float x, const float y, const float z, const float w)
-{
-  quat return_quat;
-  detail::internal_quat *internal_quat = reinterpret_cast<detail::internal_quat*>(&return_quat);
 
-  internal_quat->x = x;
-  internal_quat->y = y;
-  internal_quat->z = z;
-  internal_quat->w = w;
+  /*
+    Terms for quat_slerp_fast, from Eberly "A Fast and Accurate
+    Algorithm for Computing SLERP". sin(t * angle) / sin(angle) is a
+    series in (cos(angle) - 1), u = 1 / (n(2n + 1)), v = n / (2n + 1).
+    The last pair is scaled by mu to take up the truncated terms.
+    The two weights are off by 3.8e-5 between them at worst, near
+    cos(angle) 0.13 and dt 0.5, which bounds each component of the
+    result. bench/quat_slerp.cpp checks it against a double slerp.
+  */
+  MATH_CONSTEXPR uint32_t quat_slerp_fast_terms() { return 8; }
+
+  inline const float*
+  quat_slerp_fast_u()
+  {
+    static const float u[quat_slerp_fast_terms()]
+    {
+      1.f / (1 * 3), 1.f / (2 * 5), 1.f / (3 * 7), 1.f / (4 * 9),
+      1.f / (5 * 11), 1.f / (6 * 13), 1.f / (7 * 15), 1.85298109240830f / (8 * 17),
+    };
+
+    return u;
+  }
+
+
+  inline const float*
+  quat_slerp_fast_v()
+  {
+    static const float v[quat_slerp_fast_terms()]
+    {
+      1.f / 3, 2.f / 5, 3.f / 7, 4.f / 9,
+      5.f / 11, 6.f / 13, 7.f / 15, 1.85298109240830f * 8 / 17,
+    };
+
+    return v;
+  }
+
+
+  // cos_angle is positive, the caller flips end for the shortest path.
+  inline void
+  quat_slerp_fast_weights(const float cos_angle, const float dt, float &start_weight, float &end_weight)
+  {
+    const float *u = quat_slerp_fast_u();
+    const float *v = quat_slerp_fast_v();
 
-  return return_quat;
+    const float cos_minus_one = cos_angle - 1.f;
+    const float start_dt      = 1.f - dt;
+
+    float start_sum = 1.f;
+    float end_sum   = 1.f;
+
+    for(uint32_t i = quat_slerp_fast_terms(); i-- > 0;)
+    {
+      start_sum = 1.f + (((u[i] * start_dt * start_dt) - v[i]) * cos_minus_one * start_sum);
+      end_sum   = 1.f + (((u[i] * dt * dt) - v[i]) * cos_minus_one * end_sum);
+    }
+
+    start_weight = start_dt * start_sum;
+    end_weight   = dt * end_sum;
+  }
+} // ns
+
+
+quat
+quat_init()
+{
+  return quat_init(0,0,0,1);
 }
 
 
@@ -102,15 +214,6 @@ quat_init_with_axis_angle(const float x, const float y, const float z, const flo
 }
 
 
-void
-quat_to_array(const quat to_array, float out[4])
-{
-  const detail::internal_quat *array = reinterpret_cast<const detail::internal_quat*>(&to_array);
-  
-  memcpy(out, array, sizeof(float) * 4);
-}
-
-
 quat
 quat_init_with_axis_angle(const vec3 axis, const float theta_radians)
 {
@@ -144,80 +247,73 @@ quat_init_with_euler_angles(const float pitch_radians, const float yaw_radians,
 quat
 quat_init_with_mat3(const mat3 &mat)
 {
-  const float w = MATH_NS_NAME::sqrt(MATH_NS_NAME::max( 0.f, 1 + mat3_get(mat, 0,0) + mat3_get(mat, 1,1) + mat3_get(mat, 2,2) )) * 0.5f;
-  const float x = MATH_NS_NAME::sqrt(MATH_NS_NAME::max( 0.f, 1 + mat3_get(mat, 0,0) - mat3_get(mat, 1,1) - mat3_get(mat, 2,2) )) * 0.5f;
-  const float y = MATH_NS_NAME::sqrt(MATH_NS_NAME::max( 0.f, 1 - mat3_get(mat, 0,0) + mat3_get(mat, 1,1) - mat3_get(mat, 2,2) )) * 0.5f;
-  const float z = MATH_NS_NAME::sqrt(MATH_NS_NAME::max( 0.f, 1 - mat3_get(mat, 0,0) - mat3_get(mat, 1,1) + mat3_get(mat, 2,2) )) * 0.5f;
-  
-  const float q_x = x * MATH_NS_NAME::sign(mat3_get(mat,2,1) - mat3_get(mat,1,2));
-  const float q_y = y * MATH_NS_NAME::sign(mat3_get(mat,0,2) - mat3_get(mat,2,0));
-  const float q_z = z * MATH_NS_NAME::sign(mat3_get(mat,1,0) - mat3_get(mat,0,1));
-  
-  return quat_init(q_x, q_y, q_z, w);
-}
-
+  float rot[9];
+  mat3_to_array(mat, rot);
 
-quat
-quat_conjugate(const quat to_conj)
-{
-  const detail::internal_quat *conj_quat = reinterpret_cast<const detail::internal_quat*>(&to_conj);
-  return quat_init(-conj_quat->x, -conj_quat->y, -conj_quat->z, conj_quat->w);
+  return detail::quat_init_with_rotation_array(rot);
 }
 
 
 quat
-quat_multiply(const quat left, const quat right)
+quat_multiply(const quat a, const quat b, const quat c)
 {
-  const detail::internal_quat *left_quat  = reinterpret_cast<const detail::internal_quat*>(&left);
-  const detail::internal_quat *right_quat = reinterpret_cast<const detail::internal_quat*>(&right);
-
-  const float w = (left_quat->w * right_quat->w) - (left_quat->x * right_quat->x) - (left_quat->y * right_quat->y) - (left_quat->z * right_quat->z);
-  const float x = (left_quat->w * right_quat->x) + (left_quat->x * right_quat->w) + (left_quat->y * right_quat->z) - (left_quat->z * right_quat->y);
-  const float y = (left_quat->w * right_quat->y) + (left_quat->y * right_quat->w) + (left_quat->z * right_quat->x) - (left_quat->x * right_quat->z);
-  const float z = (left_quat->w * right_quat->z) + (left_quat->z * right_quat->w) + (left_quat->x * right_quat->y) - (left_quat->y * right_quat->x);
-
-  return quat_init(x, y, z, w);
+  return quat_multiply(a, quat_multiply(b, c));
 }
 
 
 quat
-quat_multiply(const quat a, const quat b, const quat c)
+quat_nlerp(const quat start, const quat end, const float dt)
 {
-  return quat_multiply(a, quat_multiply(b, c));
+  const float end_weight = quat_dot(start, end) < 0.f ? -dt : dt;
+
+  return quat_normalize(detail::quat_blend(start, 1.f - dt, end, end_weight));
 }
 
 
 quat
-quat_normalize(const quat to_normalize)
+quat_slerp(const quat start, const quat end, const float dt)
 {
-  const detail::internal_quat *internal_quat = reinterpret_cast<const detail::internal_quat*>(&to_normalize);
+  const float cos_angle = quat_dot(start, end);
+  const float end_sign  = cos_angle < 0.f ? -1.f : 1.f;
 
-  const float length = quat_length(to_normalize);
-  assert(length); // Can't have zero length.
+  // sin(angle) heads to zero, but nlerp is exact enough there.
+  if(cos_angle * end_sign > 0.9995f)
+  {
+    return quat_nlerp(start, end, dt);
+  }
 
-  const float w = internal_quat->w / length;
-  const float x = internal_quat->x / length;
-  const float y = internal_quat->y / length;
-  const float z = internal_quat->z / length;
+  const float angle        = MATH_NS_NAME::a_cos(cos_angle * end_sign);
+  const float inv_sin      = 1.f / MATH_NS_NAME::sin(angle);
+  const float start_weight = MATH_NS_NAME::sin((1.f - dt) * angle) * inv_sin;
+  const float end_weight   = MATH_NS_NAME::sin(dt * angle) * inv_sin * end_sign;
 
-  return quat_init(x,y,z,w);
+  return detail::quat_blend(start, start_weight, end, end_weight);
 }
 
 
-float
-quat_length(const quat to_length)
+quat
+quat_slerp_fast(const quat start, const quat end, const float dt)
 {
-  const detail::internal_quat *length_quat = reinterpret_cast<const detail::internal_quat*>(&to_length);
-  return MATH_NS_NAME::sqrt((length_quat->w * length_quat->w) + (length_quat->x * length_quat->x) + (length_quat->y * length_quat->y) + (length_quat->z * length_quat->z));
+  const float cos_angle = quat_dot(start, end);
+
+  float start_weight, end_weight;
+  detail::quat_slerp_fast_weights(MATH_NS_NAME::abs(cos_angle), dt, start_weight, end_weight);
+
+  return detail::quat_blend(start, start_weight, end, cos_angle < 0.f ? -end_weight : end_weight);
 }
 
 
-vec3
-quat_rotate_point(const quat rotation, const vec3 point)
+/*
+  Same as rotating by a matrix from quat_get_rotation_matrix, strides
+  are in floats as mat4_transform_points. Over an array building the
+  matrix once is cheaper than quat_rotate_point for every point.
+*/
+void
+quat_rotate_points(const quat rotation, const float in_xyz[], const size_t in_stride, float out_xyz[], const size_t out_stride, const size_t count)
 {
-  const auto rot_mat = quat_get_rotation_matrix(rotation);
+  const mat4 rot_mat = mat4_init_with_mat3(quat_get_rotation_matrix(rotation));
 
-  return mat3_multiply(point, rot_mat);
+  mat4_transform_directions(rot_mat, in_xyz, in_stride, out_xyz, out_stride, count);
 }
 
 
@@ -266,38 +362,6 @@ quat_get_rotation_matrix(const quat to_mat3)
 // }
 
 
-float
-quat_get_x(const quat quat)
-{
-  const detail::internal_quat *internal_quat = reinterpret_cast<const detail::internal_quat*>(&quat);
-  return internal_quat->x;
-}
-
-
-float
-quat_get_y(const quat quat)
-{
-  const detail::internal_quat *internal_quat = reinterpret_cast<const detail::internal_quat*>(&quat);
-  return internal_quat->y;
-}
-
-
-float
-quat_get_z(const quat quat)
-{
-  const detail::internal_quat *internal_quat = reinterpret_cast<const detail::internal_quat*>(&quat);
-  return internal_quat->z;
-}
-
-
-float
-quat_get_w(const quat quat)
-{
-  const detail::internal_quat *internal_quat = reinterpret_cast<const detail::internal_quat*>(&quat);
-  return internal_quat->w;
-}
-
-
 float
 quat_get(const quat quat, const uint32_t i)
 {
@@ -315,4 +379,17 @@ quat_get(const quat quat, const uint32_t i)
 _MATH_NS_CLOSE
 
 
+// What impl to use
+
+#ifdef MATH_ON_SSE2
+
+#include "quat_sse.inl"
+
+#else
+
+#include "quat_fallback.inl"
+
+#endif // Choose which impl to use.
+
+
 #endif // include guard
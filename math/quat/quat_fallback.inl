@@ -0,0 +1,177 @@
+#ifndef QUAT_FALLBACK_INCLUDED_CBBCC5D6_B3BB_43F7_883E_328A58818475
+#define QUAT_FALLBACK_INCLUDED_CBBCC5D6_B3BB_43F7_883E_328A58818475
+
+
+#include "../detail/detail.hpp"
+#include "quat_types.hpp"
+#include "../vec/vec3.hpp"
+#include "../general/general.hpp"
+#include <cstring>
+#include <assert.h>
+
+
+#ifdef MATH_ON_FPU
+
+
+/*
+  Quaternion
+  Quaternion fallback impl.
+*/
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  inline quat
+  quat_blend(const quat a, const float a_weight, const quat b, const float b_weight)
+  {
+    return quat_init(
+      (a.data[0] * a_weight) + (b.data[0] * b_weight),
+      (a.data[1] * a_weight) + (b.data[1] * b_weight),
+      (a.data[2] * a_weight) + (b.data[2] * b_weight),
+      (a.data[3] * a_weight) + (b.data[3] * b_weight)
+    );
+  }
+} // ns
+
+
+quat
+quat_init(const float x, const float y, const float z, const float w)
+{
+  quat return_quat;
+
+  return_quat.data[0] = x;
+  return_quat.data[1] = y;
+  return_quat.data[2] = z;
+  return_quat.data[3] = w;
+
+  return return_quat;
+}
+
+
+void
+quat_to_array(const quat to_array, float out[4])
+{
+  memcpy(out, to_array.data, sizeof(float) * 4);
+}
+
+
+quat
+quat_conjugate(const quat to_conj)
+{
+  return quat_init(-to_conj.data[0], -to_conj.data[1], -to_conj.data[2], to_conj.data[3]);
+}
+
+
+quat
+quat_multiply(const quat left, const quat right)
+{
+  const float *l = left.data;
+  const float *r = right.data;
+
+  // x, y, z, w are 0, 1, 2, 3.
+  const float w = (l[3] * r[3]) - (l[0] * r[0]) - (l[1] * r[1]) - (l[2] * r[2]);
+  const float x = (l[3] * r[0]) + (l[0] * r[3]) + (l[1] * r[2]) - (l[2] * r[1]);
+  const float y = (l[3] * r[1]) + (l[1] * r[3]) + (l[2] * r[0]) - (l[0] * r[2]);
+  const float z = (l[3] * r[2]) + (l[2] * r[3]) + (l[0] * r[1]) - (l[1] * r[0]);
+
+  return quat_init(x, y, z, w);
+}
+
+
+quat
+quat_normalize(const quat to_normalize)
+{
+  const float length = quat_length(to_normalize);
+  assert(length); // Can't have zero length.
+
+  const float w = to_normalize.data[3] / length;
+  const float x = to_normalize.data[0] / length;
+  const float y = to_normalize.data[1] / length;
+  const float z = to_normalize.data[2] / length;
+
+  return quat_init(x,y,z,w);
+}
+
+
+float
+quat_dot(const quat a, const quat b)
+{
+  return (a.data[0] * b.data[0]) + (a.data[1] * b.data[1]) + (a.data[2] * b.data[2]) + (a.data[3] * b.data[3]);
+}
+
+
+void
+quat_slerp_array(const quat start[], const quat end[], const float dt[], quat out[], const size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    out[i] = quat_slerp_fast(start[i], end[i], dt[i]);
+  }
+}
+
+
+vec3
+quat_rotate_point(const quat rotation, const vec3 point)
+{
+  /*
+    v + w*t + t x q.xyz, where t = 2(v x q.xyz), the point times
+    quat_get_rotation_matrix without building it.
+  */
+  const vec3 axis = vec3_init(rotation.data[0], rotation.data[1], rotation.data[2]);
+  const vec3 t    = vec3_scale(vec3_cross(point, axis), 2.f);
+
+  return vec3_add(vec3_add(point, vec3_scale(t, rotation.data[3])), vec3_cross(t, axis));
+}
+
+
+quat
+quat_scale(const quat to_scale, const float scale)
+{
+  return quat_init(to_scale.data[0] * scale, to_scale.data[1] * scale, to_scale.data[2] * scale, to_scale.data[3] * scale);
+}
+
+
+float
+quat_length(const quat to_length)
+{
+  return MATH_NS_NAME::sqrt((to_length.data[3] * to_length.data[3]) + (to_length.data[0] * to_length.data[0]) + (to_length.data[1] * to_length.data[1]) + (to_length.data[2] * to_length.data[2]));
+}
+
+
+float
+quat_get_x(const quat quat)
+{
+  return quat.data[0];
+}
+
+
+float
+quat_get_y(const quat quat)
+{
+  return quat.data[1];
+}
+
+
+float
+quat_get_z(const quat quat)
+{
+  return quat.data[2];
+}
+
+
+float
+quat_get_w(const quat quat)
+{
+  return quat.data[3];
+}
+
+
+
+_MATH_NS_CLOSE
+
+
+#endif // on fpu
+#endif // inc guard
@@ -9,6 +9,7 @@ _MATH_NS_OPEN
 
 
 struct quat;
+struct dual_quat;
 
 
 _MATH_NS_CLOSE
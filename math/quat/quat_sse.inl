@@ -0,0 +1,366 @@
+#ifndef QUAT_SSE_INCLUDED_5BCE8FD4_0F6D_42D1_8B58_E7B298AB9286
+#define QUAT_SSE_INCLUDED_5BCE8FD4_0F6D_42D1_8B58_E7B298AB9286
+
+
+#include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
+#include "quat_types.hpp"
+#include "../vec/vec3.hpp"
+#include "../general/general.hpp"
+#include <assert.h>
+
+
+#ifdef MATH_ON_SSE2
+
+
+/*
+  Quaternion
+  Quaternion sse impl.
+*/
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  inline quat
+  quat_blend(const quat a, const float a_weight, const quat b, const float b_weight)
+  {
+    const __m128 a_scaled = _mm_mul_ps(a.simd_vec, _mm_set1_ps(a_weight));
+    return quat{{sse_multiply_add(b.simd_vec, _mm_set1_ps(b_weight), a_scaled)}};
+  }
+
+
+  // quat_slerp_fast_weights for four lanes, sign of cos_angle is carried to end_weight.
+  inline void
+  quat_sse_slerp_fast_weights(const __m128 cos_angle, const __m128 dt, __m128 &start_weight, __m128 &end_weight)
+  {
+    const float *u = quat_slerp_fast_u();
+    const float *v = quat_slerp_fast_v();
+
+    const __m128 one           = _mm_set1_ps(1.f);
+    const __m128 end_sign      = _mm_and_ps(cos_angle, _mm_set1_ps(-0.f));
+    const __m128 cos_abs       = _mm_xor_ps(cos_angle, end_sign);
+    const __m128 cos_minus_one = _mm_sub_ps(cos_abs, one);
+
+    const __m128 start_dt      = _mm_sub_ps(one, dt);
+    const __m128 start_dt_sq   = _mm_mul_ps(start_dt, start_dt);
+    const __m128 dt_sq         = _mm_mul_ps(dt, dt);
+
+    __m128 start_sum = one;
+    __m128 end_sum   = one;
+
+    for(uint32_t i = quat_slerp_fast_terms(); i-- > 0;)
+    {
+      const __m128 u_i = _mm_set1_ps(u[i]);
+      const __m128 v_i = _mm_set1_ps(v[i]);
+
+      const __m128 start_term = _mm_mul_ps(sse_multiply_sub(u_i, start_dt_sq, v_i), cos_minus_one);
+      const __m128 end_term   = _mm_mul_ps(sse_multiply_sub(u_i, dt_sq, v_i), cos_minus_one);
+
+      start_sum = sse_multiply_add(start_term, start_sum, one);
+      end_sum   = sse_multiply_add(end_term, end_sum, one);
+    }
+
+    start_weight = _mm_mul_ps(start_dt, start_sum);
+    end_weight   = _mm_xor_ps(_mm_mul_ps(dt, end_sum), end_sign);
+  }
+
+
+  #ifdef MATH_ON_AVX
+
+  // Transpose the 4x4 in each 128 bit half, it is its own inverse.
+  inline void
+  quat_avx_transpose(__m256 &r0, __m256 &r1, __m256 &r2, __m256 &r3)
+  {
+    const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    const __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+    const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+    const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+
+    r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1,0,1,0));
+    r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3,2,3,2));
+    r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1,0,1,0));
+    r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3,2,3,2));
+  }
+
+
+  // Quat i in the low half, quat i + 4 in the high half.
+  inline __m256
+  quat_avx_load_pair(const quat arr[], const size_t i)
+  {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(arr[i].simd_vec), arr[i + 4].simd_vec, 1);
+  }
+
+
+  inline void
+  quat_avx_slerp_fast_weights(const __m256 cos_angle, const __m256 dt, __m256 &start_weight, __m256 &end_weight)
+  {
+    const float *u = quat_slerp_fast_u();
+    const float *v = quat_slerp_fast_v();
+
+    const __m256 one           = _mm256_set1_ps(1.f);
+    const __m256 end_sign      = _mm256_and_ps(cos_angle, _mm256_set1_ps(-0.f));
+    const __m256 cos_abs       = _mm256_xor_ps(cos_angle, end_sign);
+    const __m256 cos_minus_one = _mm256_sub_ps(cos_abs, one);
+
+    const __m256 start_dt      = _mm256_sub_ps(one, dt);
+    const __m256 start_dt_sq   = _mm256_mul_ps(start_dt, start_dt);
+    const __m256 dt_sq         = _mm256_mul_ps(dt, dt);
+
+    __m256 start_sum = one;
+    __m256 end_sum   = one;
+
+    for(uint32_t i = quat_slerp_fast_terms(); i-- > 0;)
+    {
+      const __m256 u_i = _mm256_set1_ps(u[i]);
+      const __m256 v_i = _mm256_set1_ps(v[i]);
+
+      const __m256 start_term = _mm256_mul_ps(avx_multiply_sub(u_i, start_dt_sq, v_i), cos_minus_one);
+      const __m256 end_term   = _mm256_mul_ps(avx_multiply_sub(u_i, dt_sq, v_i), cos_minus_one);
+
+      start_sum = avx_multiply_add(start_term, start_sum, one);
+      end_sum   = avx_multiply_add(end_term, end_sum, one);
+    }
+
+    start_weight = _mm256_mul_ps(start_dt, start_sum);
+    end_weight   = _mm256_xor_ps(_mm256_mul_ps(dt, end_sum), end_sign);
+  }
+
+  #endif // on avx
+} // ns
+
+
+quat
+quat_init(const float x, const float y, const float z, const float w)
+{
+  return quat{{_mm_setr_ps(x, y, z, w)}};
+}
+
+
+void
+quat_to_array(const quat to_array, float out[4])
+{
+  _mm_storeu_ps(out, to_array.simd_vec);
+}
+
+
+quat
+quat_conjugate(const quat to_conj)
+{
+  // Flip the sign bits of x, y and z.
+  const __m128 sign = _mm_setr_ps(-0.f, -0.f, -0.f, 0.f);
+  return quat{{_mm_xor_ps(to_conj.simd_vec, sign)}};
+}
+
+
+quat
+quat_multiply(const quat left, const quat right)
+{
+  /*
+    Each of left's components scales a shuffle of right, the signs of
+    the Hamilton product are xor'd in.
+    x: lw*rx + lx*rw + ly*rz - lz*ry
+    y: lw*ry - lx*rz + ly*rw + lz*rx
+    z: lw*rz + lx*ry - ly*rx + lz*rw
+    w: lw*rw - lx*rx - ly*ry - lz*rz
+  */
+  const __m128 l = left.simd_vec;
+  const __m128 r = right.simd_vec;
+
+  const __m128 lx = _mm_shuffle_ps(l, l, _MM_SHUFFLE(0,0,0,0));
+  const __m128 ly = _mm_shuffle_ps(l, l, _MM_SHUFFLE(1,1,1,1));
+  const __m128 lz = _mm_shuffle_ps(l, l, _MM_SHUFFLE(2,2,2,2));
+  const __m128 lw = _mm_shuffle_ps(l, l, _MM_SHUFFLE(3,3,3,3));
+
+  const __m128 r_wzyx = _mm_xor_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(0,1,2,3)), _mm_setr_ps(0.f, -0.f, 0.f, -0.f));
+  const __m128 r_zwxy = _mm_xor_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(1,0,3,2)), _mm_setr_ps(0.f, 0.f, -0.f, -0.f));
+  const __m128 r_yxwz = _mm_xor_ps(_mm_shuffle_ps(r, r, _MM_SHUFFLE(2,3,0,1)), _mm_setr_ps(-0.f, 0.f, 0.f, -0.f));
+
+  __m128 result = _mm_mul_ps(lw, r);
+  result = detail::sse_multiply_add(lx, r_wzyx, result);
+  result = detail::sse_multiply_add(ly, r_zwxy, result);
+  result = detail::sse_multiply_add(lz, r_yxwz, result);
+
+  return quat{{result}};
+}
+
+
+quat
+quat_normalize(const quat to_normalize)
+{
+  const __m128 dot    = detail::sse_dot4(to_normalize.simd_vec, to_normalize.simd_vec);
+  const __m128 len_sq = _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(0,0,0,0));
+
+  assert(_mm_cvtss_f32(len_sq) != 0); // Can't have zero length.
+
+  return quat{{_mm_mul_ps(to_normalize.simd_vec, detail::sse_rsqrt(len_sq))}};
+}
+
+
+float
+quat_dot(const quat a, const quat b)
+{
+  return _mm_cvtss_f32(detail::sse_dot4(a.simd_vec, b.simd_vec));
+}
+
+
+/*
+  Blends in structure of arrays form, each register holds one
+  component of four (or eight) quats so the dot product and weights
+  are plain lane wise math.
+*/
+void
+quat_slerp_array(const quat start[], const quat end[], const float dt[], quat out[], const size_t count)
+{
+  size_t i = 0;
+
+  #ifdef MATH_ON_AVX
+  for(; i + 8 <= count; i += 8)
+  {
+    __m256 ax = detail::quat_avx_load_pair(start, i + 0);
+    __m256 ay = detail::quat_avx_load_pair(start, i + 1);
+    __m256 az = detail::quat_avx_load_pair(start, i + 2);
+    __m256 aw = detail::quat_avx_load_pair(start, i + 3);
+    detail::quat_avx_transpose(ax, ay, az, aw);
+
+    __m256 bx = detail::quat_avx_load_pair(end, i + 0);
+    __m256 by = detail::quat_avx_load_pair(end, i + 1);
+    __m256 bz = detail::quat_avx_load_pair(end, i + 2);
+    __m256 bw = detail::quat_avx_load_pair(end, i + 3);
+    detail::quat_avx_transpose(bx, by, bz, bw);
+
+    __m256 cos_angle = _mm256_mul_ps(ax, bx);
+    cos_angle = detail::avx_multiply_add(ay, by, cos_angle);
+    cos_angle = detail::avx_multiply_add(az, bz, cos_angle);
+    cos_angle = detail::avx_multiply_add(aw, bw, cos_angle);
+
+    __m256 start_weight, end_weight;
+    detail::quat_avx_slerp_fast_weights(cos_angle, _mm256_loadu_ps(&dt[i]), start_weight, end_weight);
+
+    __m256 rx = detail::avx_multiply_add(bx, end_weight, _mm256_mul_ps(ax, start_weight));
+    __m256 ry = detail::avx_multiply_add(by, end_weight, _mm256_mul_ps(ay, start_weight));
+    __m256 rz = detail::avx_multiply_add(bz, end_weight, _mm256_mul_ps(az, start_weight));
+    __m256 rw = detail::avx_multiply_add(bw, end_weight, _mm256_mul_ps(aw, start_weight));
+    detail::quat_avx_transpose(rx, ry, rz, rw);
+
+    out[i + 0].simd_vec = _mm256_castps256_ps128(rx);
+    out[i + 1].simd_vec = _mm256_castps256_ps128(ry);
+    out[i + 2].simd_vec = _mm256_castps256_ps128(rz);
+    out[i + 3].simd_vec = _mm256_castps256_ps128(rw);
+    out[i + 4].simd_vec = _mm256_extractf128_ps(rx, 1);
+    out[i + 5].simd_vec = _mm256_extractf128_ps(ry, 1);
+    out[i + 6].simd_vec = _mm256_extractf128_ps(rz, 1);
+    out[i + 7].simd_vec = _mm256_extractf128_ps(rw, 1);
+  }
+  #endif
+
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128 ax = start[i + 0].simd_vec;
+    __m128 ay = start[i + 1].simd_vec;
+    __m128 az = start[i + 2].simd_vec;
+    __m128 aw = start[i + 3].simd_vec;
+    _MM_TRANSPOSE4_PS(ax, ay, az, aw);
+
+    __m128 bx = end[i + 0].simd_vec;
+    __m128 by = end[i + 1].simd_vec;
+    __m128 bz = end[i + 2].simd_vec;
+    __m128 bw = end[i + 3].simd_vec;
+    _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+
+    __m128 cos_angle = _mm_mul_ps(ax, bx);
+    cos_angle = detail::sse_multiply_add(ay, by, cos_angle);
+    cos_angle = detail::sse_multiply_add(az, bz, cos_angle);
+    cos_angle = detail::sse_multiply_add(aw, bw, cos_angle);
+
+    __m128 start_weight, end_weight;
+    detail::quat_sse_slerp_fast_weights(cos_angle, _mm_loadu_ps(&dt[i]), start_weight, end_weight);
+
+    __m128 rx = detail::sse_multiply_add(bx, end_weight, _mm_mul_ps(ax, start_weight));
+    __m128 ry = detail::sse_multiply_add(by, end_weight, _mm_mul_ps(ay, start_weight));
+    __m128 rz = detail::sse_multiply_add(bz, end_weight, _mm_mul_ps(az, start_weight));
+    __m128 rw = detail::sse_multiply_add(bw, end_weight, _mm_mul_ps(aw, start_weight));
+    _MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+
+    out[i + 0].simd_vec = rx;
+    out[i + 1].simd_vec = ry;
+    out[i + 2].simd_vec = rz;
+    out[i + 3].simd_vec = rw;
+  }
+
+  for(; i < count; ++i)
+  {
+    out[i] = quat_slerp_fast(start[i], end[i], dt[i]);
+  }
+}
+
+
+vec3
+quat_rotate_point(const quat rotation, const vec3 point)
+{
+  /*
+    v + w*t + t x q.xyz, where t = 2(v x q.xyz), the point times
+    quat_get_rotation_matrix without building it.
+  */
+  const __m128 q = rotation.simd_vec;
+  const __m128 v = point.simd_vec;
+  const __m128 w = _mm_shuffle_ps(q, q, _MM_SHUFFLE(3,3,3,3));
+
+  const __m128 cross = detail::sse_cross(v, q);
+  const __m128 t     = _mm_add_ps(cross, cross);
+
+  const __m128 rotated = detail::sse_multiply_add(w, t, v);
+
+  return vec3{{_mm_add_ps(rotated, detail::sse_cross(t, q))}};
+}
+
+
+quat
+quat_scale(const quat to_scale, const float scale)
+{
+  return quat{{_mm_mul_ps(to_scale.simd_vec, _mm_set1_ps(scale))}};
+}
+
+
+float
+quat_length(const quat to_length)
+{
+  return _mm_cvtss_f32(_mm_sqrt_ss(detail::sse_dot4(to_length.simd_vec, to_length.simd_vec)));
+}
+
+
+float
+quat_get_x(const quat quat)
+{
+  return _mm_cvtss_f32(quat.simd_vec);
+}
+
+
+float
+quat_get_y(const quat quat)
+{
+  return _mm_cvtss_f32(_mm_shuffle_ps(quat.simd_vec, quat.simd_vec, _MM_SHUFFLE(1,1,1,1)));
+}
+
+
+float
+quat_get_z(const quat quat)
+{
+  return _mm_cvtss_f32(_mm_shuffle_ps(quat.simd_vec, quat.simd_vec, _MM_SHUFFLE(2,2,2,2)));
+}
+
+
+float
+quat_get_w(const quat quat)
+{
+  return _mm_cvtss_f32(_mm_shuffle_ps(quat.simd_vec, quat.simd_vec, _MM_SHUFFLE(3,3,3,3)));
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // use sse
+#endif // inc guard
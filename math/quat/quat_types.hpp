@@ -4,21 +4,42 @@
 
 /*
   Quaternion type
+  Same layout as vec4, so one register holds it.
 */
 
 
 #include "../detail/detail.hpp"
+#include "../vec/vec_types.hpp"
 
 
 _MATH_NS_OPEN
 
 
-struct quat
+struct alignas(16) quat
 {
-	float data[4]; // x, y, z, w;
+  union
+  {
+    SIMD_TYPE simd_vec;
+    float data[4]; // x, y, z, w;
+  };
 };
 
 
+/*
+  Rigid transform as a rotation and a translation, the dual part is
+  half the rotation times the translation.
+*/
+struct dual_quat
+{
+  quat real;
+  quat dual;
+};
+
+
+static_assert(sizeof(quat) == 16 && alignof(quat) == 16, "quat layout differs by ISA level");
+static_assert(sizeof(dual_quat) == 32 && alignof(dual_quat) == 16, "dual_quat layout differs by ISA level");
+
+
 _MATH_NS_CLOSE
 
 
@@ -10,10 +10,14 @@
 
 
 #include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
 #include "../transform/transform_types.hpp"
 #include "../quat/quat.hpp"
 #include "../vec/vec3.hpp"
 #include "../mat/mat4.hpp"
+#include "../mat/mat34.hpp"
+#include <stddef.h>
+#include <string.h>
 
 
 _MATH_NS_OPEN
@@ -24,11 +28,23 @@ _MATH_NS_OPEN
 
 inline transform    transform_init();
 inline transform    transform_init(const vec3 position, const vec3 scale, const quat &rotation);
-inline transform    transform_init_from_world_matrix(const mat4 &matrix);
+inline transform    transform_init_from_world_matrix(const mat4 &matrix); // Reflections go on the x scale.
+inline void         transform_init_from_world_matrix_array(const mat4 matrices[], transform out[], const size_t count);
 inline mat4         transform_get_world_matrix(const transform &transform);
 inline void         transform_set_with_world_matrix(transform &transform, const mat4 &matrix);
 inline transform    transform_inherited(const transform &parent, const transform &child);
 
+// World matrix without the constant last column.
+inline mat34        transform_get_world_mat34(const transform &transform);
+inline transform    transform_init_from_mat34(const mat34 &matrix); // As transform_init_from_world_matrix.
+
+// Scale, then rotate, then translate, written straight from the terms.
+inline mat4         mat4_init_with_trs(const vec3 position, const vec3 scale, const quat &rotation);
+inline mat34        mat34_init_with_trs(const vec3 position, const vec3 scale, const quat &rotation);
+
+// out[i] = transform_get_world_matrix(transforms[i])
+inline void         transform_get_world_matrix_array(const transform transforms[], mat4 out[], const size_t count);
+
 
 // ----------------------------------------------------------------- [ Impl ] --
 
@@ -56,39 +72,231 @@ transform_init(const vec3 position, const vec3 scale, const quat &rotation)
 }
 
 
-transform
-transform_init_from_world_matrix(const mat4 &matrix)
+namespace detail
 {
-  // get position
-  const float x = mat4_get(matrix, 3, 0);
-  const float y = mat4_get(matrix, 3, 1);
-  const float z = mat4_get(matrix, 3, 2);
+  // Rows shorter than this have lost their direction.
+  MATH_CONSTEXPR float transform_degenerate_scale() { return 1e-12f; }
+
+
+  /*
+    Scale is the length of each of the top three rows, a negative
+    determinant means a reflection which is put on x. Rows with no
+    length are rebuilt around the others so the rotation is still a
+    rotation and the matrix round trips, with none left it's identity.
+  */
+  inline transform
+  transform_init_from_world_array(const float mat[16])
+  {
+    vec3 rows[3] = {
+      vec3_init(mat[0], mat[1], mat[2]),
+      vec3_init(mat[4], mat[5], mat[6]),
+      vec3_init(mat[8], mat[9], mat[10]),
+    };
+
+    float scale[3] = {
+      vec3_length(rows[0]),
+      vec3_length(rows[1]),
+      vec3_length(rows[2]),
+    };
+
+    if(vec3_dot(rows[0], vec3_cross(rows[1], rows[2])) < 0.f)
+    {
+      scale[0] = -scale[0];
+    }
+
+    uint32_t degenerate_count = 0;
+    uint32_t degenerate_row   = 0;
+    uint32_t kept_row         = 0;
+
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+      if(MATH_NS_NAME::abs(scale[i]) < transform_degenerate_scale())
+      {
+        ++degenerate_count;
+        degenerate_row = i;
+      }
+      else
+      {
+        rows[i] = vec3_scale(rows[i], 1.f / scale[i]);
+        kept_row = i;
+      }
+    }
+
+    const vec3 position  = vec3_init(mat[12], mat[13], mat[14]);
+    const vec3 scale_vec = vec3_init(scale[0], scale[1], scale[2]);
+
+    if(degenerate_count == 3)
+    {
+      return transform_init(position, scale_vec, quat_init());
+    }
+
+    if(degenerate_count == 2)
+    {
+      // Any basis around the kept row will do, use the axis it's least along.
+      const vec3 kept   = rows[kept_row];
+      const float abs_x = MATH_NS_NAME::abs(vec3_get_x(kept));
+      const float abs_y = MATH_NS_NAME::abs(vec3_get_y(kept));
+      const float abs_z = MATH_NS_NAME::abs(vec3_get_z(kept));
+
+      const vec3 helper = (abs_x <= abs_y && abs_x <= abs_z) ? vec3_init(1.f, 0.f, 0.f) :
+                          (abs_y <= abs_z) ? vec3_init(0.f, 1.f, 0.f) : vec3_init(0.f, 0.f, 1.f);
+
+      const vec3 next = vec3_normalize(vec3_cross(kept, helper));
+
+      rows[(kept_row + 1) % 3] = next;
+      rows[(kept_row + 2) % 3] = vec3_cross(kept, next);
+    }
+
+    if(degenerate_count == 1)
+    {
+      const vec3 next = rows[(degenerate_row + 1) % 3];
+      const vec3 last = rows[(degenerate_row + 2) % 3];
+
+      rows[degenerate_row] = vec3_normalize(vec3_cross(next, last));
+    }
+
+    float rot[9];
+
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+      rot[(i * 3) + 0] = vec3_get_x(rows[i]);
+      rot[(i * 3) + 1] = vec3_get_y(rows[i]);
+      rot[(i * 3) + 2] = vec3_get_z(rows[i]);
+    }
+
+    return transform_init(position, scale_vec, quat_init_with_rotation_array(rot));
+  }
+} // ns
 
-  const vec3 position = vec3_init(x, y, z);
 
-  // get scale.
-  const float s_x = MATH_NS_NAME::sign(mat4_get(matrix, 0, 0)) *
-                    MATH_NS_NAME::sqrt((mat4_get(matrix, 0, 0) * mat4_get(matrix, 0, 0)) +
-                               (mat4_get(matrix, 0, 1) * mat4_get(matrix, 0, 1)) +
-                               (mat4_get(matrix, 0, 2) * mat4_get(matrix, 0, 2)));
-
-  const float s_y = MATH_NS_NAME::sign(mat4_get(matrix, 1, 1)) *
-                    MATH_NS_NAME::sqrt((mat4_get(matrix, 1, 0) * mat4_get(matrix, 1, 0)) +
-                               (mat4_get(matrix, 1, 1) * mat4_get(matrix, 1, 1)) +
-                               (mat4_get(matrix, 1, 2) * mat4_get(matrix, 1, 2)));
+transform
+transform_init_from_world_matrix(const mat4 &matrix)
+{
+  float mat[16];
+  mat4_to_array(matrix, mat);
 
-  const float s_z = MATH_NS_NAME::sign(mat4_get(matrix, 2, 2)) *
-                    MATH_NS_NAME::sqrt((mat4_get(matrix, 2, 0) * mat4_get(matrix, 2, 0)) +
-                               (mat4_get(matrix, 2, 1) * mat4_get(matrix, 2, 1)) +
-                               (mat4_get(matrix, 2, 2) * mat4_get(matrix, 2, 2)));
+  return detail::transform_init_from_world_array(mat);
+}
 
-  const vec3 scale = vec3_init(s_x, s_y, s_z);
 
-  // get rotation.
-  const mat3 sub_mat  = mat4_get_sub_mat3(matrix);
-  const quat rotation = quat_init_with_mat3(sub_mat);
+void
+transform_init_from_world_matrix_array(const mat4 matrices[], transform out[], const size_t count)
+{
+  size_t i = 0;
+
+  #ifdef MATH_ON_SSE2
+  /*
+    Four at a time, each register holds one matrix term of four
+    matrices. Lanes with a degenerate scale are redone on the scalar
+    path, the rest pick their Shepperd case with masks.
+  */
+  const __m128 one      = _mm_set1_ps(1.f);
+  const __m128 half     = _mm_set1_ps(0.5f);
+  const __m128 sign_bit = _mm_set1_ps(-0.f);
+  const __m128 tiny     = _mm_set1_ps(detail::transform_degenerate_scale());
+
+  for(; i + 4 <= count; i += 4)
+  {
+    const detail::internal_mat4 *mats[4] = {
+      reinterpret_cast<const detail::internal_mat4*>(&matrices[i + 0]),
+      reinterpret_cast<const detail::internal_mat4*>(&matrices[i + 1]),
+      reinterpret_cast<const detail::internal_mat4*>(&matrices[i + 2]),
+      reinterpret_cast<const detail::internal_mat4*>(&matrices[i + 3]),
+    };
+
+    __m128 m00 = mats[0]->simd_vec[0], m01 = mats[1]->simd_vec[0], m02 = mats[2]->simd_vec[0], m03 = mats[3]->simd_vec[0];
+    __m128 m10 = mats[0]->simd_vec[1], m11 = mats[1]->simd_vec[1], m12 = mats[2]->simd_vec[1], m13 = mats[3]->simd_vec[1];
+    __m128 m20 = mats[0]->simd_vec[2], m21 = mats[1]->simd_vec[2], m22 = mats[2]->simd_vec[2], m23 = mats[3]->simd_vec[2];
+    _MM_TRANSPOSE4_PS(m00, m01, m02, m03);
+    _MM_TRANSPOSE4_PS(m10, m11, m12, m13);
+    _MM_TRANSPOSE4_PS(m20, m21, m22, m23);
+
+    // Scale, with reflections on x.
+    const __m128 cross_x = _mm_sub_ps(_mm_mul_ps(m11, m22), _mm_mul_ps(m12, m21));
+    const __m128 cross_y = _mm_sub_ps(_mm_mul_ps(m12, m20), _mm_mul_ps(m10, m22));
+    const __m128 cross_z = _mm_sub_ps(_mm_mul_ps(m10, m21), _mm_mul_ps(m11, m20));
+    const __m128 det     = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, cross_x), _mm_mul_ps(m01, cross_y)), _mm_mul_ps(m02, cross_z));
+    const __m128 reflect = _mm_and_ps(_mm_cmplt_ps(det, _mm_setzero_ps()), sign_bit);
+
+    const __m128 scale_x = _mm_xor_ps(_mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, m00), _mm_mul_ps(m01, m01)), _mm_mul_ps(m02, m02))), reflect);
+    const __m128 scale_y = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, m10), _mm_mul_ps(m11, m11)), _mm_mul_ps(m12, m12)));
+    const __m128 scale_z = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, m20), _mm_mul_ps(m21, m21)), _mm_mul_ps(m22, m22)));
+
+    const __m128 degenerate = _mm_or_ps(
+      _mm_cmplt_ps(_mm_andnot_ps(sign_bit, scale_x), tiny),
+      _mm_or_ps(_mm_cmplt_ps(scale_y, tiny), _mm_cmplt_ps(scale_z, tiny))
+    );
 
-  return transform_init(position, scale, rotation);
+    // Rotation rows.
+    const __m128 inv_x = _mm_div_ps(one, scale_x);
+    const __m128 inv_y = _mm_div_ps(one, scale_y);
+    const __m128 inv_z = _mm_div_ps(one, scale_z);
+
+    const __m128 r00 = _mm_mul_ps(m00, inv_x), r01 = _mm_mul_ps(m01, inv_x), r02 = _mm_mul_ps(m02, inv_x);
+    const __m128 r10 = _mm_mul_ps(m10, inv_y), r11 = _mm_mul_ps(m11, inv_y), r12 = _mm_mul_ps(m12, inv_y);
+    const __m128 r20 = _mm_mul_ps(m20, inv_z), r21 = _mm_mul_ps(m21, inv_z), r22 = _mm_mul_ps(m22, inv_z);
+
+    // Shepperd, as detail::quat_init_with_rotation_array.
+    const __m128 t_w = _mm_add_ps(_mm_add_ps(_mm_add_ps(one, r00), r11), r22);
+    const __m128 t_x = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(one, r00), r11), r22);
+    const __m128 t_y = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(one, r00), r11), r22);
+    const __m128 t_z = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(one, r00), r11), r22);
+
+    const __m128 is_w = _mm_and_ps(_mm_cmpge_ps(t_w, t_x), _mm_and_ps(_mm_cmpge_ps(t_w, t_y), _mm_cmpge_ps(t_w, t_z)));
+    const __m128 is_x = _mm_andnot_ps(is_w, _mm_and_ps(_mm_cmpge_ps(t_x, t_y), _mm_cmpge_ps(t_x, t_z)));
+    const __m128 is_y = _mm_andnot_ps(_mm_or_ps(is_w, is_x), _mm_cmpge_ps(t_y, t_z));
+
+    const __m128 t_max = detail::sse_select(is_w, t_w, detail::sse_select(is_x, t_x, detail::sse_select(is_y, t_y, t_z)));
+    const __m128 root  = _mm_sqrt_ps(t_max);
+    const __m128 f     = _mm_div_ps(half, root);
+    const __m128 big   = _mm_mul_ps(half, root);
+
+    const __m128 diff_x = _mm_mul_ps(_mm_sub_ps(r21, r12), f);
+    const __m128 diff_y = _mm_mul_ps(_mm_sub_ps(r02, r20), f);
+    const __m128 diff_z = _mm_mul_ps(_mm_sub_ps(r10, r01), f);
+    const __m128 sum_xy = _mm_mul_ps(_mm_add_ps(r01, r10), f);
+    const __m128 sum_xz = _mm_mul_ps(_mm_add_ps(r02, r20), f);
+    const __m128 sum_yz = _mm_mul_ps(_mm_add_ps(r12, r21), f);
+
+    __m128 q_w = detail::sse_select(is_w, big, detail::sse_select(is_x, diff_x, detail::sse_select(is_y, diff_y, diff_z)));
+    __m128 q_x = detail::sse_select(is_w, diff_x, detail::sse_select(is_x, big, detail::sse_select(is_y, sum_xy, sum_xz)));
+    __m128 q_y = detail::sse_select(is_w, diff_y, detail::sse_select(is_x, sum_xy, detail::sse_select(is_y, big, sum_yz)));
+    __m128 q_z = detail::sse_select(is_w, diff_z, detail::sse_select(is_x, sum_xz, detail::sse_select(is_y, sum_yz, big)));
+
+    // w is kept positive.
+    const __m128 flip = _mm_and_ps(_mm_cmplt_ps(q_w, _mm_setzero_ps()), sign_bit);
+    q_x = _mm_xor_ps(q_x, flip);
+    q_y = _mm_xor_ps(q_y, flip);
+    q_z = _mm_xor_ps(q_z, flip);
+    q_w = _mm_xor_ps(q_w, flip);
+    _MM_TRANSPOSE4_PS(q_x, q_y, q_z, q_w);
+
+    __m128 s_0 = scale_x, s_1 = scale_y, s_2 = scale_z, s_3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(s_0, s_1, s_2, s_3);
+
+    const __m128 rotations[4] = {q_x, q_y, q_z, q_w};
+    const __m128 scales[4]    = {s_0, s_1, s_2, s_3};
+    const int degenerate_lanes = _mm_movemask_ps(degenerate);
+
+    for(uint32_t j = 0; j < 4; ++j)
+    {
+      if(degenerate_lanes & (1 << j))
+      {
+        out[i + j] = transform_init_from_world_matrix(matrices[i + j]);
+        continue;
+      }
+
+      out[i + j].position.simd_vec = mats[j]->simd_vec[3];
+      out[i + j].scale.simd_vec    = scales[j];
+      out[i + j].rotation.simd_vec = rotations[j];
+    }
+  }
+  #endif
+
+  for(; i < count; ++i)
+  {
+    out[i] = transform_init_from_world_matrix(matrices[i]);
+  }
 }
 
 
@@ -118,17 +326,184 @@ transform_inherited(const transform &parent, const transform &child)
 mat4
 transform_get_world_matrix(const transform &to_world)
 {
-  // Get scale
-  const mat4 scale = mat4_scale(to_world.scale);
+  return mat4_init_with_trs(to_world.position, to_world.scale, to_world.rotation);
+}
+
+
+namespace detail
+{
+  // Row major world matrix of a transform.
+  inline void
+  transform_trs_to_array(const vec3 position, const vec3 scale, const quat &rotation, float out[16])
+  {
+    const float x = quat_get_x(rotation);
+    const float y = quat_get_y(rotation);
+    const float z = quat_get_z(rotation);
+    const float w = quat_get_w(rotation);
+
+    const float x2 = x + x;
+    const float y2 = y + y;
+    const float z2 = z + z;
+
+    const float xx2 = x * x2;
+    const float yy2 = y * y2;
+    const float zz2 = z * z2;
+    const float xy2 = x * y2;
+    const float xz2 = x * z2;
+    const float yz2 = y * z2;
+    const float xw2 = w * x2;
+    const float yw2 = w * y2;
+    const float zw2 = w * z2;
+
+    const float scale_x = vec3_get_x(scale);
+    const float scale_y = vec3_get_y(scale);
+    const float scale_z = vec3_get_z(scale);
+
+    // Rows of quat_get_rotation_matrix, each scaled by its axis.
+    const float rows[16] = {
+      (1.f - yy2 - zz2) * scale_x, (xy2 - zw2) * scale_x, (xz2 + yw2) * scale_x, 0.f,
+      (xy2 + zw2) * scale_y, (1.f - xx2 - zz2) * scale_y, (yz2 - xw2) * scale_y, 0.f,
+      (xz2 - yw2) * scale_z, (yz2 + xw2) * scale_z, (1.f - xx2 - yy2) * scale_z, 0.f,
+      vec3_get_x(position), vec3_get_y(position), vec3_get_z(position), 1.f,
+    };
+
+    memcpy(out, rows, sizeof(rows));
+  }
+} // ns
 
-  // Get rotation
-  mat4 rotation = mat4_init_with_mat3(quat_get_rotation_matrix(to_world.rotation));
-  mat4_set(rotation, 3, 3, 1.f);
 
-  // Get translation
-  const mat4 translation = mat4_translate(to_world.position);
+mat4
+mat4_init_with_trs(const vec3 position, const vec3 scale, const quat &rotation)
+{
+  float mat_data[16];
+  detail::transform_trs_to_array(position, scale, rotation, mat_data);
+
+  return mat4_init_with_array(mat_data);
+}
 
-  return mat4_multiply(scale, rotation, translation);
+
+mat34
+mat34_init_with_trs(const vec3 position, const vec3 scale, const quat &rotation)
+{
+  float mat_data[16];
+  detail::transform_trs_to_array(position, scale, rotation, mat_data);
+
+  // mat34 holds the columns.
+  const float col_data[12] = {
+    mat_data[0], mat_data[4], mat_data[8],  mat_data[12],
+    mat_data[1], mat_data[5], mat_data[9],  mat_data[13],
+    mat_data[2], mat_data[6], mat_data[10], mat_data[14],
+  };
+
+  return mat34_init_with_array(col_data);
+}
+
+
+mat34
+transform_get_world_mat34(const transform &to_world)
+{
+  return mat34_init_with_trs(to_world.position, to_world.scale, to_world.rotation);
+}
+
+
+transform
+transform_init_from_mat34(const mat34 &matrix)
+{
+  float col_data[12];
+  mat34_to_array(matrix, col_data);
+
+  const float mat[16] = {
+    col_data[0], col_data[4], col_data[8],  0.f,
+    col_data[1], col_data[5], col_data[9],  0.f,
+    col_data[2], col_data[6], col_data[10], 0.f,
+    col_data[3], col_data[7], col_data[11], 1.f,
+  };
+
+  return detail::transform_init_from_world_array(mat);
+}
+
+
+void
+transform_get_world_matrix_array(const transform transforms[], mat4 out[], const size_t count)
+{
+  size_t i = 0;
+
+  #ifdef MATH_ON_SSE2
+  /*
+    Four at a time with each register holding one term of four
+    transforms, three transposes turn the terms back into rows.
+  */
+  const __m128 one  = _mm_set1_ps(1.f);
+  const __m128 zero = _mm_setzero_ps();
+
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128 x = transforms[i + 0].rotation.simd_vec;
+    __m128 y = transforms[i + 1].rotation.simd_vec;
+    __m128 z = transforms[i + 2].rotation.simd_vec;
+    __m128 w = transforms[i + 3].rotation.simd_vec;
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+
+    __m128 scale_x = transforms[i + 0].scale.simd_vec;
+    __m128 scale_y = transforms[i + 1].scale.simd_vec;
+    __m128 scale_z = transforms[i + 2].scale.simd_vec;
+    __m128 scale_w = transforms[i + 3].scale.simd_vec;
+    _MM_TRANSPOSE4_PS(scale_x, scale_y, scale_z, scale_w);
+
+    const __m128 x2 = _mm_add_ps(x, x);
+    const __m128 y2 = _mm_add_ps(y, y);
+    const __m128 z2 = _mm_add_ps(z, z);
+
+    const __m128 xx2 = _mm_mul_ps(x, x2);
+    const __m128 yy2 = _mm_mul_ps(y, y2);
+    const __m128 zz2 = _mm_mul_ps(z, z2);
+    const __m128 xy2 = _mm_mul_ps(x, y2);
+    const __m128 xz2 = _mm_mul_ps(x, z2);
+    const __m128 yz2 = _mm_mul_ps(y, z2);
+    const __m128 xw2 = _mm_mul_ps(w, x2);
+    const __m128 yw2 = _mm_mul_ps(w, y2);
+    const __m128 zw2 = _mm_mul_ps(w, z2);
+
+    __m128 m00 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, yy2), zz2), scale_x);
+    __m128 m01 = _mm_mul_ps(_mm_sub_ps(xy2, zw2), scale_x);
+    __m128 m02 = _mm_mul_ps(_mm_add_ps(xz2, yw2), scale_x);
+    __m128 m03 = zero;
+    _MM_TRANSPOSE4_PS(m00, m01, m02, m03);
+
+    __m128 m10 = _mm_mul_ps(_mm_add_ps(xy2, zw2), scale_y);
+    __m128 m11 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, xx2), zz2), scale_y);
+    __m128 m12 = _mm_mul_ps(_mm_sub_ps(yz2, xw2), scale_y);
+    __m128 m13 = zero;
+    _MM_TRANSPOSE4_PS(m10, m11, m12, m13);
+
+    __m128 m20 = _mm_mul_ps(_mm_sub_ps(xz2, yw2), scale_z);
+    __m128 m21 = _mm_mul_ps(_mm_add_ps(yz2, xw2), scale_z);
+    __m128 m22 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, xx2), yy2), scale_z);
+    __m128 m23 = zero;
+    _MM_TRANSPOSE4_PS(m20, m21, m22, m23);
+
+    const __m128 rows[3][4] = {
+      {m00, m01, m02, m03},
+      {m10, m11, m12, m13},
+      {m20, m21, m22, m23},
+    };
+
+    for(uint32_t j = 0; j < 4; ++j)
+    {
+      detail::internal_mat4 *mat = reinterpret_cast<detail::internal_mat4*>(&out[i + j]);
+
+      mat->simd_vec[0] = rows[0][j];
+      mat->simd_vec[1] = rows[1][j];
+      mat->simd_vec[2] = rows[2][j];
+      mat->simd_vec[3] = detail::sse_blend_w(transforms[i + j].position.simd_vec, one);
+    }
+  }
+  #endif
+
+  for(; i < count; ++i)
+  {
+    out[i] = transform_get_world_matrix(transforms[i]);
+  }
 }
 
 
@@ -9,6 +9,8 @@ _MATH_NS_OPEN
 
 
 struct transform;
+struct transform_hierarchy;
+struct transform_hierarchy_counters;
 
 
 _MATH_NS_CLOSE
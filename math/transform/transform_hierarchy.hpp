@@ -0,0 +1,376 @@
+#ifndef TRANSFORM_HIERARCHY_INCLUDED_CED40C3C_F5C4_4338_8D85_9334178416BE
+#define TRANSFORM_HIERARCHY_INCLUDED_CED40C3C_F5C4_4338_8D85_9334178416BE
+
+
+/*
+  Transform Hierarchy
+  --
+  Local transforms of a whole scene in flat arrays with a parent
+  index table. Parents come before their children so world transforms
+  and matrices are found in one pass from front to back, each node
+  only reads its parent which has already been done.
+
+  Setting a local marks the node dirty, an update only recomputes
+  dirty nodes and their children, the rest keep their cached world
+  transform and matrix.
+
+  With a thread pool the update goes level by level (depth from the
+  roots), each level split across threads.
+*/
+
+
+#include "../detail/detail.hpp"
+#include "transform_types.hpp"
+#include "transform.hpp"
+#include "../general/thread_pool.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <assert.h>
+
+
+_MATH_NS_OPEN
+
+
+// ------------------------------------------------------------ [ Interface ] --
+
+
+MATH_CONSTEXPR uint32_t transform_hierarchy_no_parent() { return UINT32_MAX; }
+
+inline void         transform_hierarchy_reserve(transform_hierarchy &hierarchy, const size_t count);
+inline size_t       transform_hierarchy_size(const transform_hierarchy &hierarchy);
+
+// Parent must already be in the hierarchy, returns the new node.
+inline uint32_t     transform_hierarchy_add(transform_hierarchy &hierarchy, const transform &local, const uint32_t parent = transform_hierarchy_no_parent());
+
+inline transform    transform_hierarchy_get_local(const transform_hierarchy &hierarchy, const uint32_t node);
+inline void         transform_hierarchy_set_local(transform_hierarchy &hierarchy, const uint32_t node, const transform &local);
+
+// World results are from the last update.
+inline void         transform_hierarchy_update(transform_hierarchy &hierarchy);
+
+// Same results to the bit, levels of the hierarchy are split over the pool.
+inline void         transform_hierarchy_update(transform_hierarchy &hierarchy, thread_pool &pool);
+inline bool         transform_hierarchy_is_dirty(const transform_hierarchy &hierarchy, const uint32_t node);
+inline void         transform_hierarchy_set_all_dirty(transform_hierarchy &hierarchy);
+inline transform    transform_hierarchy_get_world(const transform_hierarchy &hierarchy, const uint32_t node);
+inline const mat4&  transform_hierarchy_get_world_matrix(const transform_hierarchy &hierarchy, const uint32_t node);
+
+// How much work updates are doing, for monitoring.
+inline const transform_hierarchy_counters& transform_hierarchy_get_counters(const transform_hierarchy &hierarchy);
+inline void         transform_hierarchy_reset_counters(transform_hierarchy &hierarchy);
+
+
+// ----------------------------------------------------------------- [ Impl ] --
+
+
+void
+transform_hierarchy_reserve(transform_hierarchy &hierarchy, const size_t count)
+{
+  hierarchy.parent.reserve(count);
+
+  hierarchy.local_position.reserve(count);
+  hierarchy.local_scale.reserve(count);
+  hierarchy.local_rotation.reserve(count);
+
+  hierarchy.world_position.reserve(count);
+  hierarchy.world_scale.reserve(count);
+  hierarchy.world_rotation.reserve(count);
+  hierarchy.world_matrix.reserve(count);
+
+  hierarchy.dirty.reserve(count);
+}
+
+
+size_t
+transform_hierarchy_size(const transform_hierarchy &hierarchy)
+{
+  return hierarchy.parent.size();
+}
+
+
+uint32_t
+transform_hierarchy_add(transform_hierarchy &hierarchy, const transform &local, const uint32_t parent)
+{
+  const uint32_t node = static_cast<uint32_t>(transform_hierarchy_size(hierarchy));
+
+  assert(parent == transform_hierarchy_no_parent() || parent < node);
+
+  hierarchy.parent.push_back(parent);
+
+  hierarchy.local_position.push_back(local.position);
+  hierarchy.local_scale.push_back(local.scale);
+  hierarchy.local_rotation.push_back(local.rotation);
+
+  // Filled in by the next update.
+  hierarchy.world_position.push_back(local.position);
+  hierarchy.world_scale.push_back(local.scale);
+  hierarchy.world_rotation.push_back(local.rotation);
+  hierarchy.world_matrix.push_back(mat4_id());
+
+  hierarchy.dirty.push_back(1);
+
+  return node;
+}
+
+
+transform
+transform_hierarchy_get_local(const transform_hierarchy &hierarchy, const uint32_t node)
+{
+  assert(node < transform_hierarchy_size(hierarchy));
+
+  return transform_init(
+    hierarchy.local_position[node],
+    hierarchy.local_scale[node],
+    hierarchy.local_rotation[node]
+  );
+}
+
+
+void
+transform_hierarchy_set_local(transform_hierarchy &hierarchy, const uint32_t node, const transform &local)
+{
+  assert(node < transform_hierarchy_size(hierarchy));
+
+  hierarchy.local_position[node] = local.position;
+  hierarchy.local_scale[node]    = local.scale;
+  hierarchy.local_rotation[node] = local.rotation;
+
+  hierarchy.dirty[node] = 1;
+}
+
+
+namespace detail
+{
+  // Pushes the parent's dirty flag down and recomputes the world transform if set, the parent must be done.
+  inline bool
+  transform_hierarchy_update_node(transform_hierarchy &hierarchy, const uint32_t node)
+  {
+    const uint32_t parent = hierarchy.parent[node];
+    const bool has_parent = parent != transform_hierarchy_no_parent();
+
+    if(has_parent)
+    {
+      hierarchy.dirty[node] |= hierarchy.dirty[parent];
+    }
+
+    if(!hierarchy.dirty[node])
+    {
+      return false;
+    }
+
+    const transform local = transform_hierarchy_get_local(hierarchy, node);
+    const transform world = has_parent ? transform_inherited(transform_hierarchy_get_world(hierarchy, parent), local) : local;
+
+    hierarchy.world_position[node] = world.position;
+    hierarchy.world_scale[node]    = world.scale;
+    hierarchy.world_rotation[node] = world.rotation;
+
+    return true;
+  }
+
+
+  // Only reads this node's world transform.
+  inline void
+  transform_hierarchy_update_matrix(transform_hierarchy &hierarchy, const uint32_t node)
+  {
+    if(hierarchy.dirty[node])
+    {
+      hierarchy.world_matrix[node] = transform_get_world_matrix(transform_hierarchy_get_world(hierarchy, node));
+      hierarchy.dirty[node] = 0;
+    }
+  }
+
+
+  inline void
+  transform_hierarchy_count_update(transform_hierarchy &hierarchy, const uint32_t recomputed)
+  {
+    hierarchy.counters.updates               += 1;
+    hierarchy.counters.nodes_recomputed      += recomputed;
+    hierarchy.counters.last_nodes_recomputed  = recomputed;
+  }
+
+
+  /*
+    Nodes grouped by depth, every parent is in an earlier level so a
+    level's nodes can all be done at once. Nodes are only ever added
+    so this is rebuilt when the size changes.
+  */
+  inline void
+  transform_hierarchy_build_levels(transform_hierarchy &hierarchy)
+  {
+    const size_t count = transform_hierarchy_size(hierarchy);
+
+    if(!hierarchy.level_start.empty() && hierarchy.level_nodes.size() == count)
+    {
+      return;
+    }
+
+    std::vector<uint32_t> depth(count);
+    uint32_t level_count = 0;
+
+    for(size_t i = 0; i < count; ++i)
+    {
+      const uint32_t parent = hierarchy.parent[i];
+      depth[i] = parent == transform_hierarchy_no_parent() ? 0 : depth[parent] + 1;
+      level_count = MATH_NS_NAME::max(level_count, depth[i] + 1);
+    }
+
+    // Counting sort, keeps node order inside a level.
+    hierarchy.level_start.assign(level_count + 1, 0);
+
+    for(size_t i = 0; i < count; ++i)
+    {
+      ++hierarchy.level_start[depth[i] + 1];
+    }
+
+    for(uint32_t i = 0; i < level_count; ++i)
+    {
+      hierarchy.level_start[i + 1] += hierarchy.level_start[i];
+    }
+
+    std::vector<uint32_t> next(hierarchy.level_start.begin(), hierarchy.level_start.end() - 1);
+    hierarchy.level_nodes.resize(count);
+
+    for(size_t i = 0; i < count; ++i)
+    {
+      hierarchy.level_nodes[next[depth[i]]++] = static_cast<uint32_t>(i);
+    }
+  }
+
+
+  // Nodes a chunk of a parallel update covers.
+  MATH_CONSTEXPR size_t transform_hierarchy_grain() { return 1024; }
+} // ns
+
+
+void
+transform_hierarchy_update(transform_hierarchy &hierarchy)
+{
+  const uint32_t count = static_cast<uint32_t>(transform_hierarchy_size(hierarchy));
+
+  uint32_t recomputed = 0;
+
+  // World transforms, parent is always done before the child so its
+  // dirty flag has already been pushed down.
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    recomputed += detail::transform_hierarchy_update_node(hierarchy, i);
+  }
+
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    detail::transform_hierarchy_update_matrix(hierarchy, i);
+  }
+
+  detail::transform_hierarchy_count_update(hierarchy, recomputed);
+}
+
+
+void
+transform_hierarchy_update(transform_hierarchy &hierarchy, thread_pool &pool)
+{
+  detail::transform_hierarchy_build_levels(hierarchy);
+
+  const size_t level_count = hierarchy.level_start.size() - 1;
+
+  std::atomic<uint32_t> recomputed(0);
+
+  // One level at a time, the nodes in it only read earlier levels.
+  for(size_t level = 0; level < level_count; ++level)
+  {
+    const size_t start = hierarchy.level_start[level];
+    const size_t count = hierarchy.level_start[level + 1] - start;
+
+    thread_pool_parallel_for(pool, count, detail::transform_hierarchy_grain(), [&](const size_t chunk_start, const size_t chunk_end)
+    {
+      uint32_t chunk_recomputed = 0;
+
+      for(size_t i = chunk_start; i < chunk_end; ++i)
+      {
+        chunk_recomputed += detail::transform_hierarchy_update_node(hierarchy, hierarchy.level_nodes[start + i]);
+      }
+
+      recomputed.fetch_add(chunk_recomputed, std::memory_order_relaxed);
+    });
+  }
+
+  thread_pool_parallel_for(pool, transform_hierarchy_size(hierarchy), detail::transform_hierarchy_grain(), [&](const size_t chunk_start, const size_t chunk_end)
+  {
+    for(size_t i = chunk_start; i < chunk_end; ++i)
+    {
+      detail::transform_hierarchy_update_matrix(hierarchy, static_cast<uint32_t>(i));
+    }
+  });
+
+  detail::transform_hierarchy_count_update(hierarchy, recomputed.load());
+}
+
+
+bool
+transform_hierarchy_is_dirty(const transform_hierarchy &hierarchy, const uint32_t node)
+{
+  assert(node < transform_hierarchy_size(hierarchy));
+
+  // Children of a dirty node are only flagged during the update.
+  for(uint32_t i = node; i != transform_hierarchy_no_parent(); i = hierarchy.parent[i])
+  {
+    if(hierarchy.dirty[i])
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+void
+transform_hierarchy_set_all_dirty(transform_hierarchy &hierarchy)
+{
+  std::fill(hierarchy.dirty.begin(), hierarchy.dirty.end(), uint8_t(1));
+}
+
+
+transform
+transform_hierarchy_get_world(const transform_hierarchy &hierarchy, const uint32_t node)
+{
+  assert(node < transform_hierarchy_size(hierarchy));
+
+  return transform_init(
+    hierarchy.world_position[node],
+    hierarchy.world_scale[node],
+    hierarchy.world_rotation[node]
+  );
+}
+
+
+const mat4&
+transform_hierarchy_get_world_matrix(const transform_hierarchy &hierarchy, const uint32_t node)
+{
+  assert(node < transform_hierarchy_size(hierarchy));
+
+  return hierarchy.world_matrix[node];
+}
+
+
+const transform_hierarchy_counters&
+transform_hierarchy_get_counters(const transform_hierarchy &hierarchy)
+{
+  return hierarchy.counters;
+}
+
+
+void
+transform_hierarchy_reset_counters(transform_hierarchy &hierarchy)
+{
+  hierarchy.counters = transform_hierarchy_counters();
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // include guard
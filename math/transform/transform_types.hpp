@@ -5,6 +5,9 @@
 #include "../detail/detail.hpp"
 #include "../quat/quat.hpp"
 #include "../vec/vec3.hpp"
+#include "../mat/mat_types.hpp"
+#include <vector>
+#include <stdint.h>
 
 
 _MATH_NS_OPEN
@@ -18,6 +21,43 @@ struct transform
 }; // class
 
 
+static_assert(sizeof(transform) == 48 && alignof(transform) == 16, "transform layout differs by ISA level");
+
+
+struct transform_hierarchy_counters
+{
+  uint64_t    updates               = 0;
+  uint64_t    nodes_recomputed      = 0; // Over all updates.
+  uint32_t    last_nodes_recomputed = 0;
+};
+
+
+/*
+  Nodes are stored parent first, a node's parent index is always less
+  than its own. Each array is indexed by node.
+*/
+struct transform_hierarchy
+{
+  std::vector<uint32_t>   parent;
+
+  std::vector<vec3>       local_position;
+  std::vector<vec3>       local_scale;
+  std::vector<quat>       local_rotation;
+
+  std::vector<vec3>       world_position;
+  std::vector<vec3>       world_scale;
+  std::vector<quat>       world_rotation;
+  std::vector<mat4>       world_matrix;
+
+  std::vector<uint8_t>    dirty; // Local changed since the last update.
+
+  std::vector<uint32_t>   level_nodes; // Nodes by depth, for the parallel update.
+  std::vector<size_t>     level_start;
+
+  transform_hierarchy_counters counters;
+}; // class
+
+
 _MATH_NS_CLOSE
 
 
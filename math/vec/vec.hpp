@@ -11,6 +11,8 @@
 #include "vec2.hpp"
 #include "vec3.hpp"
 #include "vec4.hpp"
+#include "vec3x4.hpp"
+#include "vec3x8.hpp"
 
 
 #endif // inc guard
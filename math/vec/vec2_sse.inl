@@ -3,6 +3,7 @@
 
 
 #include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
 #include "vec_types.hpp"
 #include "../general/general.hpp"
 #include <cstring>
@@ -81,18 +82,14 @@ vec2_init_with_array(const float *arr)
 float
 vec2_get_x(const vec2 vec)
 {
-  ALIGN16 float vec2[4];
-  _mm_store_ps(&vec2[0], vec.simd_vec);
-  return vec2[0];
+  return _mm_cvtss_f32(vec.simd_vec);
 }
 
 
 float
 vec2_get_y(const vec2 vec)
 {
-  ALIGN16 float vec2[4];
-  _mm_store_ps(&vec2[0], vec.simd_vec);
-  return vec2[1];
+  return _mm_cvtss_f32(_mm_shuffle_ps(vec.simd_vec, vec.simd_vec, _MM_SHUFFLE(1,1,1,1)));
 }
 
 
@@ -137,11 +134,9 @@ vec2_divide(const vec2 a, const vec2 b)
 vec2
 vec2_lerp(const vec2 start, const vec2 end, const float dt)
 {
-  const vec2 difference = vec2_subtract(end, start);
-  const vec2 scaled     = vec2_scale(difference, dt);
-  const vec2 position   = vec2_add(start, scaled);
+  const __m128 difference = _mm_sub_ps(end.simd_vec, start.simd_vec);
 
-  return position;
+  return vec2{{detail::sse_multiply_add(difference, _mm_set1_ps(dt), start.simd_vec)}};
 }
 
 
@@ -167,15 +162,7 @@ vec2_normalize(const vec2 a)
 float
 vec2_length(const vec2 a)
 {
-  __m128 sq = _mm_mul_ps(a.simd_vec, a.simd_vec);
-
-  sq = _mm_add_ps(sq, _mm_movehl_ps(sq, sq));
-  sq = _mm_add_ss(sq, _mm_shuffle_ps(sq, sq, 1));
-  sq = _mm_sqrt_ps(sq);
-
-  ALIGN16 float vec_store[4];
-  _mm_store_ps(&vec_store[0], sq);
-  return vec_store[0];
+  return _mm_cvtss_f32(_mm_sqrt_ss(detail::sse_dot2(a.simd_vec, a.simd_vec)));
 }
 
 
@@ -190,26 +177,15 @@ vec2_cross(const vec2 a, const vec2 b)
 float
 vec2_dot(const vec2 a, const vec2 b)
 {
-  __m128 mu = _mm_mul_ps(a.simd_vec, b.simd_vec);
-
-  mu = _mm_add_ps(mu, _mm_movehl_ps(mu, mu));
-  mu = _mm_add_ss(mu, _mm_shuffle_ps(mu, mu, 1));
-
-  ALIGN16 float vec_store[4];
-  _mm_store_ps(&vec_store[0], mu);
-  return vec_store[0];
+  return _mm_cvtss_f32(detail::sse_dot2(a.simd_vec, b.simd_vec));
 }
 
 
 bool
 vec2_is_equal(const vec2 a, const vec2 b)
 {
-	return
-  (
-    (vec2_get_x(a) == vec2_get_x(b))
-    &&
-    (vec2_get_y(a) == vec2_get_y(b))
-  );
+  const int equal = _mm_movemask_ps(_mm_cmpeq_ps(a.simd_vec, b.simd_vec));
+  return (equal & 0x3) == 0x3;
 }
 
 
@@ -10,6 +10,7 @@
 
 #include "../detail/detail.hpp"
 #include "vec_types.hpp"
+#include <stddef.h>
 
 
 _MATH_NS_OPEN
@@ -51,6 +52,9 @@ MATH_VEC3_INLINE float                  vec3_length(const vec3 a);
 MATH_VEC3_INLINE vec3                   vec3_cross(const vec3 a, const vec3 b);
 MATH_VEC3_INLINE float                  vec3_dot(const vec3 a, const vec3 b);
 
+// Batch operations, out[i] = op(a[i], b[i]), out can be a or b.
+MATH_VEC3_INLINE void                   vec3_cross_array(const vec3 a[], const vec3 b[], vec3 out[], const size_t count);
+
 // ** Equal Test ** //
 MATH_VEC3_INLINE bool                   vec3_is_equal(const vec3 a, const vec3 b);
 MATH_VEC3_INLINE bool                   vec3_is_not_equal(const vec3 a, const vec3 b);
@@ -207,6 +207,16 @@ vec3_cross(const vec3 a, const vec3 b)
 }
 
 
+void
+vec3_cross_array(const vec3 a[], const vec3 b[], vec3 out[], const size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    out[i] = vec3_cross(a[i], b[i]);
+  }
+}
+
+
 float
 vec3_dot(const vec3 a, const vec3 b)
 {
@@ -3,6 +3,7 @@
 
 
 #include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
 #include "vec_types.hpp"
 #include "../general/general.hpp"
 #include <assert.h>
@@ -76,30 +77,21 @@ vec3_init_with_array(const float *arr)
 float
 vec3_get_x(const vec3 vec)
 {
-//  ALIGN16 float vec_store[4];
-//  _mm_store_ps(&vec_store[0], vec);
-//  return vec_store[0];
-  return vec.data[0];
+  return _mm_cvtss_f32(vec.simd_vec);
 }
 
 
 float
 vec3_get_y(const vec3 vec)
 {
-//  ALIGN16 float vec_store[4];
-//  _mm_store_ps(&vec_store[0], vec);
-//  return vec_store[1];
-  return vec.data[1];
+  return _mm_cvtss_f32(_mm_shuffle_ps(vec.simd_vec, vec.simd_vec, _MM_SHUFFLE(1,1,1,1)));
 }
 
 
 float
 vec3_get_z(const vec3 vec)
 {
-//  ALIGN16 float vec_store[4];
-//  _mm_store_ps(&vec_store[0], vec);
-//  return vec_store[2];
-  return vec.data[2];
+  return _mm_cvtss_f32(_mm_shuffle_ps(vec.simd_vec, vec.simd_vec, _MM_SHUFFLE(2,2,2,2)));
 }
 
 
@@ -144,11 +136,9 @@ vec3_divide(const vec3 a, const vec3 b)
 vec3
 vec3_lerp(const vec3 start, const vec3 end, const float dt)
 {
-  const vec3 difference = vec3_subtract(end, start);
-  const vec3 scaled     = vec3_scale(difference, dt);
-  const vec3 position   = vec3_add(start, scaled);
+  const __m128 difference = _mm_sub_ps(end.simd_vec, start.simd_vec);
 
-  return position;
+  return vec3{{detail::sse_multiply_add(difference, _mm_set1_ps(dt), start.simd_vec)}};
 }
 
 
@@ -195,50 +185,55 @@ vec3_normalize(const vec3 a)
 float
 vec3_length(const vec3 a)
 {
-  __m128 sq = _mm_mul_ps(a.simd_vec, a.simd_vec);
-
-  sq = _mm_add_ps(sq, _mm_movehl_ps(sq, sq));
-  sq = _mm_add_ss(sq, _mm_shuffle_ps(sq, sq, 1));
-  sq = _mm_sqrt_ps(sq);
-
-  ALIGN16 float vec_store[4];
-  _mm_store_ps(&vec_store[0], sq);
-  return vec_store[0];
+  return _mm_cvtss_f32(_mm_sqrt_ss(detail::sse_dot3(a.simd_vec, a.simd_vec)));
 }
 
 
 vec3
 vec3_cross(const vec3 a, const vec3 b)
 {
-  // TODO: Better way with sse?
+  return vec3{{detail::sse_cross(a.simd_vec, b.simd_vec)}};
+}
 
-  const float x = (vec3_get_y(a) * vec3_get_z(b)) - (vec3_get_z(a) * vec3_get_y(b));
-  const float y = (vec3_get_x(a) * vec3_get_z(b)) - (vec3_get_z(a) * vec3_get_x(b));
-  const float z = (vec3_get_x(a) * vec3_get_y(b)) - (vec3_get_y(a) * vec3_get_x(b));
 
-  return vec3_init(x, -y, z);
+void
+vec3_cross_array(const vec3 a[], const vec3 b[], vec3 out[], const size_t count)
+{
+  size_t i = 0;
+
+  #ifdef MATH_ON_AVX
+  // Two vectors a register, the permutes stay inside each half.
+  for(; i + 2 <= count; i += 2)
+  {
+    const __m256 va    = _mm256_loadu_ps(a[i].data);
+    const __m256 vb    = _mm256_loadu_ps(b[i].data);
+    const __m256 a_yzx = _mm256_permute_ps(va, _MM_SHUFFLE(3,0,2,1));
+    const __m256 b_yzx = _mm256_permute_ps(vb, _MM_SHUFFLE(3,0,2,1));
+    const __m256 c     = _mm256_sub_ps(_mm256_mul_ps(va, b_yzx), _mm256_mul_ps(a_yzx, vb));
+
+    _mm256_storeu_ps(out[i].data, _mm256_permute_ps(c, _MM_SHUFFLE(3,0,2,1)));
+  }
+  #endif
+
+  for(; i < count; ++i)
+  {
+    out[i] = vec3_cross(a[i], b[i]);
+  }
 }
 
 
 float
 vec3_dot(const vec3 a, const vec3 b)
 {
-  __m128 mu = _mm_mul_ps(a.simd_vec, b.simd_vec);
-
-  mu = _mm_add_ps(mu, _mm_movehl_ps(mu, mu));
-  mu = _mm_add_ss(mu, _mm_shuffle_ps(mu, mu, 1));
-
-  ALIGN16 float vec_store[4];
-  memset(vec_store, 0, sizeof(vec_store));
-  _mm_store_ps(&vec_store[0], mu);
-  return vec_store[0];
+  return _mm_cvtss_f32(detail::sse_dot3(a.simd_vec, b.simd_vec));
 }
 
 
 bool
 vec3_is_equal(const vec3 a, const vec3 b)
 {
-  return !!_mm_movemask_ps(_mm_cmpeq_ps(a.simd_vec, b.simd_vec));
+  const int equal = _mm_movemask_ps(_mm_cmpeq_ps(a.simd_vec, b.simd_vec));
+  return (equal & 0x7) == 0x7;
 }
 
 
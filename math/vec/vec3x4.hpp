@@ -0,0 +1,145 @@
+#ifndef VEC3X4_INCLUDED_06414685_988E_4D1D_87BC_2F47C4DCC25D
+#define VEC3X4_INCLUDED_06414685_988E_4D1D_87BC_2F47C4DCC25D
+
+
+/*
+  Vector3 x4
+  Four 3D vectors as structure of arrays, every lane does work
+  so dot, length and cross don't need horizontal operations.
+  Tests return a bit mask, bit n is lane n.
+*/
+
+
+#include "../detail/detail.hpp"
+#include "vec_types.hpp"
+#include "vec3.hpp"
+#include <stddef.h>
+#include <assert.h>
+
+
+_MATH_NS_OPEN
+
+
+// ** Interface ** //
+
+// Lanes
+MATH_VEC3X4_INLINE floatx4              floatx4_init(const float val);
+MATH_VEC3X4_INLINE floatx4              floatx4_init(const float a, const float b, const float c, const float d);
+MATH_VEC3X4_INLINE float                floatx4_get(const floatx4 lanes, const uint32_t i);
+MATH_VEC3X4_INLINE floatx4              floatx4_add(const floatx4 a, const floatx4 b);
+MATH_VEC3X4_INLINE floatx4              floatx4_subtract(const floatx4 a, const floatx4 b);
+MATH_VEC3X4_INLINE floatx4              floatx4_multiply(const floatx4 a, const floatx4 b);
+MATH_VEC3X4_INLINE floatx4              floatx4_divide(const floatx4 a, const floatx4 b);
+MATH_VEC3X4_INLINE floatx4              floatx4_sqrt(const floatx4 a);
+MATH_VEC3X4_INLINE floatx4              floatx4_copy_sign(const floatx4 magnitude, const floatx4 sign); // As copysign, per lane.
+
+// Constants
+MATH_VEC3X4_INLINE vec3x4               vec3x4_zero();
+MATH_VEC3X4_INLINE vec3x4               vec3x4_one();
+
+// Initialize, loads past count are zero.
+MATH_VEC3X4_INLINE vec3x4               vec3x4_init(const vec3 vec);
+MATH_VEC3X4_INLINE vec3x4               vec3x4_init(const vec3 a, const vec3 b, const vec3 c, const vec3 d);
+MATH_VEC3X4_INLINE vec3x4               vec3x4_init_with_vec3_array(const vec3 *arr, const size_t count = 4);
+MATH_VEC3X4_INLINE vec3x4               vec3x4_init_with_xyz_array(const float *xyz_arr, const size_t count = 4);
+
+// Get components.
+MATH_VEC3X4_INLINE vec3                 vec3x4_get(const vec3x4 vec, const uint32_t i);
+MATH_VEC3X4_INLINE void                 vec3x4_to_vec3_array(const vec3x4 vec, vec3 *out_array, const size_t count = 4);
+MATH_VEC3X4_INLINE void                 vec3x4_to_xyz_array(const vec3x4 vec, float *out_xyz_array, const size_t count = 4);
+
+// Component wise arithmetic.
+MATH_VEC3X4_INLINE vec3x4               vec3x4_add(const vec3x4 a, const vec3x4 b);
+MATH_VEC3X4_INLINE vec3x4               vec3x4_subtract(const vec3x4 a, const vec3x4 b);
+MATH_VEC3X4_INLINE vec3x4               vec3x4_multiply(const vec3x4 a, const vec3x4 b);
+MATH_VEC3X4_INLINE vec3x4               vec3x4_divide(const vec3x4 a, const vec3x4 b);
+
+// Special operations.
+MATH_VEC3X4_INLINE vec3x4               vec3x4_lerp(const vec3x4 start, const vec3x4 end, const float dt);
+MATH_VEC3X4_INLINE vec3x4               vec3x4_scale(const vec3x4 a, const float scale);
+MATH_VEC3X4_INLINE vec3x4               vec3x4_scale(const vec3x4 a, const floatx4 scale);
+MATH_VEC3X4_INLINE vec3x4               vec3x4_normalize(const vec3x4 a);
+MATH_VEC3X4_INLINE floatx4              vec3x4_length(const vec3x4 a);
+MATH_VEC3X4_INLINE vec3x4               vec3x4_cross(const vec3x4 a, const vec3x4 b);
+MATH_VEC3X4_INLINE floatx4              vec3x4_dot(const vec3x4 a, const vec3x4 b);
+
+// ** Equal Test ** //
+MATH_VEC3X4_INLINE uint32_t             vec3x4_is_equal(const vec3x4 a, const vec3x4 b);
+MATH_VEC3X4_INLINE uint32_t             vec3x4_is_not_equal(const vec3x4 a, const vec3x4 b);
+MATH_VEC3X4_INLINE uint32_t             vec3x4_is_near(const vec3x4 a, const vec3x4 b, const float error);
+MATH_VEC3X4_INLINE uint32_t             vec3x4_is_not_near(const vec3x4 a, const vec3x4 b, const float error);
+
+
+// Shared impl
+
+float
+floatx4_get(const floatx4 lanes, const uint32_t i)
+{
+  assert(i < 4);
+  return lanes.data[i];
+}
+
+
+vec3
+vec3x4_get(const vec3x4 vec, const uint32_t i)
+{
+  assert(i < 4);
+  return vec3_init(vec.x.data[i], vec.y.data[i], vec.z.data[i]);
+}
+
+
+vec3x4
+vec3x4_one()
+{
+  return vec3x4_init(vec3_one());
+}
+
+
+vec3x4
+vec3x4_lerp(const vec3x4 start, const vec3x4 end, const float dt)
+{
+  const vec3x4 difference = vec3x4_subtract(end, start);
+  const vec3x4 scaled     = vec3x4_scale(difference, dt);
+  const vec3x4 position   = vec3x4_add(start, scaled);
+
+  return position;
+}
+
+
+vec3x4
+vec3x4_scale(const vec3x4 a, const float scale)
+{
+  return vec3x4_scale(a, floatx4_init(scale));
+}
+
+
+uint32_t
+vec3x4_is_not_equal(const vec3x4 a, const vec3x4 b)
+{
+  return ~vec3x4_is_equal(a, b) & 0xF;
+}
+
+
+uint32_t
+vec3x4_is_not_near(const vec3x4 a, const vec3x4 b, const float error)
+{
+  return ~vec3x4_is_near(a, b, error) & 0xF;
+}
+
+
+_MATH_NS_CLOSE
+
+
+// What impl to use
+
+#ifdef MATH_ON_SSE2
+
+#include "vec3x4_sse.inl"
+
+#else
+
+#include "vec3x4_fallback.inl"
+
+#endif // Choose which impl to use.
+
+#endif // inc guard
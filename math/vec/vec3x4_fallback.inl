@@ -0,0 +1,415 @@
+#ifndef VEC3X4_FALLBACK_INCLUDED_7B4C4FD0_8A52_4D3D_94C9_14A31BAD394E
+#define VEC3X4_FALLBACK_INCLUDED_7B4C4FD0_8A52_4D3D_94C9_14A31BAD394E
+
+
+#include "../detail/detail.hpp"
+#include "vec_types.hpp"
+#include "../general/general.hpp"
+#include <assert.h>
+
+
+#ifdef MATH_ON_FPU
+
+
+/*
+  Vector3 x4
+  Fallback impl, loops over the lanes.
+*/
+
+
+_MATH_NS_OPEN
+
+
+// Lanes
+
+floatx4
+floatx4_init(const float val)
+{
+  return floatx4_init(val, val, val, val);
+}
+
+
+floatx4
+floatx4_init(const float a, const float b, const float c, const float d)
+{
+  floatx4 return_lanes;
+
+  return_lanes.data[0] = a;
+  return_lanes.data[1] = b;
+  return_lanes.data[2] = c;
+  return_lanes.data[3] = d;
+
+  return return_lanes;
+}
+
+
+floatx4
+floatx4_add(const floatx4 a, const floatx4 b)
+{
+  floatx4 return_lanes;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_lanes.data[i] = a.data[i] + b.data[i];
+  }
+
+  return return_lanes;
+}
+
+
+floatx4
+floatx4_subtract(const floatx4 a, const floatx4 b)
+{
+  floatx4 return_lanes;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_lanes.data[i] = a.data[i] - b.data[i];
+  }
+
+  return return_lanes;
+}
+
+
+floatx4
+floatx4_multiply(const floatx4 a, const floatx4 b)
+{
+  floatx4 return_lanes;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_lanes.data[i] = a.data[i] * b.data[i];
+  }
+
+  return return_lanes;
+}
+
+
+floatx4
+floatx4_divide(const floatx4 a, const floatx4 b)
+{
+  floatx4 return_lanes;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_lanes.data[i] = a.data[i] / b.data[i];
+  }
+
+  return return_lanes;
+}
+
+
+floatx4
+floatx4_sqrt(const floatx4 a)
+{
+  floatx4 return_lanes;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_lanes.data[i] = sqrt(a.data[i]);
+  }
+
+  return return_lanes;
+}
+
+
+floatx4
+floatx4_copy_sign(const floatx4 magnitude, const floatx4 sign)
+{
+  floatx4 return_lanes;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_lanes.data[i] = copysignf(magnitude.data[i], sign.data[i]);
+  }
+
+  return return_lanes;
+}
+
+
+// Constants
+
+vec3x4
+vec3x4_zero()
+{
+  return vec3x4_init(vec3_zero());
+}
+
+
+// Initialize
+
+vec3x4
+vec3x4_init(const vec3 vec)
+{
+  return vec3x4{
+    floatx4_init(vec.data[0]),
+    floatx4_init(vec.data[1]),
+    floatx4_init(vec.data[2])
+  };
+}
+
+
+vec3x4
+vec3x4_init(const vec3 a, const vec3 b, const vec3 c, const vec3 d)
+{
+  return vec3x4{
+    floatx4_init(a.data[0], b.data[0], c.data[0], d.data[0]),
+    floatx4_init(a.data[1], b.data[1], c.data[1], d.data[1]),
+    floatx4_init(a.data[2], b.data[2], c.data[2], d.data[2])
+  };
+}
+
+
+vec3x4
+vec3x4_init_with_vec3_array(const vec3 *arr, const size_t count)
+{
+  assert(count <= 4);
+
+  vec3x4 return_vec = vec3x4_zero();
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    return_vec.x.data[i] = arr[i].data[0];
+    return_vec.y.data[i] = arr[i].data[1];
+    return_vec.z.data[i] = arr[i].data[2];
+  }
+
+  return return_vec;
+}
+
+
+vec3x4
+vec3x4_init_with_xyz_array(const float *xyz_arr, const size_t count)
+{
+  assert(count <= 4);
+
+  vec3x4 return_vec = vec3x4_zero();
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    return_vec.x.data[i] = xyz_arr[i * 3 + 0];
+    return_vec.y.data[i] = xyz_arr[i * 3 + 1];
+    return_vec.z.data[i] = xyz_arr[i * 3 + 2];
+  }
+
+  return return_vec;
+}
+
+
+// Get components.
+
+void
+vec3x4_to_vec3_array(const vec3x4 vec, vec3 *out_array, const size_t count)
+{
+  assert(count <= 4);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    out_array[i] = vec3x4_get(vec, (uint32_t)i);
+  }
+}
+
+
+void
+vec3x4_to_xyz_array(const vec3x4 vec, float *out_xyz_array, const size_t count)
+{
+  assert(count <= 4);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    out_xyz_array[i * 3 + 0] = vec.x.data[i];
+    out_xyz_array[i * 3 + 1] = vec.y.data[i];
+    out_xyz_array[i * 3 + 2] = vec.z.data[i];
+  }
+}
+
+
+// Component wise arithmetic.
+
+vec3x4
+vec3x4_add(const vec3x4 a, const vec3x4 b)
+{
+  vec3x4 return_vec;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_vec.x.data[i] = a.x.data[i] + b.x.data[i];
+    return_vec.y.data[i] = a.y.data[i] + b.y.data[i];
+    return_vec.z.data[i] = a.z.data[i] + b.z.data[i];
+  }
+
+  return return_vec;
+}
+
+
+vec3x4
+vec3x4_subtract(const vec3x4 a, const vec3x4 b)
+{
+  vec3x4 return_vec;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_vec.x.data[i] = a.x.data[i] - b.x.data[i];
+    return_vec.y.data[i] = a.y.data[i] - b.y.data[i];
+    return_vec.z.data[i] = a.z.data[i] - b.z.data[i];
+  }
+
+  return return_vec;
+}
+
+
+vec3x4
+vec3x4_multiply(const vec3x4 a, const vec3x4 b)
+{
+  vec3x4 return_vec;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_vec.x.data[i] = a.x.data[i] * b.x.data[i];
+    return_vec.y.data[i] = a.y.data[i] * b.y.data[i];
+    return_vec.z.data[i] = a.z.data[i] * b.z.data[i];
+  }
+
+  return return_vec;
+}
+
+
+vec3x4
+vec3x4_divide(const vec3x4 a, const vec3x4 b)
+{
+  vec3x4 return_vec;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_vec.x.data[i] = a.x.data[i] / b.x.data[i];
+    return_vec.y.data[i] = a.y.data[i] / b.y.data[i];
+    return_vec.z.data[i] = a.z.data[i] / b.z.data[i];
+  }
+
+  return return_vec;
+}
+
+
+// Special operations.
+
+vec3x4
+vec3x4_scale(const vec3x4 a, const floatx4 scale)
+{
+  vec3x4 return_vec;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_vec.x.data[i] = a.x.data[i] * scale.data[i];
+    return_vec.y.data[i] = a.y.data[i] * scale.data[i];
+    return_vec.z.data[i] = a.z.data[i] * scale.data[i];
+  }
+
+  return return_vec;
+}
+
+
+vec3x4
+vec3x4_normalize(const vec3x4 a)
+{
+  const floatx4 length = vec3x4_length(a);
+  floatx4 one_over_length;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    assert(length.data[i] != 0); // Don't pass zero vectors. (0,0,0);
+    one_over_length.data[i] = 1.f / length.data[i];
+  }
+
+  return vec3x4_scale(a, one_over_length);
+}
+
+
+floatx4
+vec3x4_length(const vec3x4 a)
+{
+  floatx4 return_lanes = vec3x4_dot(a, a);
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_lanes.data[i] = sqrt(return_lanes.data[i]);
+  }
+
+  return return_lanes;
+}
+
+
+vec3x4
+vec3x4_cross(const vec3x4 a, const vec3x4 b)
+{
+  vec3x4 return_vec;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_vec.x.data[i] = (a.y.data[i] * b.z.data[i]) - (a.z.data[i] * b.y.data[i]);
+    return_vec.y.data[i] = (a.z.data[i] * b.x.data[i]) - (a.x.data[i] * b.z.data[i]);
+    return_vec.z.data[i] = (a.x.data[i] * b.y.data[i]) - (a.y.data[i] * b.x.data[i]);
+  }
+
+  return return_vec;
+}
+
+
+floatx4
+vec3x4_dot(const vec3x4 a, const vec3x4 b)
+{
+  floatx4 return_lanes;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    return_lanes.data[i] = (a.x.data[i] * b.x.data[i]) +
+                           (a.y.data[i] * b.y.data[i]) +
+                           (a.z.data[i] * b.z.data[i]);
+  }
+
+  return return_lanes;
+}
+
+
+// ** Equal Test ** //
+
+uint32_t
+vec3x4_is_equal(const vec3x4 a, const vec3x4 b)
+{
+  uint32_t mask = 0;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    const bool equal = (a.x.data[i] == b.x.data[i]) &&
+                       (a.y.data[i] == b.y.data[i]) &&
+                       (a.z.data[i] == b.z.data[i]);
+
+    mask |= (equal ? 1u : 0u) << i;
+  }
+
+  return mask;
+}
+
+
+uint32_t
+vec3x4_is_near(const vec3x4 a, const vec3x4 b, const float error)
+{
+  uint32_t mask = 0;
+
+  for(uint32_t i = 0; i < 4; ++i)
+  {
+    const bool near = is_near(a.x.data[i], b.x.data[i], error) &&
+                      is_near(a.y.data[i], b.y.data[i], error) &&
+                      is_near(a.z.data[i], b.z.data[i], error);
+
+    mask |= (near ? 1u : 0u) << i;
+  }
+
+  return mask;
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // on fpu
+#endif // inc guard
@@ -0,0 +1,354 @@
+#ifndef VEC3X4_SSE_INCLUDED_653ABC6A_1B8E_41A6_BF74_8DC0B9D741D9
+#define VEC3X4_SSE_INCLUDED_653ABC6A_1B8E_41A6_BF74_8DC0B9D741D9
+
+
+#include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
+#include "vec_types.hpp"
+#include <assert.h>
+#include <cstring>
+
+
+#ifdef MATH_ON_SSE2
+
+
+/*
+  Vector3 x4
+  SSE impl, one register per component.
+*/
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  // Four xyzw rows in, x y z lanes out (w is dropped).
+  inline vec3x4
+  vec3x4_sse_from_rows(__m128 row_0, __m128 row_1, __m128 row_2, __m128 row_3)
+  {
+    _MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+
+    return vec3x4{{{row_0}}, {{row_1}}, {{row_2}}};
+  }
+
+
+  inline void
+  vec3x4_sse_to_rows(const vec3x4 vec, __m128 rows[4])
+  {
+    rows[0] = vec.x.simd_vec;
+    rows[1] = vec.y.simd_vec;
+    rows[2] = vec.z.simd_vec;
+    rows[3] = _mm_setzero_ps();
+
+    _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+  }
+} // ns
+
+
+// Lanes
+
+floatx4
+floatx4_init(const float val)
+{
+  return floatx4{{_mm_set1_ps(val)}};
+}
+
+
+floatx4
+floatx4_init(const float a, const float b, const float c, const float d)
+{
+  return floatx4{{_mm_setr_ps(a, b, c, d)}};
+}
+
+
+floatx4
+floatx4_add(const floatx4 a, const floatx4 b)
+{
+  return floatx4{{_mm_add_ps(a.simd_vec, b.simd_vec)}};
+}
+
+
+floatx4
+floatx4_subtract(const floatx4 a, const floatx4 b)
+{
+  return floatx4{{_mm_sub_ps(a.simd_vec, b.simd_vec)}};
+}
+
+
+floatx4
+floatx4_multiply(const floatx4 a, const floatx4 b)
+{
+  return floatx4{{_mm_mul_ps(a.simd_vec, b.simd_vec)}};
+}
+
+
+floatx4
+floatx4_divide(const floatx4 a, const floatx4 b)
+{
+  return floatx4{{_mm_div_ps(a.simd_vec, b.simd_vec)}};
+}
+
+
+floatx4
+floatx4_sqrt(const floatx4 a)
+{
+  return floatx4{{_mm_sqrt_ps(a.simd_vec)}};
+}
+
+
+floatx4
+floatx4_copy_sign(const floatx4 magnitude, const floatx4 sign)
+{
+  const __m128 sign_bit = _mm_set1_ps(-0.f);
+
+  return floatx4{{_mm_or_ps(_mm_andnot_ps(sign_bit, magnitude.simd_vec), _mm_and_ps(sign_bit, sign.simd_vec))}};
+}
+
+
+// Constants
+
+vec3x4
+vec3x4_zero()
+{
+  const __m128 zero = _mm_setzero_ps();
+  return vec3x4{{{zero}}, {{zero}}, {{zero}}};
+}
+
+
+// Initialize
+
+vec3x4
+vec3x4_init(const vec3 vec)
+{
+  const __m128 v = vec.simd_vec;
+
+  return vec3x4{
+    {{_mm_shuffle_ps(v, v, _MM_SHUFFLE(0,0,0,0))}},
+    {{_mm_shuffle_ps(v, v, _MM_SHUFFLE(1,1,1,1))}},
+    {{_mm_shuffle_ps(v, v, _MM_SHUFFLE(2,2,2,2))}}
+  };
+}
+
+
+vec3x4
+vec3x4_init(const vec3 a, const vec3 b, const vec3 c, const vec3 d)
+{
+  return detail::vec3x4_sse_from_rows(a.simd_vec, b.simd_vec, c.simd_vec, d.simd_vec);
+}
+
+
+vec3x4
+vec3x4_init_with_vec3_array(const vec3 *arr, const size_t count)
+{
+  assert(count <= 4);
+
+  __m128 rows[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    rows[i] = arr[i].simd_vec;
+  }
+
+  return detail::vec3x4_sse_from_rows(rows[0], rows[1], rows[2], rows[3]);
+}
+
+
+vec3x4
+vec3x4_init_with_xyz_array(const float *xyz_arr, const size_t count)
+{
+  assert(count <= 4);
+
+  if(count < 4)
+  {
+    float padded[12];
+    memset(padded, 0, sizeof(padded));
+    memcpy(padded, xyz_arr, sizeof(float) * 3 * count);
+
+    return vec3x4_init_with_xyz_array(padded, 4);
+  }
+
+  // Unaligned overlapping loads, the last one is shifted back a
+  // float so nothing past the 12 floats is read.
+  const __m128 row_3 = _mm_loadu_ps(xyz_arr + 8);
+
+  return detail::vec3x4_sse_from_rows(
+    _mm_loadu_ps(xyz_arr + 0),
+    _mm_loadu_ps(xyz_arr + 3),
+    _mm_loadu_ps(xyz_arr + 6),
+    _mm_shuffle_ps(row_3, row_3, _MM_SHUFFLE(3,3,2,1))
+  );
+}
+
+
+// Get components.
+
+void
+vec3x4_to_vec3_array(const vec3x4 vec, vec3 *out_array, const size_t count)
+{
+  assert(count <= 4);
+
+  __m128 rows[4];
+  detail::vec3x4_sse_to_rows(vec, rows);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    out_array[i].simd_vec = rows[i];
+  }
+}
+
+
+void
+vec3x4_to_xyz_array(const vec3x4 vec, float *out_xyz_array, const size_t count)
+{
+  assert(count <= 4);
+
+  ALIGN16 float rows[16];
+
+  __m128 simd_rows[4];
+  detail::vec3x4_sse_to_rows(vec, simd_rows);
+
+  _mm_store_ps(&rows[0],  simd_rows[0]);
+  _mm_store_ps(&rows[4],  simd_rows[1]);
+  _mm_store_ps(&rows[8],  simd_rows[2]);
+  _mm_store_ps(&rows[12], simd_rows[3]);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    memcpy(&out_xyz_array[i * 3], &rows[i * 4], sizeof(float) * 3);
+  }
+}
+
+
+// Component wise arithmetic.
+
+vec3x4
+vec3x4_add(const vec3x4 a, const vec3x4 b)
+{
+  return vec3x4{
+    {{_mm_add_ps(a.x.simd_vec, b.x.simd_vec)}},
+    {{_mm_add_ps(a.y.simd_vec, b.y.simd_vec)}},
+    {{_mm_add_ps(a.z.simd_vec, b.z.simd_vec)}}
+  };
+}
+
+
+vec3x4
+vec3x4_subtract(const vec3x4 a, const vec3x4 b)
+{
+  return vec3x4{
+    {{_mm_sub_ps(a.x.simd_vec, b.x.simd_vec)}},
+    {{_mm_sub_ps(a.y.simd_vec, b.y.simd_vec)}},
+    {{_mm_sub_ps(a.z.simd_vec, b.z.simd_vec)}}
+  };
+}
+
+
+vec3x4
+vec3x4_multiply(const vec3x4 a, const vec3x4 b)
+{
+  return vec3x4{
+    {{_mm_mul_ps(a.x.simd_vec, b.x.simd_vec)}},
+    {{_mm_mul_ps(a.y.simd_vec, b.y.simd_vec)}},
+    {{_mm_mul_ps(a.z.simd_vec, b.z.simd_vec)}}
+  };
+}
+
+
+vec3x4
+vec3x4_divide(const vec3x4 a, const vec3x4 b)
+{
+  return vec3x4{
+    {{_mm_div_ps(a.x.simd_vec, b.x.simd_vec)}},
+    {{_mm_div_ps(a.y.simd_vec, b.y.simd_vec)}},
+    {{_mm_div_ps(a.z.simd_vec, b.z.simd_vec)}}
+  };
+}
+
+
+// Special operations.
+
+vec3x4
+vec3x4_scale(const vec3x4 a, const floatx4 scale)
+{
+  return vec3x4{
+    {{_mm_mul_ps(a.x.simd_vec, scale.simd_vec)}},
+    {{_mm_mul_ps(a.y.simd_vec, scale.simd_vec)}},
+    {{_mm_mul_ps(a.z.simd_vec, scale.simd_vec)}}
+  };
+}
+
+
+vec3x4
+vec3x4_normalize(const vec3x4 a)
+{
+  const floatx4 length = vec3x4_length(a);
+
+  assert(_mm_movemask_ps(_mm_cmpeq_ps(length.simd_vec, _mm_setzero_ps())) == 0); // Don't pass zero vectors. (0,0,0);
+
+  return vec3x4_scale(a, floatx4{{_mm_div_ps(_mm_set1_ps(1.f), length.simd_vec)}});
+}
+
+
+floatx4
+vec3x4_length(const vec3x4 a)
+{
+  return floatx4{{_mm_sqrt_ps(vec3x4_dot(a, a).simd_vec)}};
+}
+
+
+vec3x4
+vec3x4_cross(const vec3x4 a, const vec3x4 b)
+{
+  // Not fused, as vec3_cross, so cross(v, v) stays exactly zero.
+  return vec3x4{
+    {{_mm_sub_ps(_mm_mul_ps(a.y.simd_vec, b.z.simd_vec), _mm_mul_ps(a.z.simd_vec, b.y.simd_vec))}},
+    {{_mm_sub_ps(_mm_mul_ps(a.z.simd_vec, b.x.simd_vec), _mm_mul_ps(a.x.simd_vec, b.z.simd_vec))}},
+    {{_mm_sub_ps(_mm_mul_ps(a.x.simd_vec, b.y.simd_vec), _mm_mul_ps(a.y.simd_vec, b.x.simd_vec))}}
+  };
+}
+
+
+floatx4
+vec3x4_dot(const vec3x4 a, const vec3x4 b)
+{
+  __m128 dot = _mm_mul_ps(a.x.simd_vec, b.x.simd_vec);
+  dot = detail::sse_multiply_add(a.y.simd_vec, b.y.simd_vec, dot);
+  dot = detail::sse_multiply_add(a.z.simd_vec, b.z.simd_vec, dot);
+
+  return floatx4{{dot}};
+}
+
+
+// ** Equal Test ** //
+
+uint32_t
+vec3x4_is_equal(const vec3x4 a, const vec3x4 b)
+{
+  const __m128 x = _mm_cmpeq_ps(a.x.simd_vec, b.x.simd_vec);
+  const __m128 y = _mm_cmpeq_ps(a.y.simd_vec, b.y.simd_vec);
+  const __m128 z = _mm_cmpeq_ps(a.z.simd_vec, b.z.simd_vec);
+
+  return (uint32_t)_mm_movemask_ps(_mm_and_ps(_mm_and_ps(x, y), z));
+}
+
+
+uint32_t
+vec3x4_is_near(const vec3x4 a, const vec3x4 b, const float error)
+{
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+  const __m128 margin   = _mm_and_ps(_mm_set1_ps(error), abs_mask);
+
+  const __m128 x = _mm_cmple_ps(_mm_and_ps(_mm_sub_ps(b.x.simd_vec, a.x.simd_vec), abs_mask), margin);
+  const __m128 y = _mm_cmple_ps(_mm_and_ps(_mm_sub_ps(b.y.simd_vec, a.y.simd_vec), abs_mask), margin);
+  const __m128 z = _mm_cmple_ps(_mm_and_ps(_mm_sub_ps(b.z.simd_vec, a.z.simd_vec), abs_mask), margin);
+
+  return (uint32_t)_mm_movemask_ps(_mm_and_ps(_mm_and_ps(x, y), z));
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // use sse
+#endif // inc guard
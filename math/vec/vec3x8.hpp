@@ -0,0 +1,193 @@
+#ifndef VEC3X8_INCLUDED_DFC4246E_DAE9_4EBF_9044_C68FF1FE3C11
+#define VEC3X8_INCLUDED_DFC4246E_DAE9_4EBF_9044_C68FF1FE3C11
+
+
+/*
+  Vector3 x8
+  Eight 3D vectors as structure of arrays. One __m256 per
+  component with AVX, otherwise two vec3x4 halves.
+  Tests return a bit mask, bit n is lane n.
+*/
+
+
+#include "../detail/detail.hpp"
+#include "vec_types.hpp"
+#include "vec3.hpp"
+#include "vec3x4.hpp"
+#include <stddef.h>
+#include <assert.h>
+
+
+_MATH_NS_OPEN
+
+
+// ** Interface ** //
+
+// Lanes
+MATH_VEC3X8_INLINE floatx8              floatx8_init(const float val);
+MATH_VEC3X8_INLINE floatx8              floatx8_init(const floatx4 lo, const floatx4 hi);
+MATH_VEC3X8_INLINE float                floatx8_get(const floatx8 lanes, const uint32_t i);
+
+// Constants
+MATH_VEC3X8_INLINE vec3x8               vec3x8_zero();
+MATH_VEC3X8_INLINE vec3x8               vec3x8_one();
+
+// Initialize, loads past count are zero.
+MATH_VEC3X8_INLINE vec3x8               vec3x8_init(const vec3 vec);
+MATH_VEC3X8_INLINE vec3x8               vec3x8_init(const vec3x4 lo, const vec3x4 hi);
+MATH_VEC3X8_INLINE vec3x8               vec3x8_init_with_vec3_array(const vec3 *arr, const size_t count = 8);
+MATH_VEC3X8_INLINE vec3x8               vec3x8_init_with_xyz_array(const float *xyz_arr, const size_t count = 8);
+
+// Get components.
+MATH_VEC3X8_INLINE vec3                 vec3x8_get(const vec3x8 vec, const uint32_t i);
+MATH_VEC3X8_INLINE vec3x4               vec3x8_get_half(const vec3x8 vec, const uint32_t half);
+MATH_VEC3X8_INLINE void                 vec3x8_to_vec3_array(const vec3x8 vec, vec3 *out_array, const size_t count = 8);
+MATH_VEC3X8_INLINE void                 vec3x8_to_xyz_array(const vec3x8 vec, float *out_xyz_array, const size_t count = 8);
+
+// Component wise arithmetic.
+MATH_VEC3X8_INLINE vec3x8               vec3x8_add(const vec3x8 a, const vec3x8 b);
+MATH_VEC3X8_INLINE vec3x8               vec3x8_subtract(const vec3x8 a, const vec3x8 b);
+MATH_VEC3X8_INLINE vec3x8               vec3x8_multiply(const vec3x8 a, const vec3x8 b);
+MATH_VEC3X8_INLINE vec3x8               vec3x8_divide(const vec3x8 a, const vec3x8 b);
+
+// Special operations.
+MATH_VEC3X8_INLINE vec3x8               vec3x8_lerp(const vec3x8 start, const vec3x8 end, const float dt);
+MATH_VEC3X8_INLINE vec3x8               vec3x8_scale(const vec3x8 a, const float scale);
+MATH_VEC3X8_INLINE vec3x8               vec3x8_scale(const vec3x8 a, const floatx8 scale);
+MATH_VEC3X8_INLINE vec3x8               vec3x8_normalize(const vec3x8 a);
+MATH_VEC3X8_INLINE floatx8              vec3x8_length(const vec3x8 a);
+MATH_VEC3X8_INLINE vec3x8               vec3x8_cross(const vec3x8 a, const vec3x8 b);
+MATH_VEC3X8_INLINE floatx8              vec3x8_dot(const vec3x8 a, const vec3x8 b);
+
+// ** Equal Test ** //
+MATH_VEC3X8_INLINE uint32_t             vec3x8_is_equal(const vec3x8 a, const vec3x8 b);
+MATH_VEC3X8_INLINE uint32_t             vec3x8_is_not_equal(const vec3x8 a, const vec3x8 b);
+MATH_VEC3X8_INLINE uint32_t             vec3x8_is_near(const vec3x8 a, const vec3x8 b, const float error);
+MATH_VEC3X8_INLINE uint32_t             vec3x8_is_not_near(const vec3x8 a, const vec3x8 b, const float error);
+
+
+// Shared impl
+
+float
+floatx8_get(const floatx8 lanes, const uint32_t i)
+{
+  assert(i < 8);
+  return lanes.data[i];
+}
+
+
+vec3x8
+vec3x8_one()
+{
+  return vec3x8_init(vec3_one());
+}
+
+
+vec3x8
+vec3x8_init_with_vec3_array(const vec3 *arr, const size_t count)
+{
+  assert(count <= 8);
+
+  const size_t lo_count = count < 4 ? count : 4;
+
+  return vec3x8_init(
+    vec3x4_init_with_vec3_array(arr, lo_count),
+    vec3x4_init_with_vec3_array(arr + lo_count, count - lo_count)
+  );
+}
+
+
+vec3x8
+vec3x8_init_with_xyz_array(const float *xyz_arr, const size_t count)
+{
+  assert(count <= 8);
+
+  const size_t lo_count = count < 4 ? count : 4;
+
+  return vec3x8_init(
+    vec3x4_init_with_xyz_array(xyz_arr, lo_count),
+    vec3x4_init_with_xyz_array(xyz_arr + (lo_count * 3), count - lo_count)
+  );
+}
+
+
+vec3
+vec3x8_get(const vec3x8 vec, const uint32_t i)
+{
+  assert(i < 8);
+  return vec3_init(vec.x.data[i], vec.y.data[i], vec.z.data[i]);
+}
+
+
+void
+vec3x8_to_vec3_array(const vec3x8 vec, vec3 *out_array, const size_t count)
+{
+  assert(count <= 8);
+
+  const size_t lo_count = count < 4 ? count : 4;
+
+  vec3x4_to_vec3_array(vec3x8_get_half(vec, 0), out_array, lo_count);
+  vec3x4_to_vec3_array(vec3x8_get_half(vec, 1), out_array + lo_count, count - lo_count);
+}
+
+
+void
+vec3x8_to_xyz_array(const vec3x8 vec, float *out_xyz_array, const size_t count)
+{
+  assert(count <= 8);
+
+  const size_t lo_count = count < 4 ? count : 4;
+
+  vec3x4_to_xyz_array(vec3x8_get_half(vec, 0), out_xyz_array, lo_count);
+  vec3x4_to_xyz_array(vec3x8_get_half(vec, 1), out_xyz_array + (lo_count * 3), count - lo_count);
+}
+
+
+vec3x8
+vec3x8_lerp(const vec3x8 start, const vec3x8 end, const float dt)
+{
+  const vec3x8 difference = vec3x8_subtract(end, start);
+  const vec3x8 scaled     = vec3x8_scale(difference, dt);
+  const vec3x8 position   = vec3x8_add(start, scaled);
+
+  return position;
+}
+
+
+vec3x8
+vec3x8_scale(const vec3x8 a, const float scale)
+{
+  return vec3x8_scale(a, floatx8_init(scale));
+}
+
+
+uint32_t
+vec3x8_is_not_equal(const vec3x8 a, const vec3x8 b)
+{
+  return ~vec3x8_is_equal(a, b) & 0xFF;
+}
+
+
+uint32_t
+vec3x8_is_not_near(const vec3x8 a, const vec3x8 b, const float error)
+{
+  return ~vec3x8_is_near(a, b, error) & 0xFF;
+}
+
+
+_MATH_NS_CLOSE
+
+
+// What impl to use
+
+#ifdef MATH_ON_AVX
+
+#include "vec3x8_avx.inl"
+
+#else
+
+#include "vec3x8_fallback.inl"
+
+#endif // Choose which impl to use.
+
+#endif // inc guard
@@ -0,0 +1,263 @@
+#ifndef VEC3X8_AVX_INCLUDED_4448055D_BAA6_4C70_AFEA_7558E6990559
+#define VEC3X8_AVX_INCLUDED_4448055D_BAA6_4C70_AFEA_7558E6990559
+
+
+#include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
+#include "vec_types.hpp"
+#include <assert.h>
+
+
+#ifdef MATH_ON_AVX
+
+
+/*
+  Vector3 x8
+  AVX impl, one __m256 per component.
+*/
+
+
+_MATH_NS_OPEN
+
+
+namespace detail
+{
+  inline __m256
+  avx_combine(const __m128 lo, const __m128 hi)
+  {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+  }
+} // ns
+
+
+// Lanes
+
+floatx8
+floatx8_init(const float val)
+{
+  floatx8 return_lanes;
+  return_lanes.simd_vec = _mm256_set1_ps(val);
+
+  return return_lanes;
+}
+
+
+floatx8
+floatx8_init(const floatx4 lo, const floatx4 hi)
+{
+  floatx8 return_lanes;
+  return_lanes.simd_vec = detail::avx_combine(lo.simd_vec, hi.simd_vec);
+
+  return return_lanes;
+}
+
+
+// Constants
+
+vec3x8
+vec3x8_zero()
+{
+  return vec3x8_init(vec3_zero());
+}
+
+
+// Initialize
+
+vec3x8
+vec3x8_init(const vec3 vec)
+{
+  const vec3x4 splat = vec3x4_init(vec);
+
+  return vec3x8_init(splat, splat);
+}
+
+
+vec3x8
+vec3x8_init(const vec3x4 lo, const vec3x4 hi)
+{
+  return vec3x8{
+    floatx8_init(lo.x, hi.x),
+    floatx8_init(lo.y, hi.y),
+    floatx8_init(lo.z, hi.z)
+  };
+}
+
+
+// Get components.
+
+vec3x4
+vec3x8_get_half(const vec3x8 vec, const uint32_t half)
+{
+  assert(half < 2);
+
+  if(half == 0)
+  {
+    return vec3x4{
+      {{_mm256_castps256_ps128(vec.x.simd_vec)}},
+      {{_mm256_castps256_ps128(vec.y.simd_vec)}},
+      {{_mm256_castps256_ps128(vec.z.simd_vec)}}
+    };
+  }
+
+  return vec3x4{
+    {{_mm256_extractf128_ps(vec.x.simd_vec, 1)}},
+    {{_mm256_extractf128_ps(vec.y.simd_vec, 1)}},
+    {{_mm256_extractf128_ps(vec.z.simd_vec, 1)}}
+  };
+}
+
+
+// Component wise arithmetic.
+
+vec3x8
+vec3x8_add(const vec3x8 a, const vec3x8 b)
+{
+  vec3x8 return_vec;
+
+  return_vec.x.simd_vec = _mm256_add_ps(a.x.simd_vec, b.x.simd_vec);
+  return_vec.y.simd_vec = _mm256_add_ps(a.y.simd_vec, b.y.simd_vec);
+  return_vec.z.simd_vec = _mm256_add_ps(a.z.simd_vec, b.z.simd_vec);
+
+  return return_vec;
+}
+
+
+vec3x8
+vec3x8_subtract(const vec3x8 a, const vec3x8 b)
+{
+  vec3x8 return_vec;
+
+  return_vec.x.simd_vec = _mm256_sub_ps(a.x.simd_vec, b.x.simd_vec);
+  return_vec.y.simd_vec = _mm256_sub_ps(a.y.simd_vec, b.y.simd_vec);
+  return_vec.z.simd_vec = _mm256_sub_ps(a.z.simd_vec, b.z.simd_vec);
+
+  return return_vec;
+}
+
+
+vec3x8
+vec3x8_multiply(const vec3x8 a, const vec3x8 b)
+{
+  vec3x8 return_vec;
+
+  return_vec.x.simd_vec = _mm256_mul_ps(a.x.simd_vec, b.x.simd_vec);
+  return_vec.y.simd_vec = _mm256_mul_ps(a.y.simd_vec, b.y.simd_vec);
+  return_vec.z.simd_vec = _mm256_mul_ps(a.z.simd_vec, b.z.simd_vec);
+
+  return return_vec;
+}
+
+
+vec3x8
+vec3x8_divide(const vec3x8 a, const vec3x8 b)
+{
+  vec3x8 return_vec;
+
+  return_vec.x.simd_vec = _mm256_div_ps(a.x.simd_vec, b.x.simd_vec);
+  return_vec.y.simd_vec = _mm256_div_ps(a.y.simd_vec, b.y.simd_vec);
+  return_vec.z.simd_vec = _mm256_div_ps(a.z.simd_vec, b.z.simd_vec);
+
+  return return_vec;
+}
+
+
+// Special operations.
+
+vec3x8
+vec3x8_scale(const vec3x8 a, const floatx8 scale)
+{
+  vec3x8 return_vec;
+
+  return_vec.x.simd_vec = _mm256_mul_ps(a.x.simd_vec, scale.simd_vec);
+  return_vec.y.simd_vec = _mm256_mul_ps(a.y.simd_vec, scale.simd_vec);
+  return_vec.z.simd_vec = _mm256_mul_ps(a.z.simd_vec, scale.simd_vec);
+
+  return return_vec;
+}
+
+
+vec3x8
+vec3x8_normalize(const vec3x8 a)
+{
+  const floatx8 length = vec3x8_length(a);
+
+  assert(_mm256_movemask_ps(_mm256_cmp_ps(length.simd_vec, _mm256_setzero_ps(), _CMP_EQ_OQ)) == 0); // Don't pass zero vectors. (0,0,0);
+
+  floatx8 one_over_length;
+  one_over_length.simd_vec = _mm256_div_ps(_mm256_set1_ps(1.f), length.simd_vec);
+
+  return vec3x8_scale(a, one_over_length);
+}
+
+
+floatx8
+vec3x8_length(const vec3x8 a)
+{
+  floatx8 return_lanes;
+  return_lanes.simd_vec = _mm256_sqrt_ps(vec3x8_dot(a, a).simd_vec);
+
+  return return_lanes;
+}
+
+
+vec3x8
+vec3x8_cross(const vec3x8 a, const vec3x8 b)
+{
+  vec3x8 return_vec;
+
+  // Not fused, as vec3_cross, so cross(v, v) stays exactly zero.
+  return_vec.x.simd_vec = _mm256_sub_ps(_mm256_mul_ps(a.y.simd_vec, b.z.simd_vec), _mm256_mul_ps(a.z.simd_vec, b.y.simd_vec));
+  return_vec.y.simd_vec = _mm256_sub_ps(_mm256_mul_ps(a.z.simd_vec, b.x.simd_vec), _mm256_mul_ps(a.x.simd_vec, b.z.simd_vec));
+  return_vec.z.simd_vec = _mm256_sub_ps(_mm256_mul_ps(a.x.simd_vec, b.y.simd_vec), _mm256_mul_ps(a.y.simd_vec, b.x.simd_vec));
+
+  return return_vec;
+}
+
+
+floatx8
+vec3x8_dot(const vec3x8 a, const vec3x8 b)
+{
+  floatx8 return_lanes;
+
+  __m256 dot = _mm256_mul_ps(a.x.simd_vec, b.x.simd_vec);
+  dot = detail::avx_multiply_add(a.y.simd_vec, b.y.simd_vec, dot);
+  dot = detail::avx_multiply_add(a.z.simd_vec, b.z.simd_vec, dot);
+
+  return_lanes.simd_vec = dot;
+
+  return return_lanes;
+}
+
+
+// ** Equal Test ** //
+
+uint32_t
+vec3x8_is_equal(const vec3x8 a, const vec3x8 b)
+{
+  const __m256 x = _mm256_cmp_ps(a.x.simd_vec, b.x.simd_vec, _CMP_EQ_OQ);
+  const __m256 y = _mm256_cmp_ps(a.y.simd_vec, b.y.simd_vec, _CMP_EQ_OQ);
+  const __m256 z = _mm256_cmp_ps(a.z.simd_vec, b.z.simd_vec, _CMP_EQ_OQ);
+
+  return (uint32_t)_mm256_movemask_ps(_mm256_and_ps(_mm256_and_ps(x, y), z));
+}
+
+
+uint32_t
+vec3x8_is_near(const vec3x8 a, const vec3x8 b, const float error)
+{
+  const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+  const __m256 margin   = _mm256_and_ps(_mm256_set1_ps(error), abs_mask);
+
+  const __m256 x = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(b.x.simd_vec, a.x.simd_vec), abs_mask), margin, _CMP_LE_OQ);
+  const __m256 y = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(b.y.simd_vec, a.y.simd_vec), abs_mask), margin, _CMP_LE_OQ);
+  const __m256 z = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(b.z.simd_vec, a.z.simd_vec), abs_mask), margin, _CMP_LE_OQ);
+
+  return (uint32_t)_mm256_movemask_ps(_mm256_and_ps(_mm256_and_ps(x, y), z));
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // use avx
+#endif // inc guard
@@ -0,0 +1,211 @@
+#ifndef VEC3X8_FALLBACK_INCLUDED_33890B82_C560_40EE_A2F2_729037583859
+#define VEC3X8_FALLBACK_INCLUDED_33890B82_C560_40EE_A2F2_729037583859
+
+
+#include "../detail/detail.hpp"
+#include "vec_types.hpp"
+#include "vec3x4.hpp"
+#include <assert.h>
+
+
+#ifndef MATH_ON_AVX
+
+
+/*
+  Vector3 x8
+  Fallback impl, each half goes through vec3x4 so
+  SSE still gets used without AVX.
+*/
+
+
+_MATH_NS_OPEN
+
+
+// Lanes
+
+floatx8
+floatx8_init(const float val)
+{
+  const floatx4 half = floatx4_init(val);
+
+  return floatx8_init(half, half);
+}
+
+
+floatx8
+floatx8_init(const floatx4 lo, const floatx4 hi)
+{
+  floatx8 return_lanes;
+
+  return_lanes.half[0] = lo;
+  return_lanes.half[1] = hi;
+
+  return return_lanes;
+}
+
+
+// Constants
+
+vec3x8
+vec3x8_zero()
+{
+  const vec3x4 half = vec3x4_zero();
+
+  return vec3x8_init(half, half);
+}
+
+
+// Initialize
+
+vec3x8
+vec3x8_init(const vec3 vec)
+{
+  const vec3x4 half = vec3x4_init(vec);
+
+  return vec3x8_init(half, half);
+}
+
+
+vec3x8
+vec3x8_init(const vec3x4 lo, const vec3x4 hi)
+{
+  return vec3x8{
+    floatx8_init(lo.x, hi.x),
+    floatx8_init(lo.y, hi.y),
+    floatx8_init(lo.z, hi.z)
+  };
+}
+
+
+// Get components.
+
+vec3x4
+vec3x8_get_half(const vec3x8 vec, const uint32_t half)
+{
+  assert(half < 2);
+
+  return vec3x4{vec.x.half[half], vec.y.half[half], vec.z.half[half]};
+}
+
+
+// Component wise arithmetic.
+
+vec3x8
+vec3x8_add(const vec3x8 a, const vec3x8 b)
+{
+  return vec3x8_init(
+    vec3x4_add(vec3x8_get_half(a, 0), vec3x8_get_half(b, 0)),
+    vec3x4_add(vec3x8_get_half(a, 1), vec3x8_get_half(b, 1))
+  );
+}
+
+
+vec3x8
+vec3x8_subtract(const vec3x8 a, const vec3x8 b)
+{
+  return vec3x8_init(
+    vec3x4_subtract(vec3x8_get_half(a, 0), vec3x8_get_half(b, 0)),
+    vec3x4_subtract(vec3x8_get_half(a, 1), vec3x8_get_half(b, 1))
+  );
+}
+
+
+vec3x8
+vec3x8_multiply(const vec3x8 a, const vec3x8 b)
+{
+  return vec3x8_init(
+    vec3x4_multiply(vec3x8_get_half(a, 0), vec3x8_get_half(b, 0)),
+    vec3x4_multiply(vec3x8_get_half(a, 1), vec3x8_get_half(b, 1))
+  );
+}
+
+
+vec3x8
+vec3x8_divide(const vec3x8 a, const vec3x8 b)
+{
+  return vec3x8_init(
+    vec3x4_divide(vec3x8_get_half(a, 0), vec3x8_get_half(b, 0)),
+    vec3x4_divide(vec3x8_get_half(a, 1), vec3x8_get_half(b, 1))
+  );
+}
+
+
+// Special operations.
+
+vec3x8
+vec3x8_scale(const vec3x8 a, const floatx8 scale)
+{
+  return vec3x8_init(
+    vec3x4_scale(vec3x8_get_half(a, 0), scale.half[0]),
+    vec3x4_scale(vec3x8_get_half(a, 1), scale.half[1])
+  );
+}
+
+
+vec3x8
+vec3x8_normalize(const vec3x8 a)
+{
+  return vec3x8_init(
+    vec3x4_normalize(vec3x8_get_half(a, 0)),
+    vec3x4_normalize(vec3x8_get_half(a, 1))
+  );
+}
+
+
+floatx8
+vec3x8_length(const vec3x8 a)
+{
+  return floatx8_init(
+    vec3x4_length(vec3x8_get_half(a, 0)),
+    vec3x4_length(vec3x8_get_half(a, 1))
+  );
+}
+
+
+vec3x8
+vec3x8_cross(const vec3x8 a, const vec3x8 b)
+{
+  return vec3x8_init(
+    vec3x4_cross(vec3x8_get_half(a, 0), vec3x8_get_half(b, 0)),
+    vec3x4_cross(vec3x8_get_half(a, 1), vec3x8_get_half(b, 1))
+  );
+}
+
+
+floatx8
+vec3x8_dot(const vec3x8 a, const vec3x8 b)
+{
+  return floatx8_init(
+    vec3x4_dot(vec3x8_get_half(a, 0), vec3x8_get_half(b, 0)),
+    vec3x4_dot(vec3x8_get_half(a, 1), vec3x8_get_half(b, 1))
+  );
+}
+
+
+// ** Equal Test ** //
+
+uint32_t
+vec3x8_is_equal(const vec3x8 a, const vec3x8 b)
+{
+  const uint32_t lo = vec3x4_is_equal(vec3x8_get_half(a, 0), vec3x8_get_half(b, 0));
+  const uint32_t hi = vec3x4_is_equal(vec3x8_get_half(a, 1), vec3x8_get_half(b, 1));
+
+  return lo | (hi << 4);
+}
+
+
+uint32_t
+vec3x8_is_near(const vec3x8 a, const vec3x8 b, const float error)
+{
+  const uint32_t lo = vec3x4_is_near(vec3x8_get_half(a, 0), vec3x8_get_half(b, 0), error);
+  const uint32_t hi = vec3x4_is_near(vec3x8_get_half(a, 1), vec3x8_get_half(b, 1), error);
+
+  return lo | (hi << 4);
+}
+
+
+_MATH_NS_CLOSE
+
+
+#endif // no avx
+#endif // inc guard
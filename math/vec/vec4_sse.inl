@@ -3,6 +3,7 @@
 
 
 #include "../detail/detail.hpp"
+#include "../detail/simd.hpp"
 #include "vec_types.hpp"
 #include "../general/general.hpp"
 #include <assert.h>
@@ -72,36 +73,28 @@ vec4_init_with_array(const float *arr)
 float
 vec4_get_x(const vec4 vec)
 {
-  ALIGN16 float vec_store[4];
-  _mm_store_ps(&vec_store[0], vec.simd_vec);
-  return vec_store[0];
+  return _mm_cvtss_f32(vec.simd_vec);
 }
 
 
 float
 vec4_get_y(const vec4 vec)
 {
-  ALIGN16 float vec_store[4];
-  _mm_store_ps(&vec_store[0], vec.simd_vec);
-  return vec_store[1];
+  return _mm_cvtss_f32(_mm_shuffle_ps(vec.simd_vec, vec.simd_vec, _MM_SHUFFLE(1,1,1,1)));
 }
 
 
 float
 vec4_get_z(const vec4 vec)
 {
-  ALIGN16 float vec_store[4];
-  _mm_store_ps(&vec_store[0], vec.simd_vec);
-  return vec_store[2];
+  return _mm_cvtss_f32(_mm_shuffle_ps(vec.simd_vec, vec.simd_vec, _MM_SHUFFLE(2,2,2,2)));
 }
 
 
 float
 vec4_get_w(const vec4 vec)
 {
-  ALIGN16 float vec_store[4];
-  _mm_store_ps(&vec_store[0], vec.simd_vec);
-  return vec_store[3];
+  return _mm_cvtss_f32(_mm_shuffle_ps(vec.simd_vec, vec.simd_vec, _MM_SHUFFLE(3,3,3,3)));
 }
 
 
@@ -144,11 +137,9 @@ vec4_divide(const vec4 a, const vec4 b)
 vec4
 vec4_lerp(const vec4 start, const vec4 end, const float dt)
 {
-  const vec4 difference = vec4_subtract(end, start);
-  const vec4 scaled     = vec4_scale(difference, dt);
-  const vec4 position   = vec4_add(start, scaled);
+  const __m128 difference = _mm_sub_ps(end.simd_vec, start.simd_vec);
 
-  return position;
+  return vec4{{detail::sse_multiply_add(difference, _mm_set1_ps(dt), start.simd_vec)}};
 }
 
 
@@ -182,36 +173,22 @@ vec4_normalize(const vec4 a)
 float
 vec4_length(const vec4 a)
 {
-  __m128 sq = _mm_mul_ps(a.simd_vec, a.simd_vec);
-
-  sq = _mm_add_ps(sq, _mm_movehl_ps(sq, sq));
-  sq = _mm_add_ss(sq, _mm_shuffle_ps(sq, sq, 1));
-  sq = _mm_sqrt_ps(sq);
-
-  ALIGN16 float vec_store[4];
-  _mm_store_ps(&vec_store[0], sq);
-  return vec_store[0];
+  return _mm_cvtss_f32(_mm_sqrt_ss(detail::sse_dot4(a.simd_vec, a.simd_vec)));
 }
 
 
 float
 vec4_dot(const vec4 a, const vec4 b)
 {
-  __m128 mu = _mm_mul_ps(a.simd_vec, b.simd_vec);
-
-  mu = _mm_add_ps(mu, _mm_movehl_ps(mu, mu));
-  mu = _mm_add_ss(mu, _mm_shuffle_ps(mu, mu, 1));
-
-  ALIGN16 float vec_store[4];
-  _mm_store_ps(&vec_store[0], mu);
-  return vec_store[0];
+  return _mm_cvtss_f32(detail::sse_dot4(a.simd_vec, b.simd_vec));
 }
 
 
 bool
 vec4_is_equal(const vec4 a, const vec4 b)
 {
-  return !!_mm_movemask_ps(_mm_cmpeq_ps(a.simd_vec, b.simd_vec));
+  const int equal = _mm_movemask_ps(_mm_cmpeq_ps(a.simd_vec, b.simd_vec));
+  return (equal & 0xF) == 0xF;
 }
 
 
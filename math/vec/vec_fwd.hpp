@@ -11,6 +11,10 @@ _MATH_NS_OPEN
 struct vec2;
 struct vec3;
 struct vec4;
+struct floatx4;
+struct floatx8;
+struct vec3x4;
+struct vec3x8;
 
 
 _MATH_NS_CLOSE
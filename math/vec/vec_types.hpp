@@ -11,19 +11,27 @@
 */
 
 
+// Without a register the SIMD_TYPE is nothing, the alignas on each type
+// keeps the size and alignment the same as with one.
+typedef decltype(nullptr) nulltype_t;
+
 #ifdef MATH_ON_SSE2
 #define SIMD_TYPE __m128
 #else
-// in FPU mode SIMD_TYPE is nothing.
-typedef decltype(nullptr) nulltype_t;
 #define SIMD_TYPE nulltype_t
 #endif
 
+#ifdef MATH_ON_AVX
+#define SIMD_WIDE_TYPE __m256
+#else
+#define SIMD_WIDE_TYPE nulltype_t
+#endif
+
 
 _MATH_NS_OPEN
 
 
-struct vec4
+struct alignas(16) vec4
 {
   union
   {
@@ -33,7 +41,7 @@ struct vec4
 };
 
 
-struct vec3
+struct alignas(16) vec3
 {
   union
   {
@@ -43,7 +51,7 @@ struct vec3
 };
 
 
-struct vec2
+struct alignas(16) vec2
 {
   union
   {
@@ -53,6 +61,56 @@ struct vec2
 };
 
 
+/*
+  Wide Types.
+  Structure of arrays, several vectors with one register
+  per component. The floatxN types are a lane of scalars.
+*/
+
+
+struct alignas(16) floatx4
+{
+  union
+  {
+    SIMD_TYPE simd_vec;
+    float data[4];
+  };
+};
+
+
+struct alignas(32) floatx8
+{
+  union
+  {
+    SIMD_WIDE_TYPE simd_vec;
+    floatx4 half[2];
+    float data[8];
+  };
+};
+
+
+struct vec3x4
+{
+  floatx4 x, y, z;
+};
+
+
+struct vec3x8
+{
+  floatx8 x, y, z;
+};
+
+
+// Code built at different ISA levels shares these, so they must not drift.
+static_assert(sizeof(vec4) == 16 && alignof(vec4) == 16, "vec4 layout differs by ISA level");
+static_assert(sizeof(vec3) == 16 && alignof(vec3) == 16, "vec3 layout differs by ISA level");
+static_assert(sizeof(vec2) == 16 && alignof(vec2) == 16, "vec2 layout differs by ISA level");
+static_assert(sizeof(floatx4) == 16 && alignof(floatx4) == 16, "floatx4 layout differs by ISA level");
+static_assert(sizeof(floatx8) == 32 && alignof(floatx8) == 32, "floatx8 layout differs by ISA level");
+static_assert(sizeof(vec3x4) == 48 && alignof(vec3x4) == 16, "vec3x4 layout differs by ISA level");
+static_assert(sizeof(vec3x8) == 96 && alignof(vec3x8) == 32, "vec3x8 layout differs by ISA level");
+
+
 _MATH_NS_CLOSE
 
 